@@ -9,18 +9,21 @@
 
 // --- Audio Playback Function Declarations ---
 
-// Plays a single audio file specified by filename.
-// Returns 0 on success, non-zero on error.
+// Plays a single audio file specified by filename (same as
+// playerWithControls; kept for existing callers).
+// Returns 0 on success, non-zero on error or stop.
 int player(const std::string& filename);
 
 // Plays a single audio file specified by filename with play/pause/stop
-// controls. Returns 0 on success, 1 on error, 2 if stopped by user.
+// controls through the gapless PlaybackEngine.
+// Returns 0 on success, 1 on error, 2 if stopped by user.
 int playerWithControls(const std::string& filename);
 
 // --- Playback Functions ---
 
 // Plays the playlist with controls (play/pause/stop) for each song.
 // This is the base function for sequential playback with controls.
+// Tracks are prefetched and handed off without a gap between songs.
 void playWithControls(LinkedList& list);
 
 // Plays a specific song from the playlist selected by the user with controls.
@@ -32,4 +35,8 @@ void playWithControlsReverse(LinkedList& list);
 // Plays the playlist multiple times with controls.
 void playWithControlsRepeat(LinkedList& list, int rounds = 1);
 
+// Plays the playlist once in a random order with controls. With
+// 'spreadArtists' the shuffle avoids playing the same artist back to back.
+void playWithControlsShuffle(LinkedList& list, bool spreadArtists = false);
+
 #endif  // AUDIO_H
\ No newline at end of file
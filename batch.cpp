@@ -0,0 +1,240 @@
+#include "batch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "daemon.h"    // --daemon and --control
+#include "link.h"      // LinkedList, getMusicFiles(), getSubdirectories()
+#include "output.h"    // OutputConfig, OutputSink
+#include "playback.h"  // PlaybackEngine, run headless
+#include "session.h"   // Receives the output options
+#include "stats.h"     // --stats-json
+
+// What one format (extension and decoder) added up to in a batch run
+struct FormatTotals {
+  int tracks = 0;
+  int failed = 0;
+  uint64_t frames = 0;
+  double audioSeconds = 0;  // frames / rate, summed per track
+  double wallSeconds = 0;   // Time each track was the one playing
+};
+
+static void printUsage(const char* program) {
+  std::fprintf(
+      stderr,
+      "Usage: %s [options]                   interactive menu\n"
+      "       %s [options] --batch ITEM...   decode headless and report\n"
+      "       %s [options] --daemon SOCKET   serve commands on a socket\n"
+      "       %s --control SOCKET COMMAND... send one command to a daemon\n"
+      "ITEM is a playlist (.mpl or .json), an audio file or a directory\n"
+      "(searched recursively). Daemon commands are listed in daemon.h.\n"
+      "Options:\n"
+      "  --sink pulse|null|wav:FILE|raw:FILE  where the PCM goes\n"
+      "                          (default: pulse, or null with --batch)\n"
+      "  --output-latency MS     PulseAudio buffer target (default %d)\n"
+      "  --simple-output         pa_simple instead of the async backend\n"
+      "  --stats-json FILE       write stage timings and counters at exit\n"
+      "  --help                  show this text\n",
+      program, program, program, program, OUTPUT_TARGET_LATENCY_MS);
+}
+
+// Reads "pulse", "null", "wav:FILE" or "raw:FILE" into 'config'
+static bool parseSink(const std::string& spec, OutputConfig& config) {
+  if (spec == "pulse") {
+    config.sink = OutputSink::PULSE;
+  } else if (spec == "null") {
+    config.sink = OutputSink::NULL_SINK;
+  } else if (spec.rfind("wav:", 0) == 0 && spec.size() > 4) {
+    config.sink = OutputSink::WAV_FILE;
+    config.filePath = spec.substr(4);
+  } else if (spec.rfind("raw:", 0) == 0 && spec.size() > 4) {
+    config.sink = OutputSink::RAW_FILE;
+    config.filePath = spec.substr(4);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Appends the audio files under 'dir', one directory level at a time
+static void addDirectory(const std::string& dir, LinkedList& queue) {
+  for (const auto& file : getMusicFiles(dir)) queue.add_end(file.first, "");
+  for (const auto& sub : getSubdirectories(dir)) {
+    addDirectory(sub.first, queue);
+  }
+}
+
+// Appends the tracks 'item' names. Returns false if it cannot be read.
+static bool addItem(const std::string& item, LinkedList& queue) {
+  std::error_code ec;
+  if (fs::is_directory(item, ec)) {
+    addDirectory(item, queue);
+    return true;
+  }
+  if (!fs::is_regular_file(item, ec)) return false;
+
+  std::string ext = toLowerCopy(fs::path(item).extension().string());
+  if (ext == ".mpl" || ext == ".json") {
+    LinkedList playlist;
+    if (!playlist.loadFromFile(item)) return false;
+    node* current = playlist.head;
+    for (int i = 0; i < playlist.len; ++i, current = current->next) {
+      queue.add_end(current->track().path, current->track().artist);
+    }
+    return true;
+  }
+  queue.add_end(item, "");
+  return true;
+}
+
+// Format column of the report, e.g. "mp3 (mpg123)"
+static std::string formatKey(const std::string& path,
+                             const std::string& decoder) {
+  std::string ext = toLowerCopy(fs::path(path).extension().string());
+  if (!ext.empty()) ext.erase(0, 1);  // Drop the dot
+  return (ext.empty() ? "?" : ext) + " (" +
+         (decoder.empty() ? "unopened" : decoder) + ")";
+}
+
+static void printTotalsRow(const std::string& label, const FormatTotals& t) {
+  double framesPerSecond = t.wallSeconds > 0 ? t.frames / t.wallSeconds : 0;
+  double realtime = t.wallSeconds > 0 ? t.audioSeconds / t.wallSeconds : 0;
+  std::printf("%-20s %6d %6d %13llu %10.1f %9.2f %12.0f %8.1fx\n",
+              label.c_str(), t.tracks, t.failed,
+              static_cast<unsigned long long>(t.frames), t.audioSeconds,
+              t.wallSeconds, framesPerSecond, realtime);
+}
+
+// Decodes every track named by 'items' through a headless engine and
+// prints per-format throughput and every failure
+static int runBatch(const std::vector<std::string>& items) {
+  LinkedList queue;
+  std::vector<std::string> failures;
+  for (const std::string& item : items) {
+    if (!addItem(item, queue)) failures.push_back(item + ": cannot be read");
+  }
+  if (queue.isEmpty()) {
+    std::fprintf(stderr, "No audio files found.\n");
+    return 1;
+  }
+
+  std::map<std::string, FormatTotals> totals;
+  PlaybackHooks hooks;
+  hooks.onTrackEnd = [&](const node* track, const TrackReport& report) {
+    const std::string& path = track->track().path;
+    FormatTotals& t = totals[formatKey(path, report.decoder)];
+    t.tracks++;
+    t.frames += report.frames;
+    if (report.rate > 0) {
+      t.audioSeconds += static_cast<double>(report.frames) / report.rate;
+    }
+    t.wallSeconds += report.wallSeconds;
+    if (!report.error.empty()) {
+      t.failed++;
+      failures.push_back(path + ": " + report.error);
+    }
+  };
+
+  node* cursor = queue.head;
+  int remaining = queue.len;
+  auto next = [&]() -> node* {
+    if (remaining == 0) return nullptr;
+    node* track = cursor;
+    cursor = cursor->next;
+    --remaining;
+    return track;
+  };
+
+  PlaybackEngine engine(false);
+  auto started = std::chrono::steady_clock::now();
+  int result = engine.play(next, hooks);
+  AudioSession::instance().closeOutputs();  // Completes file sinks
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - started)
+                       .count();
+
+  std::printf("%-20s %6s %6s %13s %10s %9s %12s %9s\n", "format", "tracks",
+              "failed", "frames", "audio (s)", "wall (s)", "frames/s",
+              "realtime");
+  FormatTotals all;
+  for (const auto& entry : totals) {
+    printTotalsRow(entry.first, entry.second);
+    all.tracks += entry.second.tracks;
+    all.failed += entry.second.failed;
+    all.frames += entry.second.frames;
+    all.audioSeconds += entry.second.audioSeconds;
+  }
+  all.wallSeconds = elapsed;  // Includes opening and the final drain
+  printTotalsRow("total", all);
+
+  for (const std::string& failure : failures) {
+    std::printf("FAILED %s\n", failure.c_str());
+  }
+  return (result != 0 || !failures.empty()) ? 1 : 0;
+}
+
+int runCommandLine(int argc, char** argv) {
+  if (argc <= 1) return CLI_START_MENU;
+
+  AudioSession& session = AudioSession::instance();
+  OutputConfig config = session.outputConfig();
+  bool batch = false;
+  bool sinkGiven = false;
+  std::string daemonSocket;
+  std::vector<std::string> items;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (batch && arg.rfind("--", 0) != 0) {
+      items.push_back(arg);
+    } else if (arg == "--batch") {
+      batch = true;
+    } else if (arg == "--daemon" && i + 1 < argc) {
+      daemonSocket = argv[++i];
+    } else if (arg == "--control" && i + 2 < argc) {
+      // Everything after the socket is the command
+      std::string socketPath = argv[i + 1];
+      return sendDaemonCommand(
+          socketPath, std::vector<std::string>(argv + i + 2, argv + argc));
+    } else if (arg == "--sink" && i + 1 < argc) {
+      if (!parseSink(argv[++i], config)) {
+        std::fprintf(stderr, "Unknown sink '%s'.\n", argv[i]);
+        return 1;
+      }
+      sinkGiven = true;
+    } else if (arg == "--output-latency" && i + 1 < argc) {
+      config.targetLatencyMs = std::atoi(argv[++i]);
+      if (config.targetLatencyMs <= 0) {
+        std::fprintf(stderr, "Invalid latency '%s'.\n", argv[i]);
+        return 1;
+      }
+    } else if (arg == "--simple-output") {
+      config.useAsync = false;
+    } else if (arg == "--stats-json" && i + 1 < argc) {
+      Stats::instance().setDumpPath(argv[++i]);
+    } else if (arg == "--help") {
+      printUsage(argv[0]);
+      return 0;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (batch && !daemonSocket.empty()) {
+    std::fprintf(stderr, "--batch and --daemon cannot be combined.\n");
+    return 1;
+  }
+  if (batch && !sinkGiven) config.sink = OutputSink::NULL_SINK;
+  session.setOutputConfig(config);
+  if (!daemonSocket.empty()) return runDaemon(daemonSocket);
+  if (!batch) return CLI_START_MENU;
+  if (items.empty()) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  return runBatch(items);
+}
@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// --- Command Line and Headless Batch Mode ---
+// Without arguments the program opens the interactive menu. Output options
+// (--sink, --output-latency, --simple-output) and --stats-json apply to
+// whichever mode runs. --daemon and --control run the socket-controlled
+// player and its client (daemon.h).
+// --batch plays playlists, audio files and directories through the same
+// PlaybackEngine pipeline as the menu, but headless and without real-time
+// pacing when the sink is null or a file, then reports frames per second
+// per format. With a file sink it doubles as a transcoder; the exit code
+// says whether every track decoded cleanly.
+
+// Returned by runCommandLine() when the interactive menu should start
+#define CLI_START_MENU -1
+
+// Parses the arguments, applies the output options and runs --batch,
+// --daemon or --control if given. Returns CLI_START_MENU to continue into
+// the menu, otherwise the exit code: 0 every track decoded (or the command
+// succeeded), 1 a track failed, a command failed or bad usage.
+int runCommandLine(int argc, char** argv);
+
+#endif  // BATCH_H
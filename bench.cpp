@@ -0,0 +1,568 @@
+// Benchmark suite. Headless: everything it measures is synthetic or
+// named on the command line, so runs on different commits compare.
+//  - Sorting: the key-cached stable sort (LinkedList::sortBy) against the
+//    original bubble sort, reproduced below as a reference baseline.
+//  - Search: indexed findMatches() against a linear scan of the cached keys.
+//  - Playlist operations from 1k to 1M tracks: add, delete, sort, search,
+//    getCleanSongName, drawing shuffled play orders, drawing a display()
+//    page (first draw and cached redraw) and saving/loading in both file
+//    formats.
+//  - Directory listing: getMusicFiles and getSubdirectories on generated
+//    trees in a temporary directory.
+//  - Decoding: each reference file (a generated WAV plus any given on the
+//    command line) decoded through the gain stage into a null sink, as a
+//    real-time factor.
+// Build and run with: make bench
+//
+// Usage: music_bench [--max N] [--max-files N] [--json FILE] [audio...]
+//   --max N        largest playlist size (default 1000000)
+//   --max-files N  largest generated directory (default 100000)
+//   --json FILE    also write every result as JSON ("-" for stdout)
+
+#include <unistd.h>  // getpid()
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>  // Machine-readable results
+
+#include "decoder.h"  // DecoderRegistry for the decode benchmark
+#include "dsp.h"      // GainStage, as used by the player
+#include "link.h"
+#include "queue.h"  // PlayQueue shuffles
+
+// Commit being measured, passed in by the Makefile
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"
+#endif
+
+// Timed runs of each repeatable measurement; the fastest is reported
+#define BENCH_REPEATS 3
+// Positional inserts and deletes per size (each is O(log n))
+#define BENCH_POSITIONAL_OPS 1000
+// Length of the generated reference WAV
+#define BENCH_WAV_SECONDS 60
+
+// Sizes for the current sort; the bubble sort baseline stops at
+// LEGACY_MAX_SIZE because it is quadratic and would take minutes beyond it.
+static const int SORT_SIZES[] = {1000, 2000, 5000, 20000};
+static const int LEGACY_MAX_SIZE = 2000;
+
+// Fills 'list' with 'count' synthetic tracks resembling a real library:
+// numbered file names with mixed case, spread over a few hundred artists.
+static void fillPlaylist(LinkedList& list, int count, unsigned seed) {
+  static const char* words[] = {"love",  "Night", "river", "Fire", "dream",
+                                "Heart", "road",  "Light", "rain", "Echo"};
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> word(0, 9);
+  std::uniform_int_distribution<int> artist(0, 299);
+
+  list.clear();
+  for (int i = 0; i < count; ++i) {
+    std::string title = std::string(words[word(rng)]) + " " +
+                        words[word(rng)] + " " + std::to_string(rng() % 1000);
+    std::string path = "music/album" + std::to_string(i % 50) + "/" +
+                       std::to_string(i % 20 + 1) + ". " + title + ".mp3";
+    list.add_end(path, "Artist " + std::to_string(artist(rng)));
+  }
+}
+
+// --- Baseline: the original bubble sort from link.cpp ---
+// Recomputes getCleanSongName() and lowercase copies on every comparison.
+static void legacySortBySong(LinkedList& list) {
+  if (list.head == nullptr || list.head->next == list.head) return;
+
+  bool swapped;
+  do {
+    swapped = false;
+    node* current = list.head;
+    for (int i = 0; i < list.len - 1; ++i) {
+      node* nextNode = current->next;
+
+      std::string nameCurrent = getCleanSongName(current->track().path);
+      std::string nameNext = getCleanSongName(nextNode->track().path);
+
+      std::string lowerCurrent, lowerNext;
+      std::transform(nameCurrent.begin(), nameCurrent.end(),
+                     std::back_inserter(lowerCurrent), ::tolower);
+      std::transform(nameNext.begin(), nameNext.end(),
+                     std::back_inserter(lowerNext), ::tolower);
+
+      if (lowerCurrent > lowerNext) {
+        std::swap(current->trackId, nextNode->trackId);
+        swapped = true;
+      }
+      current = nextNode;
+    }
+  } while (swapped);
+}
+
+// --- Baseline: linear substring scan over the cached keys ---
+static size_t linearSearchCount(const LinkedList& list,
+                                const std::string& lowerTerm) {
+  size_t count = 0;
+  node* current = list.head;
+  do {
+    const Track& track = current->track();
+    if (track.songKey.find(lowerTerm) != std::string::npos ||
+        track.shownArtistKey().find(lowerTerm) != std::string::npos) {
+      ++count;
+    }
+    current = current->next;
+  } while (current != list.head);
+  return count;
+}
+
+// Snapshot of the list order, used to check both sorts agree
+static std::vector<std::string> listOrder(const LinkedList& list) {
+  std::vector<std::string> order;
+  if (list.head == nullptr) return order;
+  node* current = list.head;
+  do {
+    order.push_back(current->track().path + "|" + current->track().artist);
+    current = current->next;
+  } while (current != list.head);
+  return order;
+}
+
+// Runs 'fn' once and returns the elapsed wall time in milliseconds
+template <typename Fn>
+static double timeMs(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Runs setup() then times fn(), BENCH_REPEATS times; returns the fastest
+template <typename Setup, typename Fn>
+static double bestMs(Setup setup, Fn fn) {
+  double best = 0.0;
+  for (int r = 0; r < BENCH_REPEATS; ++r) {
+    setup();
+    double ms = timeMs(fn);
+    if (r == 0 || ms < best) best = ms;
+  }
+  return best;
+}
+
+// --- Results ---
+// Each measurement is printed as a table row when taken and kept for the
+// JSON report.
+struct BenchResult {
+  std::string name;
+  long n;        // Problem size (tracks, files or PCM frames)
+  double value;  // Measured value, in 'unit'
+  std::string unit;
+};
+
+static std::vector<BenchResult> results;
+
+// Keeps a result for the JSON report only (the caller prints it)
+static void remember(const std::string& name, long n, double value,
+                     const std::string& unit) {
+  results.push_back({name, n, value, unit});
+}
+
+static void record(const std::string& name, long n, double value,
+                   const std::string& unit) {
+  remember(name, n, value, unit);
+  std::printf("%-26s %9ld %14.3f %s\n", name.c_str(), n, value, unit.c_str());
+  std::fflush(stdout);
+}
+
+static void printSection(const char* title) {
+  std::printf("\n%-26s %9s %14s\n", title, "n", "value");
+}
+
+static bool writeJson(const std::string& filename) {
+  nlohmann::json report;
+  report["revision"] = BENCH_REVISION;
+  report["results"] = nlohmann::json::array();
+  for (const BenchResult& r : results) {
+    report["results"].push_back(
+        {{"name", r.name}, {"n", r.n}, {"value", r.value}, {"unit", r.unit}});
+  }
+  if (filename == "-") {
+    std::printf("%s\n", report.dump(2).c_str());
+    return true;
+  }
+  std::ofstream out(filename);
+  out << report.dump(2) << std::endl;
+  return static_cast<bool>(out);
+}
+
+// getMusicFiles() would create "music/" through this; the benchmark only
+// lists directories it generated itself
+void ensureMusicDirectoryExists() {}
+
+// --- Playlist Operations ---
+
+static void benchPlaylist(int n, const std::string& workDir) {
+  LinkedList list;
+  const int positional = std::min(n, BENCH_POSITIONAL_OPS);
+  std::mt19937 rng(n);
+  auto noSetup = []() {};
+  auto clearList = [&]() { list.clear(); };
+  auto freshList = [&]() { fillPlaylist(list, n, 42); };
+
+  record("add_end", n, bestMs(clearList, freshList), "ms");
+  record("add_beg", n, bestMs(clearList, [&]() {
+           for (int i = 0; i < n; ++i) {
+             list.add_beg("music/b" + std::to_string(i) + ".mp3", "Artist");
+           }
+         }), "ms");
+
+  // Positional operations in the middle of a full list
+  std::vector<int> positions(positional);
+  auto insertPositions = [&]() {
+    freshList();
+    for (int& pos : positions) pos = 1 + rng() % n;
+  };
+  auto deletePositions = [&]() {
+    freshList();
+    for (int k = 0; k < positional; ++k) {
+      positions[k] = 1 + rng() % (n - k);  // The list shrinks as it goes
+    }
+  };
+  record("add_at", positional, bestMs(insertPositions, [&]() {
+           for (int pos : positions) list.add_at("music/x.mp3", "Artist", pos);
+         }), "ms");
+  record("del_at", positional, bestMs(deletePositions, [&]() {
+           for (int pos : positions) list.del_at(pos);
+         }), "ms");
+  record("del_beg_end", n, bestMs(freshList, [&]() {
+           while (!list.isEmpty()) {
+             list.del_beg();
+             if (!list.isEmpty()) list.del_end();
+           }
+         }), "ms");
+
+  record("sort_by_song", n,
+         bestMs(freshList, [&]() { list.sortBySong(); }), "ms");
+  record("sort_by_artist_song", n, bestMs(freshList, [&]() {
+           list.sortBy({SortKey::ARTIST, SortKey::SONG});
+         }), "ms");
+
+  // Search: the first query builds the index, later ones reuse it
+  fillPlaylist(list, n, 7);
+  record("search_first_query", n,
+         timeMs([&]() { list.findMatches("heart"); }), "ms");
+  record("search_query", n,
+         bestMs(noSetup, [&]() { list.findMatches("night fire 12"); }), "ms");
+
+  // Title cleaning, as done once per track when it is first interned
+  std::vector<std::string> paths;
+  paths.reserve(n);
+  node* current = list.head;
+  for (int i = 0; i < n; ++i, current = current->next) {
+    paths.push_back(current->track().path);
+  }
+  size_t totalLength = 0;
+  record("get_clean_song_name", n, bestMs(noSetup, [&]() {
+           for (const std::string& p : paths) {
+             totalLength += getCleanSongName(p).size();
+           }
+         }), "ms");
+
+  // Drawing a whole round of each shuffle, checked to be a permutation
+  std::vector<node*> drawnOrder;
+  drawnOrder.reserve(n);
+  for (PlayOrder order : {PlayOrder::SHUFFLE, PlayOrder::ARTIST_SPREAD}) {
+    double ms = bestMs([&]() { drawnOrder.clear(); }, [&]() {
+      PlayQueue queue(list, order, 1, 1234);
+      while (node* track = queue.next()) drawnOrder.push_back(track);
+    });
+    record(order == PlayOrder::SHUFFLE ? "shuffle_round" : "spread_round", n,
+           ms, "ms");
+    std::vector<char> seen(n + 1, 0);
+    int distinct = 0;
+    for (node* track : drawnOrder) {
+      char& mark = seen[list.positionOf(track)];
+      distinct += !mark;
+      mark = 1;
+    }
+    if (distinct != n) {
+      std::printf("  (shuffle MISMATCH: %d of %d tracks)\n", distinct, n);
+    }
+  }
+
+  // One display() page from the middle of the list, into a null stream:
+  // the first draw formats the page, a redraw reuses the cached rows
+  {
+    std::ofstream discard;  // Never opened, so every write is dropped
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    const size_t middlePage = static_cast<size_t>(n) / 2 / VIEW_MIN_PAGE_ROWS;
+    auto invalidate = [&]() {  // Any change drops the cached rows
+      list.add_end("x", "y");
+      list.del_end();
+    };
+    record("display_page_first", n,
+           bestMs(invalidate, [&]() { list.display(middlePage); }), "ms");
+    record("display_page", n, bestMs(noSetup, [&]() {
+             list.display(middlePage);
+           }), "ms");
+    std::cout.rdbuf(console);
+  }
+
+  // Saving and loading in both formats
+  const std::string binaryFile = workDir + "/bench.mpl";
+  const std::string jsonFile = workDir + "/bench.json";
+  LinkedList loaded;
+  auto clearLoaded = [&]() { loaded.clear(); };
+  bool ok = true;
+  record("save_binary", n, bestMs(noSetup, [&]() {
+           ok &= list.saveToFile(binaryFile, PlaylistFormat::BINARY);
+         }), "ms");
+  record("save_json", n, bestMs(noSetup, [&]() {
+           ok &= list.saveToFile(jsonFile, PlaylistFormat::JSON);
+         }), "ms");
+  record("load_binary", n, bestMs(clearLoaded, [&]() {
+           ok &= loaded.loadFromFile(binaryFile);
+         }), "ms");
+  record("load_json", n, bestMs(clearLoaded, [&]() {
+           ok &= loaded.loadFromFile(jsonFile);
+         }), "ms");
+  if (!ok || loaded.len != n) {
+    std::printf("  (save/load FAILED: %d of %d tracks)\n", loaded.len, n);
+  }
+  fs::remove(binaryFile);
+  fs::remove(jsonFile);
+}
+
+// --- Directory Listing ---
+
+// Creates 'files' empty audio files directly in 'dir', plus 'files' / 100
+// subdirectories, with the same names fillPlaylist() uses
+static void makeTree(const std::string& dir, int files) {
+  fs::create_directories(dir);
+  static const char* extensions[] = {".mp3", ".flac", ".ogg", ".wav", ".txt"};
+  for (int i = 0; i < files; ++i) {
+    std::string name = dir + "/" + std::to_string(i % 20 + 1) + ". Track " +
+                       std::to_string(i) + extensions[i % 5];
+    std::ofstream(name).put('\0');
+  }
+  for (int i = 0; i < files / 100; ++i) {
+    fs::create_directory(dir + "/Album " + std::to_string(i));
+  }
+}
+
+static void benchDirectory(int files, const std::string& workDir) {
+  const std::string dir = workDir + "/tree" + std::to_string(files);
+  makeTree(dir, files);
+  std::vector<std::pair<std::string, std::string>> found;
+  record("get_music_files", files,
+         bestMs([]() {}, [&]() { found = getMusicFiles(dir); }), "ms");
+  record("get_subdirectories", files / 100,
+         bestMs([]() {}, [&]() { found = getSubdirectories(dir); }), "ms");
+  fs::remove_all(dir);
+}
+
+// --- Decoding ---
+
+// Writes a 16-bit stereo 44.1 kHz WAV of a sweep plus noise
+static bool writeReferenceWav(const std::string& filename, int seconds) {
+  const uint32_t rate = 44100, channels = 2, frames = rate * seconds;
+  const uint32_t dataBytes = frames * channels * 2;
+  std::ofstream out(filename, std::ios::binary);
+  auto put32 = [&](uint32_t v) { out.write(reinterpret_cast<char*>(&v), 4); };
+  auto put16 = [&](uint16_t v) { out.write(reinterpret_cast<char*>(&v), 2); };
+  out.write("RIFF", 4);
+  put32(36 + dataBytes);
+  out.write("WAVEfmt ", 8);
+  put32(16);
+  put16(1);  // PCM
+  put16(channels);
+  put32(rate);
+  put32(rate * channels * 2);
+  put16(channels * 2);
+  put16(16);
+  out.write("data", 4);
+  put32(dataBytes);
+
+  std::mt19937 rng(1);
+  std::vector<int16_t> block;
+  block.reserve(rate * channels);
+  double phase = 0.0;
+  for (uint32_t f = 0; f < frames; ++f) {
+    phase += 2 * 3.141592653589793 * (220.0 + f % rate) / rate;
+    int16_t s = static_cast<int16_t>(12000 * std::sin(phase) +
+                                     static_cast<int>(rng() % 512) - 256);
+    block.push_back(s);
+    block.push_back(s);
+    if (block.size() == block.capacity() || f + 1 == frames) {
+      out.write(reinterpret_cast<char*>(block.data()), block.size() * 2);
+      block.clear();
+    }
+  }
+  return static_cast<bool>(out);
+}
+
+// Decodes 'filename' to the end as the player would (decoder, then gain
+// stage to S16), discarding the output. Records the real-time factor.
+static void benchDecode(const std::string& filename) {
+  std::string error;
+  std::unique_ptr<Decoder> decoder =
+      DecoderRegistry::instance().open(filename, error);
+  if (!decoder) {
+    std::printf("  (skipped %s: %s)\n", filename.c_str(), error.c_str());
+    return;
+  }
+  const StreamInfo& info = decoder->info();
+  std::vector<float> block(decoder->preferredBlockSamples());
+  std::vector<short> pcm(block.size());
+  GainStage stage;
+  stage.setGain(1.0f, !info.pcm16);
+
+  long samples = 0;
+  long checksum = 0;  // Keeps the conversion from being optimised away
+  double ms = timeMs([&]() {
+    long n;
+    while ((n = decoder->read(block.data(), block.size(), error)) > 0) {
+      stage.process(block.data(), pcm.data(), n);
+      checksum += pcm[0];
+      samples += n;
+    }
+  });
+  long frames = samples / std::max(1, info.channels);
+  double audioSeconds =
+      info.rate > 0 ? static_cast<double>(frames) / info.rate : 0.0;
+  std::string ext = toLowerCopy(fs::path(filename).extension().string());
+  std::string label = "decode" + ext + " (" + decoder->name() + ")";
+  record(label, frames, ms > 0 ? audioSeconds * 1000.0 / ms : 0.0,
+         "x realtime");
+  if (checksum == 1) std::printf(" ");  // Never true in practice
+}
+
+int main(int argc, char** argv) {
+  int maxTracks = 1000000;
+  int maxFiles = 100000;
+  std::string jsonFile;
+  std::vector<std::string> audioFiles;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--max" && i + 1 < argc) {
+      maxTracks = std::atoi(argv[++i]);
+    } else if (arg == "--max-files" && i + 1 < argc) {
+      maxFiles = std::atoi(argv[++i]);
+    } else if (arg == "--json" && i + 1 < argc) {
+      jsonFile = argv[++i];
+    } else if (arg.rfind("--", 0) == 0) {
+      std::fprintf(stderr,
+                   "Usage: %s [--max N] [--max-files N] [--json FILE] "
+                   "[audio...]\n",
+                   argv[0]);
+      return 1;
+    } else {
+      audioFiles.push_back(arg);
+    }
+  }
+  std::printf("revision %s\n\n", BENCH_REVISION);
+
+  // Scratch space for generated files, removed at the end
+  const std::string workDir =
+      (fs::temp_directory_path() /
+       ("music_bench_" + std::to_string(static_cast<long>(getpid()))))
+          .string();
+  fs::create_directories(workDir);
+
+  std::printf("%-22s %8s %14s %14s %10s\n", "benchmark", "n", "legacy (ms)",
+              "sortBy (ms)", "speedup");
+
+  for (int n : SORT_SIZES) {
+    LinkedList list;
+
+    // Title sort: current implementation
+    fillPlaylist(list, n, 42);
+    double current = timeMs([&]() { list.sortBySong(); });
+    remember("sort_by_song_once", n, current, "ms");
+    std::vector<std::string> expected = listOrder(list);
+
+    // Title sort: bubble sort baseline on the same input
+    if (n <= LEGACY_MAX_SIZE) {
+      fillPlaylist(list, n, 42);
+      double legacy = timeMs([&]() { legacySortBySong(list); });
+      bool same = (listOrder(list) == expected);
+      remember("sort_by_song_legacy", n, legacy, "ms");
+      std::printf("%-22s %8d %14.2f %14.2f %9.0fx%s\n", "sort_by_song", n,
+                  legacy, current, legacy / current,
+                  same ? "" : "  (ORDER MISMATCH)");
+    } else {
+      std::printf("%-22s %8d %14s %14.2f %10s\n", "sort_by_song", n, "-",
+                  current, "-");
+    }
+
+    // Multi-key sort: artist, then title
+    fillPlaylist(list, n, 42);
+    double multi =
+        timeMs([&]() { list.sortBy({SortKey::ARTIST, SortKey::SONG}); });
+    remember("sort_by_artist_song_once", n, multi, "ms");
+    std::printf("%-22s %8d %14s %14.2f %10s\n", "sort_by_artist_song", n, "-",
+                multi, "-");
+    std::fflush(stdout);  // Show each size as soon as it finishes
+  }
+
+  // Search: a selective term and a common one, averaged over many queries
+  // once the index has been built by a first query
+  std::printf("\n%-22s %8s %14s %14s %10s\n", "benchmark", "n",
+              "linear (us)", "indexed (us)", "speedup");
+  const int queries = 200;
+  for (int n : {1000, 20000, 100000}) {
+    LinkedList list;
+    fillPlaylist(list, n, 7);
+    for (const char* term : {"night fire 12", "heart"}) {
+      list.findMatches(term);  // Builds the index
+      size_t expected = 0, found = 0;
+      double linear = timeMs([&]() {
+        for (int q = 0; q < queries; ++q)
+          expected = linearSearchCount(list, term);
+      });
+      double indexed = timeMs([&]() {
+        for (int q = 0; q < queries; ++q) found = list.findMatches(term).size();
+      });
+      std::string label = std::string("search \"") + term + "\"";
+      remember(label + " linear", n, linear * 1000 / queries, "us");
+      remember(label + " indexed", n, indexed * 1000 / queries, "us");
+      std::printf("%-22s %8d %14.1f %14.1f %9.1fx%s\n", label.c_str(), n,
+                  linear * 1000 / queries, indexed * 1000 / queries,
+                  linear / indexed, found == expected ? "" : "  (MISMATCH)");
+    }
+    std::fflush(stdout);
+  }
+
+  printSection("playlist operations");
+  for (int n : {1000, 10000, 100000, 1000000}) {
+    if (n <= maxTracks) benchPlaylist(n, workDir);
+  }
+
+  printSection("directory listing");
+  for (int files : {1000, 10000, 100000, 1000000}) {
+    if (files <= maxFiles) benchDirectory(files, workDir);
+  }
+
+  printSection("decoding");
+  const std::string wav = workDir + "/reference.wav";
+  if (writeReferenceWav(wav, BENCH_WAV_SECONDS)) {
+    benchDecode(wav);
+  }
+  for (const std::string& file : audioFiles) benchDecode(file);
+
+  std::error_code ec;
+  fs::remove_all(workDir, ec);
+
+  if (!jsonFile.empty() && !writeJson(jsonFile)) {
+    std::fprintf(stderr, "Cannot write %s\n", jsonFile.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,193 @@
+#include "binary_playlist.h"
+
+// Required for memory-mapping playlist files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "link.h"  // LinkedList::saveBinary / loadBinary are defined here
+
+bool isBinaryPlaylist(const char* data, size_t size) {
+  return size >= 4 && std::memcmp(data, MPL_MAGIC, 4) == 0;
+}
+
+// --- Little-endian helpers ---
+
+// Appends 'value' to 'out' as four little-endian bytes
+static void putU32(std::string& out, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<char>((value >> shift) & 0xFF));
+  }
+}
+
+// Reads a little-endian uint32 from 'p'
+static uint32_t getU32(const unsigned char* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// --- String Table Builder ---
+// Collects distinct strings into one byte block and hands back offsets
+class StringTable {
+public:
+  // Returns the offset of 's' in the table, adding it on first use
+  uint32_t intern(const std::string& s) {
+    auto it = offsets.find(s);
+    if (it != offsets.end()) return it->second;
+    uint32_t offset = static_cast<uint32_t>(bytes.size());
+    bytes += s;
+    offsets.emplace(s, offset);
+    return offset;
+  }
+
+  const std::string& data() const { return bytes; }
+
+private:
+  std::string bytes;
+  std::unordered_map<std::string, uint32_t> offsets;
+};
+
+// --- Read-only file mapping, unmapped on scope exit ---
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& filename)
+      : data(nullptr), size(0) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size),
+                          PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        data = static_cast<const unsigned char*>(mapped);
+        size = static_cast<size_t>(info.st_size);
+      }
+    }
+    close(fd);  // The mapping stays valid without the descriptor
+  }
+  ~MappedFile() {
+    if (data) munmap(const_cast<unsigned char*>(data), size);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* data;  // nullptr if the file could not be mapped
+  size_t size;
+};
+
+// Saves the playlist in the binary .mpl format
+// Returns true on success, false on failure
+bool LinkedList::saveBinary(const std::string& filename) const {
+  StringTable strings;
+  uint32_t nameOffset = strings.intern(listName);
+
+  // Track table: offsets into the string table, in list order
+  std::string tracks;
+  tracks.reserve(static_cast<size_t>(len) * MPL_TRACK_SIZE);
+  if (head != nullptr) {
+    node* current = head;
+    do {
+      const Track& track = current->track();
+      putU32(tracks, strings.intern(track.path));
+      putU32(tracks, static_cast<uint32_t>(track.path.size()));
+      putU32(tracks, strings.intern(track.artist));
+      putU32(tracks, static_cast<uint32_t>(track.artist.size()));
+      current = current->next;
+    } while (current != head);
+  }
+
+  std::string header(MPL_MAGIC, 4);
+  putU32(header, MPL_VERSION);
+  putU32(header, static_cast<uint32_t>(len));
+  putU32(header, nameOffset);
+  putU32(header, static_cast<uint32_t>(listName.size()));
+  putU32(header, static_cast<uint32_t>(MPL_HEADER_SIZE + tracks.size()));
+  putU32(header, static_cast<uint32_t>(strings.data().size()));
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "\t\tError: Could not open file '" << filename
+              << "' for writing." << std::endl;
+    return false;
+  }
+  file.write(header.data(), header.size());
+  file.write(tracks.data(), tracks.size());
+  file.write(strings.data().data(), strings.data().size());
+  file.close();
+
+  if (!file) {
+    std::cerr << "\t\tError: A problem occurred while writing to file '"
+              << filename << "'." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Loads a playlist from a binary .mpl file via mmap
+// The whole file is validated before the current list is replaced
+// Returns true on success, false on failure
+bool LinkedList::loadBinary(const std::string& filename) {
+  MappedFile file(filename);
+  if (file.data == nullptr) {
+    std::cerr << "\t\tError: Could not map playlist file '" << filename
+              << "'." << std::endl;
+    return false;
+  }
+
+  const unsigned char* data = file.data;
+  if (file.size < MPL_HEADER_SIZE || !isBinaryPlaylist(
+                                         reinterpret_cast<const char*>(data),
+                                         file.size)) {
+    std::cerr << "\t\tError: '" << filename
+              << "' is not a valid binary playlist." << std::endl;
+    return false;
+  }
+  if (getU32(data + 4) != MPL_VERSION) {
+    std::cerr << "\t\tError: '" << filename
+              << "' uses an unsupported playlist version." << std::endl;
+    return false;
+  }
+
+  const uint64_t count = getU32(data + 8);
+  const uint64_t nameOffset = getU32(data + 12);
+  const uint64_t nameLength = getU32(data + 16);
+  const uint64_t tableOffset = getU32(data + 20);
+  const uint64_t tableSize = getU32(data + 24);
+
+  // Layout checks (64-bit arithmetic so corrupt values cannot wrap)
+  bool valid = tableOffset == MPL_HEADER_SIZE + count * MPL_TRACK_SIZE &&
+               tableOffset + tableSize <= file.size &&
+               nameOffset + nameLength <= tableSize;
+  const unsigned char* trackTable = data + MPL_HEADER_SIZE;
+  for (uint64_t i = 0; valid && i < count; ++i) {
+    const unsigned char* entry = trackTable + i * MPL_TRACK_SIZE;
+    valid = uint64_t(getU32(entry)) + getU32(entry + 4) <= tableSize &&
+            uint64_t(getU32(entry + 8)) + getU32(entry + 12) <= tableSize;
+  }
+  if (!valid) {
+    std::cerr << "\t\tError: Playlist file '" << filename
+              << "' is truncated or corrupt." << std::endl;
+    return false;
+  }
+
+  // Replace the current contents; every node comes from one reserved slab
+  const char* strings = reinterpret_cast<const char*>(data + tableOffset);
+  clear();
+  listName = sanitizeListName(std::string(strings + nameOffset, nameLength));
+  nodePool.reserve(static_cast<size_t>(count));
+  for (uint64_t i = 0; i < count; ++i) {
+    const unsigned char* entry = trackTable + i * MPL_TRACK_SIZE;
+    add_end(std::string(strings + getU32(entry), getU32(entry + 4)),
+            std::string(strings + getU32(entry + 8), getU32(entry + 12)));
+  }
+
+  taken = true;  // Mark list slot as taken/in-use
+  return true;
+}
@@ -0,0 +1,28 @@
+#ifndef BINARY_PLAYLIST_H
+#define BINARY_PLAYLIST_H
+
+#include <cstddef>
+
+// --- Binary Playlist Format (.mpl) ---
+// Every integer is a little-endian uint32.
+//
+//   Header  (28 bytes): magic "MPLB", version, track count, name offset,
+//                       name length, string table offset, string table size
+//   Tracks  (16 bytes each): song offset, song length,
+//                            artist offset, artist length
+//   Strings: raw bytes with no terminators. Offsets are relative to the
+//            start of the table, and identical strings (the same artist on
+//            many tracks, say) are stored once.
+//
+// The loader maps the file read-only, checks every offset against the
+// file size before touching the list, then builds nodes straight from it.
+
+#define MPL_MAGIC "MPLB"
+#define MPL_VERSION 1
+#define MPL_HEADER_SIZE 28
+#define MPL_TRACK_SIZE 16
+
+// True if the 'size' bytes at 'data' begin with the binary playlist magic
+bool isBinaryPlaylist(const char* data, size_t size);
+
+#endif  // BINARY_PLAYLIST_H
@@ -0,0 +1,147 @@
+#include "catalog.h"
+
+#include <cstdio>      // For std::snprintf
+#include <functional>  // For std::hash
+#include <stdexcept>   // For std::length_error
+
+#include "link.h"  // getCleanSongName(), toLowerCopy()
+
+TrackCatalog& TrackCatalog::instance() {
+  static TrackCatalog catalog;  // Destroyed at process exit
+  return catalog;
+}
+
+TrackCatalog::TrackCatalog() : count(0), changes(0) {}
+
+size_t TrackCatalog::KeyHash::operator()(const Key& k) const {
+  size_t h = std::hash<std::string_view>()(k.path);
+  // Mix in the artist (boost::hash_combine style)
+  return h ^ (std::hash<std::string_view>()(k.artist) + 0x9e3779b9 +
+              (h << 6) + (h >> 2));
+}
+
+// Artist names the menus store when the user leaves the prompt empty
+static bool isPlaceholderArtist(const std::string& artist) {
+  return artist.empty() || artist == "[Unknown]" ||
+         artist == "[Unknown Artist]";
+}
+
+std::string formatDuration(long long durationMs) {
+  long long seconds = durationMs / 1000;
+  char text[32];
+  if (seconds >= 3600) {
+    std::snprintf(text, sizeof(text), "%lld:%02lld:%02lld", seconds / 3600,
+                  seconds / 60 % 60, seconds % 60);
+  } else {
+    std::snprintf(text, sizeof(text), "%lld:%02lld", seconds / 60,
+                  seconds % 60);
+  }
+  return text;
+}
+
+uint32_t TrackCatalog::intern(const std::string& path,
+                              const std::string& artist) {
+  std::unique_lock<std::mutex> lock(mtx);
+  auto it = ids.find(Key{path, artist});
+  if (it != ids.end()) return it->second;  // Already catalogued
+
+  const uint32_t chunkSize = 1u << CATALOG_CHUNK_BITS;
+  uint32_t id = count;
+  uint32_t chunk = id >> CATALOG_CHUNK_BITS;
+  if (chunk >= CATALOG_MAX_CHUNKS) {
+    throw std::length_error("track catalog is full");
+  }
+  if (!chunks[chunk]) chunks[chunk].reset(new Track[chunkSize]);
+
+  Track& track = chunks[chunk][id & (chunkSize - 1)];
+  track.path = path;
+  track.artist = artist;
+  track.cleanName = getCleanSongName(path);
+  track.songKey = toLowerCopy(track.cleanName);
+  track.artistKey = toLowerCopy(artist);
+  track.artistUnknown = isPlaceholderArtist(artist);
+  ++count;
+
+  // Key the maps by views into the stored copy, which never moves
+  ids.emplace(Key{track.path, track.artist}, id);
+  auto newest = newestByPath.emplace(track.path, id);
+  track.nextSamePath = newest.second ? CATALOG_NO_TRACK : newest.first->second;
+  newest.first->second = id;
+  if (!newest.second) {
+    // Same file under another artist: it already has what was read
+    const Track& sibling = get(track.nextSamePath);
+    track.durationMs.store(sibling.durationMs.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+    track.tags.store(sibling.tags.load(std::memory_order_relaxed),
+                     std::memory_order_release);
+    track.missing.store(sibling.missing.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    return id;
+  }
+
+  std::function<void(const std::string&)> handler = newPathHandler;
+  lock.unlock();
+  if (handler) handler(path);
+  return id;
+}
+
+void TrackCatalog::setDuration(uint32_t id, int durationMs) {
+  Track& track =
+      chunks[id >> CATALOG_CHUNK_BITS][id & ((1u << CATALOG_CHUNK_BITS) - 1)];
+  if (track.durationMs.exchange(durationMs, std::memory_order_relaxed) !=
+      durationMs) {
+    changes.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void TrackCatalog::setMissing(const std::string& path, bool missing) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = newestByPath.find(path);
+  if (it == newestByPath.end()) return;  // No playlist refers to it
+  for (uint32_t id = it->second; id != CATALOG_NO_TRACK;) {
+    Track& track =
+        chunks[id >> CATALOG_CHUNK_BITS][id & ((1u << CATALOG_CHUNK_BITS) - 1)];
+    track.missing.store(missing, std::memory_order_relaxed);
+    id = track.nextSamePath;
+  }
+  changes.fetch_add(1, std::memory_order_release);
+}
+
+void TrackCatalog::setMetadata(const std::string& path, const TrackTags& tags,
+                               int durationMs) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = newestByPath.find(path);
+  if (it == newestByPath.end()) return;  // No playlist refers to it
+
+  tagStore.push_back(tags);
+  const TrackTags* published = &tagStore.back();
+  for (uint32_t id = it->second; id != CATALOG_NO_TRACK;) {
+    Track& track =
+        chunks[id >> CATALOG_CHUNK_BITS][id & ((1u << CATALOG_CHUNK_BITS) - 1)];
+    track.tags.store(published, std::memory_order_release);
+    if (durationMs > 0) {
+      track.durationMs.store(durationMs, std::memory_order_relaxed);
+    }
+    id = track.nextSamePath;
+  }
+  changes.fetch_add(1, std::memory_order_release);
+}
+
+std::vector<std::string> TrackCatalog::paths() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  std::vector<std::string> result;
+  result.reserve(newestByPath.size());
+  for (const auto& entry : newestByPath) result.emplace_back(entry.first);
+  return result;
+}
+
+void TrackCatalog::setNewPathHandler(
+    std::function<void(const std::string&)> handler) {
+  std::lock_guard<std::mutex> lock(mtx);
+  newPathHandler = std::move(handler);
+}
+
+size_t TrackCatalog::size() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return count;
+}
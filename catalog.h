@@ -0,0 +1,145 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// --- Track Catalog ---
+// Process-wide table of distinct (path, artist) pairs. Playlist nodes hold
+// a 32-bit track ID instead of their own strings, so a track that appears
+// in several playlists, or many times in one, is stored once, and moving
+// or swapping nodes moves integers. Entries are never removed: an ID stays
+// valid for the life of the process.
+//
+// What the file itself says (tags and length) is filled in later by the
+// MetadataStore (metadata.h) and shared by every track with that path.
+
+// Tags read from a track's file
+struct TrackTags {
+  std::string artist;
+  std::string title;
+  std::string album;
+  std::string artistKey;  // Lowercase artist, used to sort
+};
+
+// One distinct track; everything derived from path and artist is cached
+struct Track {
+  std::string path;       // Full path to the song file
+  std::string artist;     // Artist name as entered
+  std::string cleanName;  // getCleanSongName(path), used for display
+  std::string songKey;    // Lowercase cleanName, used to search and sort
+  std::string artistKey;  // Lowercase artist, used to sort
+  bool artistUnknown;     // 'artist' is empty or a placeholder ("[Unknown]")
+  std::atomic<int> durationMs{-1};  // From the file's headers, or a decoder
+  std::atomic<bool> missing{false};  // File deleted or moved away since
+  std::atomic<const TrackTags*> tags{nullptr};  // nullptr until read
+  uint32_t nextSamePath;  // Older entry with the same path (other artist)
+
+  // Artist to show and sort by: the one entered, or the file's own when
+  // only a placeholder was entered
+  const std::string& shownArtist() const {
+    const TrackTags* t = tags.load(std::memory_order_acquire);
+    return artistUnknown && t && !t->artist.empty() ? t->artist : artist;
+  }
+  const std::string& shownArtistKey() const {
+    const TrackTags* t = tags.load(std::memory_order_acquire);
+    return artistUnknown && t && !t->artist.empty() ? t->artistKey
+                                                    : artistKey;
+  }
+};
+
+// "m:ss", or "h:mm:ss" from an hour up, for a length in milliseconds
+std::string formatDuration(long long durationMs);
+
+// End of a Track::nextSamePath chain
+#define CATALOG_NO_TRACK UINT32_MAX
+
+// Tracks live in fixed chunks reached through a fixed directory, so a
+// track never moves and get() can read without taking the lock
+#define CATALOG_CHUNK_BITS 12    // 4096 tracks per chunk
+#define CATALOG_MAX_CHUNKS 4096  // Room for 16M distinct tracks
+
+class TrackCatalog {
+public:
+  // Returns the single catalog shared by every playlist
+  static TrackCatalog& instance();
+
+  // Returns the ID of (path, artist), adding the track on first use.
+  // Thread-safe; throws std::length_error if the catalog is full.
+  uint32_t intern(const std::string& path, const std::string& artist);
+
+  // The track behind an ID returned by intern()
+  const Track& get(uint32_t id) const {
+    return chunks[id >> CATALOG_CHUNK_BITS]
+                 [id & ((1u << CATALOG_CHUNK_BITS) - 1)];
+  }
+
+  // Records a track's length, learned when it is opened for playback
+  void setDuration(uint32_t id, int durationMs);
+
+  // Gives every track with this path the tags and length read from its
+  // file (durationMs <= 0: length unknown, left as it was). Tracks
+  // interned for the path later start with the same values.
+  void setMetadata(const std::string& path, const TrackTags& tags,
+                   int durationMs);
+
+  // Every distinct path catalogued so far
+  std::vector<std::string> paths() const;
+
+  // Called (outside the lock) with each path intern() sees for the first
+  // time, so its metadata can be read; pass nullptr to stop
+  void setNewPathHandler(std::function<void(const std::string&)> handler);
+
+  // Flags every track with this path (whatever its artist) as missing or
+  // present again; called by the library watcher as files come and go
+  void setMissing(const std::string& path, bool missing);
+
+  // Number of distinct tracks interned so far
+  size_t size() const;
+
+  // Bumped whenever a track's tags, length or missing flag change, so
+  // cached listing rows know to reformat
+  uint64_t revision() const { return changes.load(std::memory_order_acquire); }
+
+  TrackCatalog(const TrackCatalog&) = delete;
+  TrackCatalog& operator=(const TrackCatalog&) = delete;
+
+private:
+  TrackCatalog();
+
+  // Hash key viewing the strings of a stored Track (or of intern()'s
+  // arguments during a lookup), so the text is not stored twice
+  struct Key {
+    std::string_view path;
+    std::string_view artist;
+    bool operator==(const Key& other) const {
+      return path == other.path && artist == other.artist;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& k) const;
+  };
+
+  std::unique_ptr<Track[]> chunks[CATALOG_MAX_CHUNKS];
+  uint32_t count;  // Tracks in use
+  std::unordered_map<Key, uint32_t, KeyHash> ids;  // (path, artist) -> ID
+  // Path -> newest ID with that path; older ones follow nextSamePath
+  std::unordered_map<std::string_view, uint32_t> newestByPath;
+  // Every TrackTags published; kept for the life of the process since
+  // readers hold plain pointers into it
+  std::deque<TrackTags> tagStore;
+  std::function<void(const std::string&)> newPathHandler;
+  std::atomic<uint64_t> changes;  // Behind revision()
+  mutable std::mutex mtx;  // Guards everything above except 'chunks' reads
+};
+
+#endif  // CATALOG_H
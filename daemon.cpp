@@ -0,0 +1,599 @@
+#include "daemon.h"
+
+// Required for the socket, signal and poll handling
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "link.h"      // LinkedList, node
+#include "playback.h"  // PlaybackEngine, run headless
+#include "queue.h"     // PlayQueue, the order the engine draws from
+#include "registry.h"  // Named playlists, loaded once and kept
+#include "session.h"   // Volume
+
+// Splits a command line into words; "..." keeps spaces inside a word.
+// Returns false on an unterminated quote.
+static bool splitWords(const std::string& line,
+                       std::vector<std::string>& words) {
+  size_t i = 0;
+  while (i < line.size()) {
+    if (line[i] == ' ' || line[i] == '\t' || line[i] == '\r') {
+      ++i;
+      continue;
+    }
+    std::string word;
+    if (line[i] == '"') {
+      size_t end = line.find('"', i + 1);
+      if (end == std::string::npos) return false;
+      word = line.substr(i + 1, end - i - 1);
+      i = end + 1;
+    } else {
+      size_t end = line.find_first_of(" \t\r", i);
+      if (end == std::string::npos) end = line.size();
+      word = line.substr(i, end - i);
+      i = end;
+    }
+    words.push_back(word);
+  }
+  return true;
+}
+
+// Reads "12.5", "+10" or "-10" into 'value'; 'relative' is set for a sign
+static bool parseAmount(const std::string& word, double& value,
+                        bool& relative) {
+  if (word.empty()) return false;
+  relative = (word[0] == '+' || word[0] == '-');
+  char* end = nullptr;
+  value = std::strtod(word.c_str(), &end);
+  return end != nullptr && *end == '\0';
+}
+
+// Reads a whole positive number into 'value'
+static bool parseCount(const std::string& word, int& value) {
+  char* end = nullptr;
+  long parsed = std::strtol(word.c_str(), &end, 10);
+  if (word.empty() || *end != '\0' || parsed < 1 || parsed > 1000000000L) {
+    return false;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+// Tabs and newlines would break the reply framing
+static std::string replyField(const std::string& text) {
+  std::string field = text;
+  for (char& c : field) {
+    if (c == '\n' || c == '\r' || c == '\t') c = ' ';
+  }
+  return field;
+}
+
+// --- Player ---
+// The daemon's playback state. A player thread runs the headless engine on
+// the current queue; command handlers replace or extend the queue and use
+// the engine's remote controls. Every playlist is owned by the registry,
+// which the daemon never edits, so nodes handed to a queue stay valid.
+class DaemonPlayer {
+public:
+  DaemonPlayer() : engine(false), stopWanted(false), quitting(false) {
+    thread = std::thread(&DaemonPlayer::run, this);
+  }
+
+  ~DaemonPlayer() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      quitting = true;
+      pending.reset();
+    }
+    cv.notify_all();
+    engine.stop();
+    thread.join();
+  }
+
+  // Replaces whatever is playing with 'next'. The current queue is stopped
+  // before 'next' is published, so the stop can never reach 'next' itself.
+  void start(std::unique_ptr<PlayQueue> next) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      engine.stop();  // Ends the current queue; the player takes 'pending'
+      pending = std::move(next);
+      stopWanted = false;
+    }
+    cv.notify_all();
+  }
+
+  // Adds 'track' to the queue in use, or plays it if nothing is queued
+  void insert(node* track, bool ahead) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      PlayQueue* target = pending ? pending.get() : current.get();
+      if (target != nullptr && !stopWanted) {
+        if (ahead) {
+          target->playNext(track);
+        } else {
+          target->enqueue(track);
+        }
+        return;
+      }
+      pending = std::make_unique<PlayQueue>(empty, PlayOrder::SEQUENTIAL);
+      pending->enqueue(track);
+      stopWanted = false;
+    }
+    cv.notify_all();
+  }
+
+  // Stops playback and forgets the queue
+  void stop() {
+    std::lock_guard<std::mutex> lock(mtx);  // No queue can start meanwhile
+    pending.reset();
+    stopWanted = true;
+    engine.stop();
+  }
+
+  // Tracks queued after the audible one (or all of them before it starts)
+  size_t remaining() {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t count = 0;
+    if (current) count += current->remaining();
+    if (pending) count += pending->remaining();
+    return count;
+  }
+
+  PlaybackEngine engine;  // Headless; remote controls are thread-safe
+
+private:
+  // Player thread: plays each queue it is given. A queue that gained
+  // tracks after the engine drained it is played again.
+  void run() {
+    PlaybackHooks hooks;
+    // A replacement or stop that raced with play() starting is caught as
+    // the next track becomes audible
+    hooks.onTrackStart = [this](const node*, int) {
+      bool cancel;
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        cancel = pending != nullptr || stopWanted || quitting;
+      }
+      if (cancel) engine.stop();
+    };
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      cv.wait(lock, [this]() { return quitting || pending != nullptr; });
+      if (quitting) break;
+      current = std::move(pending);
+      while (current && !quitting) {
+        PlayQueue* queue = current.get();
+        lock.unlock();
+        int result = engine.play(queue->provider(), hooks);
+        lock.lock();
+        bool more = result != 2 && !stopWanted && queue->remaining() > 0;
+        if (!more || pending) current.reset();
+      }
+      stopWanted = false;
+    }
+    current.reset();
+  }
+
+  LinkedList empty;  // Backs queues made only of inserted tracks
+  std::unique_ptr<PlayQueue> current;  // Being played
+  std::unique_ptr<PlayQueue> pending;  // To play next, replacing 'current'
+  bool stopWanted;  // A stop command is waiting to take effect
+  bool quitting;
+  // Guards the queues and the flags. engine.stop() is called under it; the
+  // engine never calls back into the player holding a lock of its own.
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread thread;
+};
+
+// --- Command Handling ---
+
+class DaemonServer {
+public:
+  explicit DaemonServer(PlaylistRegistry& registry)
+      : registry(registry), shutdownRequested(false) {}
+
+  // Runs one command line; returns the full reply
+  std::string handle(const std::string& line);
+
+  bool shuttingDown() const { return shutdownRequested; }
+
+private:
+  // The playlist called 'name', loaded on first use; sets 'error' if none
+  LinkedList* playlist(const std::string& name, std::string& error);
+  // Track 'pos' (1-based) of playlist 'name'; sets 'error' if none
+  node* track(const std::string& name, const std::string& pos,
+              std::string& error);
+
+  PlaylistRegistry& registry;
+  DaemonPlayer player;
+  bool shutdownRequested;
+};
+
+LinkedList* DaemonServer::playlist(const std::string& name,
+                                   std::string& error) {
+  int index = registry.find(name);
+  if (index < 0) {
+    error = "no playlist '" + name + "'";
+    return nullptr;
+  }
+  LinkedList* list = registry.open(static_cast<size_t>(index));
+  if (list == nullptr) error = "cannot load playlist '" + name + "'";
+  return list;
+}
+
+node* DaemonServer::track(const std::string& name, const std::string& pos,
+                          std::string& error) {
+  LinkedList* list = playlist(name, error);
+  if (list == nullptr) return nullptr;
+  int position = 0;
+  if (!parseCount(pos, position) || position > list->len) {
+    error = "no track " + pos + " in '" + name + "'";
+    return nullptr;
+  }
+  return list->nodeAt(position);
+}
+
+std::string DaemonServer::handle(const std::string& line) {
+  std::vector<std::string> words;
+  if (!splitWords(line, words)) return "ERR unterminated quote\n";
+  if (words.empty()) return "ERR empty command\n";
+
+  const std::string command = toLowerCopy(words[0]);
+  const size_t argc = words.size() - 1;
+  std::ostringstream out;
+  std::string error;
+
+  if (command == "ping" && argc == 0) {
+    // Nothing to do
+  } else if (command == "lists" && argc == 0) {
+    for (size_t i = 0; i < registry.size(); ++i) {
+      out << "playlist: " << replyField(registry.nameAt(i)) << "\t"
+          << registry.lengthAt(i) << "\n";
+    }
+  } else if (command == "play" && argc >= 1 && argc <= 3) {
+    PlayOrder order = PlayOrder::SEQUENTIAL;
+    int rounds = 1;
+    if (argc >= 2) {
+      const std::string name = toLowerCopy(words[2]);
+      if (name == "sequential") {
+        order = PlayOrder::SEQUENTIAL;
+      } else if (name == "reverse") {
+        order = PlayOrder::REVERSE;
+      } else if (name == "shuffle") {
+        order = PlayOrder::SHUFFLE;
+      } else if (name == "spread") {
+        order = PlayOrder::ARTIST_SPREAD;
+      } else {
+        return "ERR unknown order '" + replyField(words[2]) + "'\n";
+      }
+    }
+    if (argc == 3 && !parseCount(words[3], rounds)) {
+      return "ERR invalid rounds '" + replyField(words[3]) + "'\n";
+    }
+    LinkedList* list = playlist(words[1], error);
+    if (list == nullptr) return "ERR " + replyField(error) + "\n";
+    if (list->isEmpty()) return "ERR playlist is empty\n";
+    player.start(std::make_unique<PlayQueue>(*list, order, rounds));
+    out << "queued: " << static_cast<long long>(list->len) * rounds << "\n";
+  } else if ((command == "enqueue" || command == "playnext") && argc == 2) {
+    node* item = track(words[1], words[2], error);
+    if (item == nullptr) return "ERR " + replyField(error) + "\n";
+    player.insert(item, command == "playnext");
+  } else if (command == "search" && argc == 2) {
+    LinkedList* list = playlist(words[1], error);
+    if (list == nullptr) return "ERR " + replyField(error) + "\n";
+    std::vector<node*> matches = list->findMatches(words[2]);
+    size_t shown = std::min<size_t>(matches.size(), DAEMON_SEARCH_LIMIT);
+    for (size_t i = 0; i < shown; ++i) {
+      const Track& t = matches[i]->track();
+      out << "match: " << list->positionOf(matches[i]) << "\t"
+          << replyField(t.cleanName) << "\t" << replyField(t.shownArtist())
+          << "\n";
+    }
+    out << "matches: " << matches.size() << "\n";
+  } else if (command == "pause" && argc == 0) {
+    player.engine.setPaused(true);
+  } else if (command == "resume" && argc == 0) {
+    player.engine.setPaused(false);
+  } else if (command == "toggle" && argc == 0) {
+    player.engine.setPaused(!player.engine.isPaused());
+  } else if (command == "stop" && argc == 0) {
+    player.stop();
+  } else if (command == "seek" && argc == 1) {
+    double seconds;
+    bool relative;
+    if (!parseAmount(words[1], seconds, relative)) {
+      return "ERR invalid time '" + replyField(words[1]) + "'\n";
+    }
+    if (!player.engine.seek(seconds, relative)) {
+      return "ERR nothing seekable is playing\n";
+    }
+  } else if (command == "volume" && argc == 1) {
+    double db;
+    bool relative;
+    if (!parseAmount(words[1], db, relative)) {
+      return "ERR invalid volume '" + replyField(words[1]) + "'\n";
+    }
+    AudioSession& session = AudioSession::instance();
+    double volume = session.setVolumeDb(relative ? session.volumeDb() + db
+                                                 : db);
+    out << "volume: " << volume << "\n";
+  } else if (command == "status" && argc == 0) {
+    NowPlaying now;
+    if (player.engine.nowPlaying(now)) {
+      out << "state: " << (now.paused ? "paused" : "playing") << "\n";
+      out << "track: " << replyField(now.track->track().cleanName) << "\n";
+      out << "artist: " << replyField(now.track->track().shownArtist()) << "\n";
+      out << "path: " << replyField(now.track->track().path) << "\n";
+      out << "position: " << static_cast<int>(now.positionSeconds) << "\n";
+      if (now.lengthSeconds >= 0) {
+        out << "length: " << static_cast<int>(now.lengthSeconds) << "\n";
+      }
+    } else {
+      out << "state: stopped\n";
+    }
+    out << "queued: " << player.remaining() << "\n";
+    out << "volume: " << AudioSession::instance().volumeDb() << "\n";
+  } else if (command == "shutdown" && argc == 0) {
+    shutdownRequested = true;
+  } else {
+    return "ERR unknown command or wrong arguments: " +
+           replyField(words[0]) + "\n";
+  }
+  out << "OK\n";
+  return out.str();
+}
+
+// --- Socket Server ---
+
+// One connected client: bytes read but not yet a full line, and reply
+// bytes not yet accepted by the socket
+struct DaemonClient {
+  int fd;
+  std::string input;
+  std::string output;
+  bool closing = false;  // Close once 'output' is sent
+};
+
+// Removes a socket file left behind by a daemon that did not exit cleanly;
+// refuses to touch anything else, or a socket that still answers
+static bool clearStaleSocket(const std::string& path) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) return errno == ENOENT;
+  if (!S_ISSOCK(st.st_mode)) return false;
+
+  int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (probe < 0) return false;
+  struct sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  bool live =
+      connect(probe, reinterpret_cast<struct sockaddr*>(&addr),
+              sizeof(addr)) == 0;
+  close(probe);
+  return !live && unlink(path.c_str()) == 0;
+}
+
+// Fills 'addr' for 'path'; false if the path does not fit
+static bool socketAddress(const std::string& path, struct sockaddr_un& addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+  std::memcpy(addr.sun_path, path.c_str(), path.size());
+  return true;
+}
+
+int runDaemon(const std::string& socketPath) {
+  struct sockaddr_un addr;
+  if (!socketAddress(socketPath, addr)) {
+    std::fprintf(stderr, "Socket path '%s' is empty or too long.\n",
+                 socketPath.c_str());
+    return 1;
+  }
+  if (!clearStaleSocket(socketPath)) {
+    std::fprintf(stderr, "'%s' exists and is not a stale socket.\n",
+                 socketPath.c_str());
+    return 1;
+  }
+
+  // SIGINT and SIGTERM arrive through a signalfd in the poll set; blocking
+  // them before any thread starts keeps them away from the other threads
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  signal(SIGPIPE, SIG_IGN);  // A client that hangs up is just closed
+  int signalFd = signalfd(-1, &signals, SFD_CLOEXEC | SFD_NONBLOCK);
+
+  int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (listenFd < 0 ||
+      bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr),
+           sizeof(addr)) != 0 ||
+      listen(listenFd, 16) != 0) {
+    std::fprintf(stderr, "Cannot listen on '%s': %s\n", socketPath.c_str(),
+                 std::strerror(errno));
+    if (listenFd >= 0) close(listenFd);
+    if (signalFd >= 0) close(signalFd);
+    return 1;
+  }
+
+  // Loaded once for the life of the daemon; playlists load on first use
+  PlaylistRegistry registry;
+  if (!registry.loadManifest()) {
+    std::fprintf(stderr, "Playlist manifest unreadable; starting empty.\n");
+  }
+  std::fprintf(stderr, "Listening on %s\n", socketPath.c_str());
+
+  {
+    DaemonServer server(registry);
+    std::vector<std::unique_ptr<DaemonClient>> clients;
+    bool running = true;
+    while (running) {
+      std::vector<struct pollfd> fds;
+      fds.push_back({listenFd, POLLIN, 0});
+      fds.push_back({signalFd, POLLIN, 0});
+      for (const auto& client : clients) {
+        short events = client->closing ? 0 : POLLIN;
+        if (!client->output.empty()) events |= POLLOUT;
+        fds.push_back({client->fd, events, 0});
+      }
+      if (poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+
+      if (fds[1].revents & POLLIN) {
+        std::fprintf(stderr, "Signal received, shutting down.\n");
+        running = false;
+      }
+      // Clients accepted below are polled from the next round on
+      size_t polled = clients.size();
+      if (fds[0].revents & POLLIN) {
+        int fd;
+        while ((fd = accept4(listenFd, nullptr, nullptr,
+                             SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+          clients.push_back(std::make_unique<DaemonClient>());
+          clients.back()->fd = fd;
+        }
+      }
+
+      for (size_t i = 0; i < polled; ++i) {
+        DaemonClient& client = *clients[i];
+        short revents = fds[i + 2].revents;
+        bool drop = (revents & (POLLERR | POLLNVAL)) != 0;
+
+        if (!drop && (revents & (POLLIN | POLLHUP)) && !client.closing) {
+          char buffer[4096];
+          ssize_t got = read(client.fd, buffer, sizeof(buffer));
+          if (got > 0) {
+            client.input.append(buffer, static_cast<size_t>(got));
+          } else if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+            client.closing = true;  // Answer what is complete, then close
+          }
+          size_t newline;
+          while ((newline = client.input.find('\n')) != std::string::npos) {
+            std::string line = client.input.substr(0, newline);
+            client.input.erase(0, newline + 1);
+            client.output += server.handle(line);
+            if (server.shuttingDown()) running = false;
+          }
+          if (client.input.size() > DAEMON_MAX_LINE) {
+            client.output += "ERR line too long\n";
+            client.input.clear();
+            client.closing = true;
+          }
+        }
+
+        if (!drop && !client.output.empty()) {
+          ssize_t sent = send(client.fd, client.output.data(),
+                              client.output.size(), MSG_NOSIGNAL);
+          if (sent > 0) {
+            client.output.erase(0, static_cast<size_t>(sent));
+          } else if (sent < 0 && errno != EAGAIN && errno != EINTR) {
+            drop = true;
+          }
+        }
+        if (drop || (client.closing && client.output.empty())) {
+          close(client.fd);
+          clients.erase(clients.begin() + i);
+          fds.erase(fds.begin() + i + 2);
+          --polled;
+          --i;
+        }
+      }
+    }
+
+    // Best effort: the replies to a final "shutdown" go out before exit
+    for (const auto& client : clients) {
+      if (!client->output.empty()) {
+        send(client->fd, client->output.data(), client->output.size(),
+             MSG_NOSIGNAL | MSG_DONTWAIT);
+      }
+      close(client->fd);
+    }
+  }  // The player stops and joins here
+
+  close(listenFd);
+  unlink(socketPath.c_str());
+  if (signalFd >= 0) close(signalFd);
+  AudioSession::instance().closeOutputs();
+  return 0;
+}
+
+// --- Client ---
+
+int sendDaemonCommand(const std::string& socketPath,
+                      const std::vector<std::string>& args) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 || !socketAddress(socketPath, addr) ||
+      connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) !=
+          0) {
+    std::fprintf(stderr, "Cannot connect to '%s': %s\n", socketPath.c_str(),
+                 std::strerror(errno));
+    if (fd >= 0) close(fd);
+    return 1;
+  }
+
+  std::string line;
+  for (const std::string& arg : args) {
+    if (!line.empty()) line += ' ';
+    bool quote = arg.empty() || arg.find_first_of(" \t") != std::string::npos;
+    line += quote ? "\"" + arg + "\"" : arg;
+  }
+  line += '\n';
+  signal(SIGPIPE, SIG_IGN);
+  if (send(fd, line.data(), line.size(), MSG_NOSIGNAL) !=
+      static_cast<ssize_t>(line.size())) {
+    std::fprintf(stderr, "Cannot send command: %s\n", std::strerror(errno));
+    close(fd);
+    return 1;
+  }
+
+  // Print the reply up to its final OK / ERR line
+  std::string reply;
+  char buffer[4096];
+  while (true) {
+    size_t newline;
+    while ((newline = reply.find('\n')) != std::string::npos) {
+      std::string replyLine = reply.substr(0, newline);
+      reply.erase(0, newline + 1);
+      if (replyLine == "OK") {
+        close(fd);
+        return 0;
+      }
+      if (replyLine.rfind("ERR", 0) == 0) {
+        std::fprintf(stderr, "%s\n", replyLine.c_str());
+        close(fd);
+        return 1;
+      }
+      std::printf("%s\n", replyLine.c_str());
+    }
+    ssize_t got = read(fd, buffer, sizeof(buffer));
+    if (got <= 0) break;
+    reply.append(buffer, static_cast<size_t>(got));
+  }
+  std::fprintf(stderr, "Connection closed before a reply.\n");
+  close(fd);
+  return 1;
+}
@@ -0,0 +1,44 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+#include <vector>
+
+// --- Daemon Mode ---
+// A long-running player without a terminal: the playlist registry, the
+// decoders and the open audio outputs stay in memory, and commands arrive
+// over a Unix-domain stream socket, so no command pays for a process start
+// or a playlist load.
+//
+// Protocol: one command per line, words separated by spaces; a word with
+// spaces goes in double quotes. Each reply is zero or more "key: value"
+// lines followed by "OK", or a single "ERR <reason>" line.
+//
+//   lists                       every playlist and its length
+//   play NAME [ORDER [ROUNDS]]  ORDER: sequential, reverse, shuffle, spread
+//   enqueue NAME POS            adds track POS of NAME to the play queue
+//   playnext NAME POS           same, ahead of everything still queued
+//   search NAME TERM            matching tracks of NAME (position, title)
+//   pause | resume | toggle
+//   stop                        stops and empties the queue
+//   seek SECONDS | +SECONDS | -SECONDS
+//   volume DB | +DB | -DB
+//   status                      state, track, position, queue length
+//   ping
+//   shutdown                    stops playback and exits the daemon
+
+// Longest accepted command line, in bytes
+#define DAEMON_MAX_LINE 4096
+// Most matches one search reply lists
+#define DAEMON_SEARCH_LIMIT 200
+
+// Serves commands on 'socketPath' until "shutdown", SIGINT or SIGTERM.
+// Returns the process exit code.
+int runDaemon(const std::string& socketPath);
+
+// Sends one command (the words of 'args') to the daemon at 'socketPath'
+// and prints its reply. Returns 0 on OK, 1 on ERR or if it cannot connect.
+int sendDaemonCommand(const std::string& socketPath,
+                      const std::vector<std::string>& args);
+
+#endif  // DAEMON_H
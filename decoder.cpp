@@ -0,0 +1,181 @@
+#include "decoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "dsp.h"   // dbToGain()
+#include "link.h"  // toLowerCopy(), fs
+
+// --- ReplayGain ---
+
+float ReplayGainInfo::linearGain() const {
+  if (!found) return 1.0f;
+  float gain = dbToGain(gainDb);
+  if (peak > 0.0 && gain * peak > 1.0) gain = static_cast<float>(1.0 / peak);
+  return gain;
+}
+
+void readReplayGainField(const std::string& name, const std::string& value,
+                         ReplayGainInfo& info) {
+  std::string key = toLowerCopy(name);
+  if (key == "replaygain_track_gain") {
+    info.gainDb = std::strtod(value.c_str(), nullptr);
+    info.found = true;
+  } else if (key == "replaygain_track_peak") {
+    info.peak = std::strtod(value.c_str(), nullptr);
+  }
+}
+
+void readVorbisComment(const char* entry, size_t length, StreamInfo& info) {
+  std::string comment(entry, length);
+  size_t equals = comment.find('=');
+  if (equals == std::string::npos) return;
+  std::string name = toLowerCopy(comment.substr(0, equals));
+  std::string value = comment.substr(equals + 1);
+
+  // A field may repeat (several artists); the first one is kept
+  std::string* tag = nullptr;
+  if (name == "artist") {
+    tag = &info.tags.artist;
+  } else if (name == "title") {
+    tag = &info.tags.title;
+  } else if (name == "album") {
+    tag = &info.tags.album;
+  }
+  if (tag != nullptr) {
+    if (tag->empty()) *tag = value;
+    return;
+  }
+  readReplayGainField(name, value, info.replayGain);
+}
+
+// --- Decoder ---
+
+long Decoder::readDirect(const float*& data, std::string& error) {
+  data = nullptr;
+  error = std::string(name()) + " decoder has no zero-copy read.";
+  return -1;
+}
+
+// --- DecoderRegistry Implementation ---
+
+DecoderRegistry& DecoderRegistry::instance() {
+  static DecoderRegistry registry;
+  return registry;
+}
+
+// Native libraries first; libsndfile takes anything they reject (and every
+// other extension, as the player always did)
+DecoderRegistry::DecoderRegistry() {
+  add({"mpg123", {".mp3"}, makeMpg123Decoder});
+  add({"flac", {".flac"}, makeFlacDecoder});
+  add({"vorbis", {".ogg", ".oga"}, makeVorbisDecoder});
+  add({"sndfile", {}, makeSndfileDecoder});
+}
+
+void DecoderRegistry::add(const DecoderBackend& backend) {
+  std::lock_guard<std::mutex> lock(mtx);
+  size_t index = backends.size();
+  backends.push_back(backend);
+  if (backend.extensions.empty()) {
+    anyExtension.push_back(index);
+  }
+  for (const std::string& extension : backend.extensions) {
+    byExtension[toLowerCopy(extension)].push_back(index);
+  }
+}
+
+bool DecoderRegistry::prefer(const std::string& extension,
+                             const std::string& backend) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto named = std::find_if(
+      backends.begin(), backends.end(),
+      [&](const DecoderBackend& b) { return b.name == backend; });
+  if (named == backends.end()) return false;
+
+  size_t index = static_cast<size_t>(named - backends.begin());
+  std::string key = toLowerCopy(extension);
+  std::vector<size_t>& order = byExtension[key];
+  auto existing = std::find(order.begin(), order.end(), index);
+  if (existing == order.end() && !named->extensions.empty()) {
+    if (order.empty()) byExtension.erase(key);
+    return false;  // Backend does not handle this extension
+  }
+
+  if (existing != order.end()) order.erase(existing);
+  order.insert(order.begin(), index);
+  return true;
+}
+
+std::vector<size_t> DecoderRegistry::candidates(
+    const std::string& extension) const {
+  std::vector<size_t> order;
+  auto it = byExtension.find(extension);
+  if (it != byExtension.end()) order = it->second;
+  for (size_t index : anyExtension) {
+    if (std::find(order.begin(), order.end(), index) == order.end()) {
+      order.push_back(index);
+    }
+  }
+  return order;
+}
+
+std::unique_ptr<Decoder> DecoderRegistry::open(const std::string& filename,
+                                               std::string& error) {
+  return openWith(filename, error, false);
+}
+
+std::unique_ptr<Decoder> DecoderRegistry::probe(const std::string& filename,
+                                                std::string& error) {
+  return openWith(filename, error, true);
+}
+
+std::unique_ptr<Decoder> DecoderRegistry::openWith(const std::string& filename,
+                                                   std::string& error,
+                                                   bool probeOnly) {
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (!file) {
+    error = "File not found or cannot be opened - " + filename;
+    return nullptr;
+  }
+  fclose(file);
+
+  std::vector<DecoderFactory> factories;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::string extension =
+        toLowerCopy(fs::path(filename).extension().string());
+    for (size_t index : candidates(extension)) {
+      factories.push_back(backends[index].create);
+    }
+  }
+
+  error.clear();
+  for (DecoderFactory create : factories) {
+    std::unique_ptr<Decoder> decoder = create();
+    std::string reason;
+    bool opened = probeOnly ? decoder->probe(filename, reason)
+                            : decoder->open(filename, reason);
+    if (opened) return decoder;
+    if (error.empty()) error = reason;  // The preferred backend's reason
+  }
+  if (error.empty()) error = "No decoder available for '" + filename + "'";
+  return nullptr;
+}
+
+std::unique_ptr<Decoder> DecoderRegistry::create(
+    const std::string& backend) const {
+  std::lock_guard<std::mutex> lock(mtx);
+  for (const DecoderBackend& b : backends) {
+    if (b.name == backend) return b.create();
+  }
+  return nullptr;
+}
+
+std::vector<std::string> DecoderRegistry::names() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  std::vector<std::string> result;
+  for (const DecoderBackend& b : backends) result.push_back(b.name);
+  return result;
+}
@@ -0,0 +1,174 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <sys/types.h>  // off_t
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- Decoders ---
+// One interface over every audio library the player can decode with. Each
+// backend lives in its own decoder_<name>.cpp and is registered with the
+// DecoderRegistry, which picks a backend for a file by its extension. The
+// playback engine drives all of them through the same loop.
+
+// Samples per read for backends without a natural block size
+#define DECODER_DEFAULT_BLOCK_SAMPLES 4096
+
+// Track gain and peak read from a file's tags, if it has them
+struct ReplayGainInfo {
+  bool found = false;   // A REPLAYGAIN_TRACK_GAIN tag was present
+  double gainDb = 0.0;  // Gain that brings the track to the reference level
+  double peak = 0.0;    // Largest sample magnitude (1.0 = full scale), or 0
+
+  // Linear gain to apply, lowered if needed so the peak does not clip
+  float linearGain() const;
+};
+
+// Takes the value of a REPLAYGAIN_TRACK_* field (the name in any case).
+// Values look like "-6.52 dB" and "0.988553".
+void readReplayGainField(const std::string& name, const std::string& value,
+                         ReplayGainInfo& info);
+
+// Descriptive tags read from a file; empty when the file has none
+struct StreamTags {
+  std::string artist;
+  std::string title;
+  std::string album;
+};
+
+// Format of an opened stream
+struct StreamInfo {
+  long rate = 0;           // Sample rate in Hz
+  int channels = 0;        // Interleaved channel count
+  off_t totalFrames = -1;  // Length in PCM frames (-1 if unknown)
+  bool pcm16 = false;      // 16-bit source: unity gain needs no dither
+  ReplayGainInfo replayGain;  // From the file's tags, if any
+  StreamTags tags;            // Artist, title and album, if tagged
+};
+
+// Takes one "NAME=value" Vorbis comment (as used by FLAC and Ogg Vorbis)
+// into the ReplayGain and descriptive tags of 'info'
+void readVorbisComment(const char* entry, size_t length, StreamInfo& info);
+
+// Produces interleaved float samples in [-1, 1) from one file. A decoder is
+// used by one thread at a time.
+class Decoder {
+public:
+  virtual ~Decoder() = default;
+
+  // Backend name, e.g. "mpg123"
+  virtual const char* name() const = 0;
+
+  // Opens the file and determines its format.
+  // On failure returns false and fills 'error' with a readable reason.
+  virtual bool open(const std::string& filename, std::string& error) = 0;
+
+  // Like open(), but only info() is wanted: no background work (such as an
+  // MP3 index scan) is started for the file.
+  virtual bool probe(const std::string& filename, std::string& error) {
+    return open(filename, error);
+  }
+
+  // Decodes up to 'maxSamples' interleaved samples (whole frames) into
+  // 'out'. Returns the number of samples, 0 at end of stream, -1 on error.
+  virtual long read(float* out, long maxSamples, std::string& error) = 0;
+
+  // Zero-copy read: points 'data' at the decoder's own buffer holding the
+  // next samples (at most preferredBlockSamples()), valid until the next
+  // call. Returns like read(). Only for backends with supportsDirectRead().
+  virtual long readDirect(const float*& data, std::string& error);
+
+  // Moves the read position to an absolute PCM frame
+  virtual bool seek(off_t frame) = 0;
+
+  // A more accurate length than info().totalFrames once the backend has
+  // one (e.g. from a background scan), else -1. Called by the reading
+  // thread between reads, so it must be cheap.
+  virtual off_t refinedLength() { return -1; }
+
+  // Samples per read that suit the backend (known once open() succeeded)
+  virtual long preferredBlockSamples() const {
+    return DECODER_DEFAULT_BLOCK_SAMPLES;
+  }
+
+  // True if readDirect() is available
+  virtual bool supportsDirectRead() const { return false; }
+
+  const StreamInfo& info() const { return stream; }
+
+protected:
+  StreamInfo stream;  // Filled by open()
+};
+
+// --- Decoder Registry ---
+// The backends the program is built with and the extensions each handles.
+// Opening a file tries the backends for its extension in order of
+// preference, so a file one library rejects can still play through another.
+
+using DecoderFactory = std::unique_ptr<Decoder> (*)();
+
+struct DecoderBackend {
+  std::string name;                     // Same as Decoder::name()
+  std::vector<std::string> extensions;  // Lowercase with the dot; empty = any
+  DecoderFactory create;
+};
+
+class DecoderRegistry {
+public:
+  // Returns the registry holding the built-in backends
+  static DecoderRegistry& instance();
+
+  // Adds a backend with lower preference than those already registered
+  void add(const DecoderBackend& backend);
+
+  // Makes 'backend' the first choice for 'extension'. Returns false if no
+  // backend of that name handles the extension.
+  bool prefer(const std::string& extension, const std::string& backend);
+
+  // Opens 'filename' with the first backend that accepts it. On failure
+  // returns nullptr and fills 'error' with the first backend's reason.
+  std::unique_ptr<Decoder> open(const std::string& filename,
+                                std::string& error);
+
+  // Same, through Decoder::probe(): for reading a file's format, length
+  // and tags without playing it
+  std::unique_ptr<Decoder> probe(const std::string& filename,
+                                 std::string& error);
+
+  // A new, unopened decoder from the named backend, or nullptr
+  std::unique_ptr<Decoder> create(const std::string& backend) const;
+
+  // Names of all backends, in registration order
+  std::vector<std::string> names() const;
+
+  DecoderRegistry(const DecoderRegistry&) = delete;
+  DecoderRegistry& operator=(const DecoderRegistry&) = delete;
+
+private:
+  DecoderRegistry();  // Registers the built-in backends
+
+  // Backend indices to try for 'extension', most preferred first
+  std::vector<size_t> candidates(const std::string& extension) const;
+  // Body of open() and probe()
+  std::unique_ptr<Decoder> openWith(const std::string& filename,
+                                    std::string& error, bool probeOnly);
+
+  std::vector<DecoderBackend> backends;
+  // Extension -> indices of the backends naming it, most preferred first
+  std::unordered_map<std::string, std::vector<size_t>> byExtension;
+  std::vector<size_t> anyExtension;  // Backends tried for every file, last
+  mutable std::mutex mtx;  // Opens run on several threads
+};
+
+// --- Built-in Backends ---
+std::unique_ptr<Decoder> makeMpg123Decoder();   // decoder_mpg123.cpp
+std::unique_ptr<Decoder> makeFlacDecoder();     // decoder_flac.cpp
+std::unique_ptr<Decoder> makeVorbisDecoder();   // decoder_vorbis.cpp
+std::unique_ptr<Decoder> makeSndfileDecoder();  // decoder_sndfile.cpp
+
+#endif  // DECODER_H
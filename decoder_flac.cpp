@@ -0,0 +1,171 @@
+#include "decoder.h"
+
+// Required for native FLAC decoding
+#include <FLAC/stream_decoder.h>
+
+#include <algorithm>
+#include <vector>
+
+// --- libFLAC Backend ---
+// libFLAC delivers one FLAC block at a time through a callback, as planar
+// integers. Each block is interleaved into 'pending' as float, which
+// readDirect() hands out in place and read() copies from.
+class FlacDecoder : public Decoder {
+public:
+  FlacDecoder() : decoder(nullptr), maxBlockFrames(0), pendingPos(0) {}
+  ~FlacDecoder() override {
+    if (decoder) {
+      FLAC__stream_decoder_finish(decoder);
+      FLAC__stream_decoder_delete(decoder);
+    }
+  }
+
+  const char* name() const override { return "flac"; }
+
+  bool open(const std::string& filename, std::string& error) override {
+    decoder = FLAC__stream_decoder_new();
+    if (!decoder) {
+      error = "Unable to create FLAC decoder.";
+      return false;
+    }
+    FLAC__stream_decoder_set_metadata_respond(
+        decoder, FLAC__METADATA_TYPE_VORBIS_COMMENT);  // ReplayGain, tags
+
+    FLAC__StreamDecoderInitStatus status = FLAC__stream_decoder_init_file(
+        decoder, filename.c_str(), writeCallback, metadataCallback,
+        errorCallback, this);
+    if (status != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+      error = "FLAC cannot open '" + filename +
+              "': " + FLAC__StreamDecoderInitStatusString[status];
+      return false;
+    }
+    if (!FLAC__stream_decoder_process_until_end_of_metadata(decoder) ||
+        stream.channels == 0) {
+      error = "FLAC cannot read the stream info of '" + filename + "': " +
+              FLAC__StreamDecoderStateString[FLAC__stream_decoder_get_state(
+                  decoder)];
+      return false;
+    }
+    return true;
+  }
+
+  long read(float* out, long maxSamples, std::string& error) override {
+    maxSamples -= maxSamples % stream.channels;  // Only hand out whole frames
+    if (!fillPending(error)) return -1;
+
+    long count = std::min(maxSamples,
+                          static_cast<long>(pending.size() - pendingPos));
+    std::copy(pending.begin() + pendingPos,
+              pending.begin() + pendingPos + count, out);
+    pendingPos += count;
+    return count;
+  }
+
+  // The rest of the current FLAC block, straight from 'pending'
+  long readDirect(const float*& data, std::string& error) override {
+    if (!fillPending(error)) return -1;
+    data = pending.data() + pendingPos;
+    long count = static_cast<long>(pending.size() - pendingPos);
+    pendingPos = pending.size();
+    return count;
+  }
+
+  bool seek(off_t frame) override {
+    pending.clear();  // The seek delivers the block holding 'frame'
+    pendingPos = 0;
+    if (FLAC__stream_decoder_seek_absolute(decoder, frame)) return true;
+    if (FLAC__stream_decoder_get_state(decoder) ==
+        FLAC__STREAM_DECODER_SEEK_ERROR) {
+      FLAC__stream_decoder_flush(decoder);  // Required before decoding on
+    }
+    return false;
+  }
+
+  // Largest block the stream info promises; at least the usual block
+  long preferredBlockSamples() const override {
+    long block = static_cast<long>(maxBlockFrames) * stream.channels;
+    return std::max(block, static_cast<long>(DECODER_DEFAULT_BLOCK_SAMPLES));
+  }
+
+  bool supportsDirectRead() const override { return true; }
+
+private:
+  // Decodes blocks until 'pending' has unread samples or the stream ends.
+  // Returns false on a decoding failure.
+  bool fillPending(std::string& error) {
+    while (pendingPos >= pending.size()) {
+      pending.clear();
+      pendingPos = 0;
+      FLAC__StreamDecoderState state = FLAC__stream_decoder_get_state(decoder);
+      if (state == FLAC__STREAM_DECODER_END_OF_STREAM) return true;
+      if (!FLAC__stream_decoder_process_single(decoder)) {
+        error = std::string("FLAC decoding error: ") +
+                FLAC__StreamDecoderStateString[FLAC__stream_decoder_get_state(
+                    decoder)];
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static FLAC__StreamDecoderWriteStatus writeCallback(
+      const FLAC__StreamDecoder* /*decoder*/, const FLAC__Frame* frame,
+      const FLAC__int32* const buffer[], void* clientData) {
+    FlacDecoder* self = static_cast<FlacDecoder*>(clientData);
+    const unsigned channels = frame->header.channels;
+    const unsigned frames = frame->header.blocksize;
+    if (channels != static_cast<unsigned>(self->stream.channels)) {
+      return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;  // Not a valid stream
+    }
+
+    const float scale = 1.0f / static_cast<float>(
+                                   1u << (frame->header.bits_per_sample - 1));
+    self->pending.resize(static_cast<size_t>(frames) * channels);
+    float* out = self->pending.data();
+    for (unsigned i = 0; i < frames; ++i) {
+      for (unsigned c = 0; c < channels; ++c) {
+        *out++ = static_cast<float>(buffer[c][i]) * scale;
+      }
+    }
+    self->pendingPos = 0;
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+  }
+
+  static void metadataCallback(const FLAC__StreamDecoder* /*decoder*/,
+                               const FLAC__StreamMetadata* metadata,
+                               void* clientData) {
+    FlacDecoder* self = static_cast<FlacDecoder*>(clientData);
+    if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO) {
+      const FLAC__StreamMetadata_StreamInfo& info = metadata->data.stream_info;
+      self->stream.rate = static_cast<long>(info.sample_rate);
+      self->stream.channels = static_cast<int>(info.channels);
+      self->stream.totalFrames = info.total_samples > 0
+                                     ? static_cast<off_t>(info.total_samples)
+                                     : -1;
+      self->stream.pcm16 = info.bits_per_sample == 16;
+      self->maxBlockFrames = info.max_blocksize;
+    } else if (metadata->type == FLAC__METADATA_TYPE_VORBIS_COMMENT) {
+      const FLAC__StreamMetadata_VorbisComment& comments =
+          metadata->data.vorbis_comment;
+      for (FLAC__uint32 i = 0; i < comments.num_comments; ++i) {
+        readVorbisComment(
+            reinterpret_cast<const char*>(comments.comments[i].entry),
+            comments.comments[i].length, self->stream);
+      }
+    }
+  }
+
+  // Lost sync and similar are recoverable: libFLAC resyncs by itself
+  static void errorCallback(const FLAC__StreamDecoder* /*decoder*/,
+                            FLAC__StreamDecoderErrorStatus /*status*/,
+                            void* /*clientData*/) {}
+
+  FLAC__StreamDecoder* decoder;
+  unsigned maxBlockFrames;     // Largest block, from STREAMINFO
+  std::vector<float> pending;  // Current block, interleaved
+  size_t pendingPos;           // Next unread sample in 'pending'
+};
+
+std::unique_ptr<Decoder> makeFlacDecoder() {
+  return std::make_unique<FlacDecoder>();
+}
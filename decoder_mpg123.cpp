@@ -0,0 +1,245 @@
+#include "decoder.h"
+
+// Required for MP3 decoding
+#include <mpg123.h>
+
+#include <vector>
+
+#include "dsp.h"        // s16ToFloat()
+#include "mp3_index.h"  // Background length scan and seek index
+#include "session.h"    // Shared mpg123 initialisation
+
+// Reads between checks for a finished background scan
+#define SCAN_POLL_READS 64
+
+// --- mpg123 Backend (MP3) ---
+// Decodes to float in the file's own rate and channel layout. Builds of
+// mpg123 without float output (some ARM ones) fall back to S16, widened in
+// read(). With float output, whole MPEG frames can be handed out straight
+// from mpg123's buffer.
+// open() never scans the file: the length comes from the Xing/Info or VBRI
+// header, or the bitrate, and a full scan is requested from Mp3IndexCache.
+// Once it finishes, its index is handed to mpg123 and its exact length is
+// reported through refinedLength(). probe() stops short of the request.
+class Mpg123Decoder : public Decoder {
+public:
+  Mpg123Decoder()
+      : mh(nullptr),
+        floatOutput(false),
+        samplesPerFrame(0),
+        haveStamp(false),
+        indexInstalled(false),
+        readsSincePoll(0),
+        exactLength(-1) {}
+  ~Mpg123Decoder() override { close(); }
+
+  const char* name() const override { return "mpg123"; }
+
+  bool open(const std::string& filename, std::string& error) override {
+    if (!probe(filename, error)) return false;
+
+    path = filename;
+    haveStamp = Mp3IndexCache::stampOf(path, stamp);
+    if (haveStamp) {
+      Mp3IndexCache::instance().request(path, stamp);
+      pollIndex();  // Seen before: the exact length is known at once
+    }
+    return true;
+  }
+
+  bool probe(const std::string& filename, std::string& error) override {
+    if (!AudioSession::instance().ensureMpg123()) {
+      error = "mpg123 library is unavailable.";
+      return false;
+    }
+
+    int mpg123_error_code = MPG123_OK;
+    mh = mpg123_new(NULL, &mpg123_error_code);
+    if (mh == NULL || mpg123_error_code != MPG123_OK) {
+      error = std::string("Unable to create mpg123 handle: ") +
+              mpg123_plain_strerror(mpg123_error_code);
+      mh = nullptr;
+      return false;
+    }
+
+    // The Xing/Info frame is kept: it holds the frame count (and the
+    // encoder delay and padding for gapless, sample-exact positions)
+    mpg123_param(mh, MPG123_VERBOSE, 0, 0.0);
+    mpg123_param(mh, MPG123_RESYNC_LIMIT, -1, 0.0);
+
+    if (mpg123_open(mh, filename.c_str()) != MPG123_OK) {
+      error = "mpg123 cannot open '" + filename + "': " + mpg123_strerror(mh);
+      close();
+      return false;
+    }
+
+    int encoding = 0;
+    if (mpg123_getformat(mh, &stream.rate, &stream.channels, &encoding) !=
+        MPG123_OK) {
+      error = "Cannot get initial audio format for '" + filename + "'";
+      close();
+      return false;
+    }
+
+    mpg123_format_none(mh);
+    floatOutput = mpg123_format(mh, stream.rate, stream.channels,
+                                MPG123_ENC_FLOAT_32) == MPG123_OK;
+    if (!floatOutput && mpg123_format(mh, stream.rate, stream.channels,
+                                      MPG123_ENC_SIGNED_16) != MPG123_OK) {
+      error = "mpg123 cannot set output format to float or S16LE.";
+      close();
+      return false;
+    }
+    stream.pcm16 = !floatOutput;
+
+    // Estimated from the headers; exact when the info frame is present
+    off_t length = mpg123_length(mh);
+    stream.totalFrames = length > 0 ? length : -1;
+    samplesPerFrame = mpg123_spf(mh) * stream.channels;
+    readID3();
+    return true;
+  }
+
+  long read(float* out, long maxSamples, std::string& error) override {
+    maxSamples -= maxSamples % stream.channels;  // Only hand out whole frames
+
+    // Without float output, decode S16 into the front of 'out' and widen
+    const size_t sampleBytes = floatOutput ? sizeof(float) : sizeof(short);
+    size_t bytes_decoded = 0;
+    while (true) {
+      int result =
+          mpg123_read(mh, out, maxSamples * sampleBytes, &bytes_decoded);
+      if (result == MPG123_DONE) return 0;
+      if (result == MPG123_NEW_FORMAT) continue;  // Format is forced anyway
+      if (result != MPG123_OK) {
+        error = std::string("mpg123 decoding error: ") +
+                mpg123_plain_strerror(result);
+        return -1;
+      }
+      if (bytes_decoded > 0) {
+        size_t samples = bytes_decoded / sampleBytes;
+        if (!floatOutput) {
+          s16ToFloat(reinterpret_cast<short*>(out), out, samples);
+        }
+        return static_cast<long>(samples);
+      }
+    }
+  }
+
+  // One decoded MPEG frame, read in place from mpg123's output buffer
+  long readDirect(const float*& data, std::string& error) override {
+    while (true) {
+      off_t frameNumber = 0;
+      unsigned char* audio = nullptr;
+      size_t bytes = 0;
+      int result = mpg123_decode_frame(mh, &frameNumber, &audio, &bytes);
+      if (result == MPG123_DONE) return 0;
+      if (result == MPG123_NEW_FORMAT) continue;  // Format is forced anyway
+      if (result != MPG123_OK) {
+        error = std::string("mpg123 decoding error: ") +
+                mpg123_plain_strerror(result);
+        return -1;
+      }
+      if (bytes > 0) {
+        data = reinterpret_cast<const float*>(audio);
+        return static_cast<long>(bytes / sizeof(float));
+      }
+    }
+  }
+
+  // 'frame' is a PCM frame; mpg123 lands on it exactly, from the nearest
+  // indexed MPEG frame when the scan has finished
+  bool seek(off_t frame) override {
+    pollIndex();
+    return mpg123_seek(mh, frame, SEEK_SET) >= 0;
+  }
+
+  off_t refinedLength() override {
+    if (++readsSincePoll >= SCAN_POLL_READS) pollIndex();
+    return exactLength;
+  }
+
+  // One MPEG frame; at least the engine's usual block
+  long preferredBlockSamples() const override {
+    return samplesPerFrame > DECODER_DEFAULT_BLOCK_SAMPLES
+               ? samplesPerFrame
+               : DECODER_DEFAULT_BLOCK_SAMPLES;
+  }
+
+  bool supportsDirectRead() const override { return floatOutput; }
+
+private:
+  void close() {
+    if (mh) {
+      mpg123_close(mh);
+      mpg123_delete(mh);
+      mh = nullptr;
+    }
+  }
+
+  // Fills 'tag' from an ID3v2 text frame, else from a fixed-size ID3v1
+  // field (space or NUL padded)
+  static void readID3Text(const mpg123_string* v2Text, const char* v1Field,
+                          size_t v1Size, std::string& tag) {
+    if (v2Text != nullptr && v2Text->fill > 1) {
+      tag.assign(v2Text->p, v2Text->fill - 1);  // 'fill' counts the NUL
+      return;
+    }
+    if (v1Field == nullptr) return;
+    size_t length = 0;
+    while (length < v1Size && v1Field[length] != '\0') ++length;
+    while (length > 0 && v1Field[length - 1] == ' ') --length;
+    tag.assign(v1Field, length);
+  }
+
+  // Artist, title and album from ID3v2 (or ID3v1); ReplayGain in MP3s is
+  // stored in ID3v2 TXXX frames
+  void readID3() {
+    mpg123_id3v1* v1 = nullptr;
+    mpg123_id3v2* v2 = nullptr;
+    if (mpg123_id3(mh, &v1, &v2) != MPG123_OK) return;
+    readID3Text(v2 ? v2->artist : nullptr, v1 ? v1->artist : nullptr,
+                sizeof(v1->artist), stream.tags.artist);
+    readID3Text(v2 ? v2->title : nullptr, v1 ? v1->title : nullptr,
+                sizeof(v1->title), stream.tags.title);
+    readID3Text(v2 ? v2->album : nullptr, v1 ? v1->album : nullptr,
+                sizeof(v1->album), stream.tags.album);
+    if (v2 == nullptr) return;
+    for (size_t i = 0; i < v2->extras; ++i) {
+      const mpg123_text& frame = v2->extra[i];
+      if (frame.description.p == nullptr || frame.text.p == nullptr) continue;
+      readReplayGainField(frame.description.p, frame.text.p, stream.replayGain);
+    }
+  }
+
+  // Installs the background scan's index and length once it is ready
+  void pollIndex() {
+    readsSincePoll = 0;
+    if (indexInstalled || !haveStamp) return;
+    std::shared_ptr<const Mp3SeekIndex> index =
+        Mp3IndexCache::instance().find(path, stamp);
+    if (!index) return;
+
+    if (!index->offsets.empty()) {
+      std::vector<off_t> offsets(index->offsets);  // mpg123 copies it again
+      mpg123_set_index(mh, offsets.data(), index->step, offsets.size());
+    }
+    if (index->totalFrames > 0) exactLength = index->totalFrames;
+    indexInstalled = true;
+  }
+
+  mpg123_handle* mh;
+  bool floatOutput;      // Decoding to float (else S16, widened in read())
+  long samplesPerFrame;  // Interleaved samples in one MPEG frame
+
+  std::string path;      // Key for Mp3IndexCache
+  Mp3FileStamp stamp;
+  bool haveStamp;        // 'stamp' could be read, so a scan was requested
+  bool indexInstalled;   // The scan's result has been applied
+  int readsSincePoll;
+  off_t exactLength;     // From the scan, or -1 until it finishes
+};
+
+std::unique_ptr<Decoder> makeMpg123Decoder() {
+  return std::make_unique<Mpg123Decoder>();
+}
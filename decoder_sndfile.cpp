@@ -0,0 +1,61 @@
+#include "decoder.h"
+
+// Required for FLAC, WAV, OGG support
+#include <sndfile.h>
+
+#include <cstring>
+
+// --- libsndfile Backend (WAV, AIFF, FLAC, Ogg and more) ---
+// The catch-all backend. libsndfile scales every format to float itself.
+class SndfileDecoder : public Decoder {
+public:
+  SndfileDecoder() : sndfile(nullptr) {}
+  ~SndfileDecoder() override {
+    if (sndfile) sf_close(sndfile);
+  }
+
+  const char* name() const override { return "sndfile"; }
+
+  bool open(const std::string& filename, std::string& error) override {
+    SF_INFO sfinfo;
+    memset(&sfinfo, 0, sizeof(sfinfo));
+
+    sndfile = sf_open(filename.c_str(), SFM_READ, &sfinfo);
+    if (!sndfile) {
+      error = std::string("Cannot open audio file with libsndfile: ") +
+              sf_strerror(NULL);
+      return false;
+    }
+    stream.rate = sfinfo.samplerate;
+    stream.channels = sfinfo.channels;
+    stream.totalFrames = sfinfo.frames > 0 ? sfinfo.frames : -1;
+    stream.pcm16 = (sfinfo.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_16;
+    readString(SF_STR_ARTIST, stream.tags.artist);
+    readString(SF_STR_TITLE, stream.tags.title);
+    readString(SF_STR_ALBUM, stream.tags.album);
+    return true;
+  }
+
+  long read(float* out, long maxSamples, std::string& /*error*/) override {
+    sf_count_t frames =
+        sf_readf_float(sndfile, out, maxSamples / stream.channels);
+    return frames > 0 ? static_cast<long>(frames * stream.channels) : 0;
+  }
+
+  bool seek(off_t frame) override {
+    return sf_seek(sndfile, frame, SEEK_SET) >= 0;
+  }
+
+private:
+  // One of the file's string chunks (e.g. WAV LIST/INFO), if present
+  void readString(int type, std::string& tag) {
+    const char* value = sf_get_string(sndfile, type);
+    if (value != nullptr) tag = value;
+  }
+
+  SNDFILE* sndfile;
+};
+
+std::unique_ptr<Decoder> makeSndfileDecoder() {
+  return std::make_unique<SndfileDecoder>();
+}
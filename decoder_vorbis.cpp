@@ -0,0 +1,80 @@
+#include "decoder.h"
+
+// Required for native Ogg Vorbis decoding
+#define OV_EXCLUDE_STATIC_CALLBACKS  // Only ov_fopen() is used
+#include <vorbis/vorbisfile.h>
+
+// --- libvorbisfile Backend (Ogg Vorbis) ---
+// vorbisfile decodes to planar float, which read() interleaves. A chained
+// stream is assumed to keep the first link's format.
+class VorbisDecoder : public Decoder {
+public:
+  VorbisDecoder() : opened(false) {}
+  ~VorbisDecoder() override {
+    if (opened) ov_clear(&vf);
+  }
+
+  const char* name() const override { return "vorbis"; }
+
+  bool open(const std::string& filename, std::string& error) override {
+    if (ov_fopen(filename.c_str(), &vf) != 0) {  // e.g. Ogg Opus or FLAC
+      error = "vorbisfile cannot open '" + filename + "' as Ogg Vorbis.";
+      return false;
+    }
+    opened = true;
+
+    vorbis_info* info = ov_info(&vf, -1);
+    if (!info) {
+      error = "Cannot get audio format for '" + filename + "'";
+      return false;
+    }
+    stream.rate = info->rate;
+    stream.channels = info->channels;
+    ogg_int64_t total = ov_pcm_total(&vf, -1);
+    stream.totalFrames = total > 0 ? static_cast<off_t>(total) : -1;
+
+    vorbis_comment* comments = ov_comment(&vf, -1);
+    for (int i = 0; comments && i < comments->comments; ++i) {
+      readVorbisComment(comments->user_comments[i],
+                        comments->comment_lengths[i], stream);
+    }
+    return true;
+  }
+
+  long read(float* out, long maxSamples, std::string& error) override {
+    const int channels = stream.channels;
+    while (true) {
+      float** planes = nullptr;
+      int bitstream = 0;
+      long frames = ov_read_float(&vf, &planes,
+                                  static_cast<int>(maxSamples / channels),
+                                  &bitstream);
+      if (frames == OV_HOLE) continue;  // Gap in the data: carry on after it
+      if (frames < 0) {
+        error = "Ogg Vorbis decoding error (" + std::to_string(frames) + ")";
+        return -1;
+      }
+      vorbis_info* info = ov_info(&vf, bitstream);
+      if (info && info->channels != channels) {
+        error = "Ogg Vorbis stream changed its channel count.";
+        return -1;
+      }
+      for (long i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) *out++ = planes[c][i];
+      }
+      return frames * channels;
+    }
+  }
+
+  bool seek(off_t frame) override {
+    return ov_pcm_seek(&vf, static_cast<ogg_int64_t>(frame)) == 0;
+  }
+
+private:
+  OggVorbis_File vf;
+  bool opened;  // 'vf' needs ov_clear()
+};
+
+std::unique_ptr<Decoder> makeVorbisDecoder() {
+  return std::make_unique<VorbisDecoder>();
+}
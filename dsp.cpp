@@ -0,0 +1,240 @@
+#include "dsp.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DSP_HAVE_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define DSP_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Converts 'count' float samples to S16, stepping the dither generators
+using ConvertFn = void (*)(const float* in, short* out, size_t count,
+                           float scale, float ditherAmp, uint32_t* lanes);
+
+// --- Scalar Kernel ---
+// The reference every vector kernel matches: sample i takes its dither from
+// generator i % DSP_DITHER_LANES, each generator is a xorshift32, and the
+// difference of its two 16-bit halves is a triangular value in (-1, 1).
+
+static inline uint32_t nextDither(uint32_t x) {
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+static void convertScalar(const float* in, short* out, size_t count,
+                          float scale, float ditherAmp, uint32_t* lanes) {
+  const float noiseScale = ditherAmp * (1.0f / 65536.0f);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t& state = lanes[i % DSP_DITHER_LANES];
+    state = nextDither(state);
+    int32_t diff = static_cast<int32_t>(state >> 16) -
+                   static_cast<int32_t>(state & 0xFFFF);
+
+    float v = in[i] * scale + static_cast<float>(diff) * noiseScale;
+    v = v > -32768.0f ? v : -32768.0f;  // Same order and NaN handling as
+    v = v < 32767.0f ? v : 32767.0f;    // the vector min/max below
+    out[i] = static_cast<short>(std::lrintf(v));
+  }
+}
+
+#ifdef DSP_HAVE_X86
+// --- SSE2 Kernel ---
+// Eight samples per step in two vectors, generators 0-3 and 4-7
+
+__attribute__((target("sse2"))) static inline __m128i nextDitherSse2(
+    __m128i x) {
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+__attribute__((target("sse2"))) static inline __m128i convert4Sse2(
+    const float* in, __m128i state, __m128 scale, __m128 noiseScale) {
+  __m128i diff = _mm_sub_epi32(_mm_srli_epi32(state, 16),
+                               _mm_and_si128(state, _mm_set1_epi32(0xFFFF)));
+  __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in), scale),
+                        _mm_mul_ps(_mm_cvtepi32_ps(diff), noiseScale));
+  v = _mm_max_ps(v, _mm_set1_ps(-32768.0f));
+  v = _mm_min_ps(v, _mm_set1_ps(32767.0f));
+  return _mm_cvtps_epi32(v);  // Rounds to nearest even, like lrintf
+}
+
+__attribute__((target("sse2"))) static void convertSse2(
+    const float* in, short* out, size_t count, float scale, float ditherAmp,
+    uint32_t* lanes) {
+  const __m128 vscale = _mm_set1_ps(scale);
+  const __m128 vnoise = _mm_set1_ps(ditherAmp * (1.0f / 65536.0f));
+  __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+  __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 4));
+
+  size_t i = 0;
+  for (; i + DSP_DITHER_LANES <= count; i += DSP_DITHER_LANES) {
+    s0 = nextDitherSse2(s0);
+    s1 = nextDitherSse2(s1);
+    __m128i a = convert4Sse2(in + i, s0, vscale, vnoise);
+    __m128i b = convert4Sse2(in + i + 4, s1, vscale, vnoise);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packs_epi32(a, b));  // Saturating pack to S16
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), s0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 4), s1);
+  convertScalar(in + i, out + i, count - i, scale, ditherAmp, lanes);
+}
+
+// --- AVX2 Kernel ---
+// Eight samples per step in one vector holding all eight generators
+
+__attribute__((target("avx2"))) static void convertAvx2(
+    const float* in, short* out, size_t count, float scale, float ditherAmp,
+    uint32_t* lanes) {
+  const __m256 vscale = _mm256_set1_ps(scale);
+  const __m256 vnoise = _mm256_set1_ps(ditherAmp * (1.0f / 65536.0f));
+  const __m256 lo = _mm256_set1_ps(-32768.0f);
+  const __m256 hi = _mm256_set1_ps(32767.0f);
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+  __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+
+  size_t i = 0;
+  for (; i + DSP_DITHER_LANES <= count; i += DSP_DITHER_LANES) {
+    s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 13));
+    s = _mm256_xor_si256(s, _mm256_srli_epi32(s, 17));
+    s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 5));
+    __m256i diff = _mm256_sub_epi32(_mm256_srli_epi32(s, 16),
+                                    _mm256_and_si256(s, mask));
+
+    __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), vscale),
+                             _mm256_mul_ps(_mm256_cvtepi32_ps(diff), vnoise));
+    v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+    __m256i r = _mm256_cvtps_epi32(v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packs_epi32(_mm256_castsi256_si128(r),
+                                     _mm256_extracti128_si256(r, 1)));
+  }
+
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), s);
+  convertScalar(in + i, out + i, count - i, scale, ditherAmp, lanes);
+}
+#endif  // DSP_HAVE_X86
+
+#ifdef DSP_HAVE_NEON
+// --- NEON Kernel ---
+// Eight samples per step in two vectors, generators 0-3 and 4-7
+
+static inline uint32x4_t nextDitherNeon(uint32x4_t x) {
+  x = veorq_u32(x, vshlq_n_u32(x, 13));
+  x = veorq_u32(x, vshrq_n_u32(x, 17));
+  return veorq_u32(x, vshlq_n_u32(x, 5));
+}
+
+static inline int32x4_t convert4Neon(const float* in, uint32x4_t state,
+                                     float32x4_t scale,
+                                     float32x4_t noiseScale) {
+  int32x4_t diff =
+      vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(state, 16)),
+                vreinterpretq_s32_u32(vandq_u32(state, vdupq_n_u32(0xFFFF))));
+  float32x4_t v = vaddq_f32(vmulq_f32(vld1q_f32(in), scale),
+                            vmulq_f32(vcvtq_f32_s32(diff), noiseScale));
+  v = vminq_f32(vmaxq_f32(v, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f));
+#ifdef __aarch64__
+  return vcvtnq_s32_f32(v);  // Rounds to nearest even, like lrintf
+#else
+  // ARMv7 only converts by truncation: add 0.5 away from zero first
+  uint32x4_t sign =
+      vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000u));
+  float32x4_t half =
+      vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(
+                                                vdupq_n_f32(0.5f))));
+  return vcvtq_s32_f32(vaddq_f32(v, half));
+#endif
+}
+
+static void convertNeon(const float* in, short* out, size_t count,
+                        float scale, float ditherAmp, uint32_t* lanes) {
+  const float32x4_t vscale = vdupq_n_f32(scale);
+  const float32x4_t vnoise = vdupq_n_f32(ditherAmp * (1.0f / 65536.0f));
+  uint32x4_t s0 = vld1q_u32(lanes);
+  uint32x4_t s1 = vld1q_u32(lanes + 4);
+
+  size_t i = 0;
+  for (; i + DSP_DITHER_LANES <= count; i += DSP_DITHER_LANES) {
+    s0 = nextDitherNeon(s0);
+    s1 = nextDitherNeon(s1);
+    int32x4_t a = convert4Neon(in + i, s0, vscale, vnoise);
+    int32x4_t b = convert4Neon(in + i + 4, s1, vscale, vnoise);
+    vst1q_s16(out + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+  }
+
+  vst1q_u32(lanes, s0);
+  vst1q_u32(lanes + 4, s1);
+  convertScalar(in + i, out + i, count - i, scale, ditherAmp, lanes);
+}
+#endif  // DSP_HAVE_NEON
+
+// --- Kernel Selection ---
+
+struct Kernel {
+  const char* name;
+  ConvertFn convert;
+};
+
+// Best kernel the running CPU supports. NEON is part of every AArch64 CPU,
+// so on ARM the choice is made by the build target instead.
+static Kernel pickKernel() {
+#ifdef DSP_HAVE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return {"avx2", convertAvx2};
+  if (__builtin_cpu_supports("sse2")) return {"sse2", convertSse2};
+#endif
+#ifdef DSP_HAVE_NEON
+  return {"neon", convertNeon};
+#endif
+  return {"scalar", convertScalar};
+}
+
+static const Kernel& kernel() {
+  static const Kernel chosen = pickKernel();  // Probed once, thread-safe
+  return chosen;
+}
+
+const char* dspKernelName() {
+  return kernel().name;
+}
+
+float dbToGain(double db) {
+  return static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+void s16ToFloat(const short* in, float* out, size_t count) {
+  // Back to front: out[i] covers the bytes of in[2i] and in[2i + 1], which
+  // have been read by then, so converting in place is safe
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+  for (size_t i = count; i-- > 0;) {
+    short sample;
+    std::memcpy(&sample, bytes + i * sizeof(short), sizeof(short));
+    out[i] = sample * (1.0f / 32768.0f);
+  }
+}
+
+// --- GainStage Implementation ---
+
+GainStage::GainStage() : scale(32768.0f), ditherAmp(1.0f) {
+  for (int k = 0; k < DSP_DITHER_LANES; ++k) {
+    lanes[k] = 0x9E3779B9u * static_cast<uint32_t>(k + 1);  // Never zero
+  }
+}
+
+void GainStage::setGain(float gain, bool dither) {
+  scale = gain * 32768.0f;
+  ditherAmp = dither ? 1.0f : 0.0f;
+}
+
+void GainStage::process(const float* in, short* out, size_t count) {
+  kernel().convert(in, out, count, scale, ditherAmp, lanes);
+}
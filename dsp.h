@@ -0,0 +1,47 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <cstddef>
+#include <cstdint>
+
+// --- DSP Stage ---
+// Sits between the decoders and the output stream. Decoders produce float
+// samples in [-1, 1); the gain stage scales them by the track's gain
+// (volume times ReplayGain), adds triangular dither and packs them to the
+// signed 16-bit samples the output stream takes. The conversion kernel is
+// picked once per process for the CPU it runs on (AVX2, SSE2, NEON or a
+// plain loop); every kernel produces the same samples.
+
+// Independent dither generators; one sample in 8 shares a generator
+#define DSP_DITHER_LANES 8
+
+// Converts a gain in decibels to a linear factor
+float dbToGain(double db);
+
+// Widens S16 samples to floats in [-1, 1). 'in' and 'out' may start at the
+// same address (the floats then overwrite the shorts as they are read).
+void s16ToFloat(const short* in, float* out, size_t count);
+
+// Name of the conversion kernel chosen for this CPU, e.g. "avx2"
+const char* dspKernelName();
+
+class GainStage {
+public:
+  GainStage();
+
+  // Sets the linear gain applied to every sample. With 'dither' false the
+  // samples are only rounded, which keeps a 16-bit source played at unity
+  // gain bit-exact.
+  void setGain(float gain, bool dither);
+
+  // Writes 'count' samples of in * gain to 'out' as S16, clipping at full
+  // scale. Keeps the dither state, so consecutive blocks form one stream.
+  void process(const float* in, short* out, size_t count);
+
+private:
+  float scale;      // gain * 32768: full scale in S16 steps
+  float ditherAmp;  // 1.0 for +/-1 LSB triangular dither, 0.0 for none
+  uint32_t lanes[DSP_DITHER_LANES];  // xorshift32 state per generator
+};
+
+#endif  // DSP_H
@@ -0,0 +1,609 @@
+#include "library.h"
+
+// Required for the inotify watcher and its wake-ups
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>  // For std::rename
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#include "catalog.h"     // Flags tracks whose files disappear
+#include "link.h"        // getCleanSongName(), toLowerCopy(), fs alias
+#include "metadata.h"    // Re-reads the tags of rewritten files
+#include "threadpool.h"  // Worker pool for the recursive scan
+
+using json = nlohmann::json;
+
+// Cache file written next to the playlists, and its format version
+#define LIBRARY_CACHE_FILE "music_library_cache.json"
+#define LIBRARY_CACHE_VERSION 1
+// Listing is I/O bound (network mounts especially), so use at least this
+// many scan threads even on machines with fewer cores
+#define LIBRARY_SCAN_THREADS_MIN 4
+// Events the watcher asks for on every directory
+#define LIBRARY_WATCH_EVENTS                                               \
+  (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | \
+   IN_ONLYDIR | IN_EXCL_UNLINK)
+
+// Extensions the browser lists (same set as getMusicFiles in link.h)
+static bool isSupportedExtension(const std::string& lowerExt) {
+  return lowerExt == ".mp3" || lowerExt == ".wav" || lowerExt == ".flac" ||
+         lowerExt == ".ogg";
+}
+
+// Last write time of 'p' as a plain integer, for comparison and storage
+static int64_t mtimeOf(const fs::path& p, std::error_code& ec) {
+  auto stamp = fs::last_write_time(p, ec);
+  return ec ? 0 : static_cast<int64_t>(stamp.time_since_epoch().count());
+}
+
+// Sorts 'items' on a lowercase copy of key(item) computed once per item;
+// ties keep their original order
+template <typename T, typename KeyFn>
+static void sortByLowerKey(std::vector<T>& items, KeyFn key) {
+  std::vector<std::pair<std::string, size_t>> keyed;
+  keyed.reserve(items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    keyed.emplace_back(toLowerCopy(key(items[i])), i);
+  }
+  std::sort(keyed.begin(), keyed.end());
+
+  std::vector<T> sorted;
+  sorted.reserve(items.size());
+  for (const auto& entry : keyed) {
+    sorted.push_back(std::move(items[entry.second]));
+  }
+  items.swap(sorted);
+}
+
+// Display name of a directory path (its last component)
+static std::string directoryName(const std::string& path) {
+  return fs::path(path).filename().string();
+}
+
+// Rebuilds dir.byStem from dir.files
+static void buildStemIndex(LibraryDirectory& dir) {
+  dir.byStem.clear();
+  for (size_t i = 0; i < dir.files.size(); ++i) {
+    std::string stem = fs::path(dir.files[i].path).stem().string();
+    dir.byStem[toLowerCopy(stem)].push_back(i);
+  }
+}
+
+// Reads one directory from disk into 'out'. Returns false if unreadable.
+static bool listDirectory(const std::string& dir, int64_t mtime,
+                          LibraryDirectory& out) {
+  out.mtime = mtime;
+  out.subdirs.clear();
+  out.files.clear();
+
+  std::error_code ec;
+  fs::directory_iterator it(dir, ec);
+  if (ec) {
+    std::cerr << "\t\tWarning: Cannot read directory '" << dir
+              << "': " << ec.message() << std::endl;
+    return false;
+  }
+
+  for (; it != fs::directory_iterator(); it.increment(ec)) {
+    if (ec) break;  // Entry vanished mid-listing; keep what we have
+    const fs::directory_entry& entry = *it;
+    std::error_code statError;
+
+    if (entry.is_directory(statError)) {
+      // Symlinked directories are skipped so link cycles cannot recurse
+      if (!entry.is_symlink(statError)) {
+        out.subdirs.push_back(entry.path().string());
+      }
+    } else if (entry.is_regular_file(statError)) {
+      std::string extension = toLowerCopy(entry.path().extension().string());
+      if (!isSupportedExtension(extension)) continue;
+
+      LibraryFile file;
+      file.path = entry.path().string();
+      file.cleanName = getCleanSongName(file.path);
+      file.extension = extension;
+      file.size = entry.file_size(statError);
+      if (statError) file.size = 0;
+      file.mtime = mtimeOf(entry.path(), statError);
+      out.files.push_back(std::move(file));
+    }
+  }
+
+  sortByLowerKey(out.subdirs,
+                 [](const std::string& path) { return directoryName(path); });
+  sortByLowerKey(out.files,
+                 [](const LibraryFile& file) { return file.cleanName; });
+  buildStemIndex(out);
+  return true;
+}
+
+// Loads the cache file; returns an empty map if it is missing or unusable
+static std::unordered_map<std::string, LibraryDirectory> readCacheFile() {
+  std::unordered_map<std::string, LibraryDirectory> cached;
+  std::ifstream file(LIBRARY_CACHE_FILE);
+  if (!file.is_open()) return cached;  // First run: nothing cached yet
+
+  try {
+    json cacheJson = json::parse(file);
+    if (cacheJson.value("version", 0) != LIBRARY_CACHE_VERSION) return cached;
+
+    for (const auto& dirJson : cacheJson.at("dirs")) {
+      LibraryDirectory dir;
+      dir.mtime = dirJson.at("mtime").get<int64_t>();
+      dir.subdirs = dirJson.at("subdirs").get<std::vector<std::string>>();
+      for (const auto& fileJson : dirJson.at("files")) {
+        LibraryFile f;
+        f.path = fileJson.at("path").get<std::string>();
+        f.cleanName = getCleanSongName(f.path);
+        f.extension = toLowerCopy(fs::path(f.path).extension().string());
+        f.mtime = fileJson.at("mtime").get<int64_t>();
+        f.size = fileJson.at("size").get<uint64_t>();
+        dir.files.push_back(std::move(f));
+      }
+      buildStemIndex(dir);
+      cached[dirJson.at("path").get<std::string>()] = std::move(dir);
+    }
+  } catch (const json::exception& e) {
+    std::cerr << "\t\tWarning: Ignoring damaged library cache: " << e.what()
+              << std::endl;
+    cached.clear();
+  }
+  return cached;
+}
+
+MusicLibrary& MusicLibrary::instance() {
+  static MusicLibrary library;  // Destroyed at process exit
+  return library;
+}
+
+MusicLibrary::MusicLibrary()
+    : scanning(false),
+      dirty(false),
+      inotifyFd(-1),
+      stopEvent(-1),
+      changeEvent(-1),
+      changes(0) {}
+
+MusicLibrary::~MusicLibrary() {
+  if (scanThread.joinable()) scanThread.join();
+  stopWatching();
+  if (inotifyFd >= 0) close(inotifyFd);
+  if (stopEvent >= 0) close(stopEvent);
+  if (changeEvent >= 0) close(changeEvent);
+}
+
+void MusicLibrary::startScan(const std::string& root) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (scanning) return;  // One scan at a time
+    scanning = true;
+  }
+  if (scanThread.joinable()) scanThread.join();  // Previous scan finished
+  scanThread = std::thread(&MusicLibrary::scanAll, this, root);
+}
+
+void MusicLibrary::scanAll(const std::string& root) {
+  // Directories from the last run; read-only while the workers use it
+  const std::unordered_map<std::string, LibraryDirectory> previous =
+      readCacheFile();
+
+  std::unordered_map<std::string, LibraryDirectory> found;
+  std::mutex foundMtx;  // Guards 'found' and 'changed'
+  bool changed = false;
+
+  unsigned workers = std::max(std::thread::hardware_concurrency(),
+                              static_cast<unsigned>(LIBRARY_SCAN_THREADS_MIN));
+  {
+    ThreadPool pool(workers);
+
+    // Lists (or reuses) one directory, then queues its subdirectories
+    std::function<void(const std::string&)> visit;
+    visit = [&](const std::string& path) {
+      std::error_code ec;
+      int64_t mtime = mtimeOf(path, ec);
+      if (ec) return;  // Directory disappeared or is inaccessible
+
+      LibraryDirectory dir;
+      bool relisted = false;
+      auto cached = previous.find(path);
+      if (cached != previous.end() && cached->second.mtime == mtime) {
+        dir = cached->second;  // Unchanged since the cache was written
+      } else if (listDirectory(path, mtime, dir)) {
+        relisted = true;
+      } else {
+        return;
+      }
+
+      for (const std::string& sub : dir.subdirs) {
+        pool.submit([&visit, sub]() { visit(sub); });
+      }
+
+      std::lock_guard<std::mutex> lock(foundMtx);
+      changed = changed || relisted;
+      found[path] = std::move(dir);
+    };
+
+    pool.submit([&visit, &root]() { visit(root); });
+    pool.wait();
+  }
+  if (found.size() != previous.size()) changed = true;  // Dirs went away
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    dirs.swap(found);
+    dirty = dirty || changed;
+    scanning = false;
+  }
+  scanDone.notify_all();
+  saveCache();
+}
+
+void MusicLibrary::waitForScan(std::unique_lock<std::mutex>& lock) {
+  scanDone.wait(lock, [this]() { return !scanning; });
+}
+
+const LibraryDirectory* MusicLibrary::freshDirectory(const std::string& dir) {
+  auto it = dirs.find(dir);
+  if (it != dirs.end() && it->second.watched) {
+    return &it->second;  // The watcher keeps it current, no stat needed
+  }
+
+  std::error_code ec;
+  int64_t mtime = mtimeOf(dir, ec);
+  if (ec) return nullptr;
+
+  if (it != dirs.end() && it->second.mtime == mtime) {
+    return &it->second;  // Cached listing is still current
+  }
+
+  LibraryDirectory entry;
+  if (!listDirectory(dir, mtime, entry)) return nullptr;
+  dirty = true;
+  LibraryDirectory& slot = dirs[dir];
+  slot = std::move(entry);
+  return &slot;
+}
+
+std::vector<std::pair<std::string, std::string>> MusicLibrary::subdirectories(
+    const std::string& dir) {
+  std::unique_lock<std::mutex> lock(mtx);
+  waitForScan(lock);
+
+  const LibraryDirectory* entry = freshDirectory(dir);
+  if (entry == nullptr) {
+    lock.unlock();
+    return getSubdirectories(dir);  // Reports or creates the missing dir
+  }
+
+  std::vector<std::pair<std::string, std::string>> result;
+  result.reserve(entry->subdirs.size());
+  for (const std::string& path : entry->subdirs) {
+    result.emplace_back(path, directoryName(path));
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, std::string>> MusicLibrary::musicFiles(
+    const std::string& dir) {
+  std::unique_lock<std::mutex> lock(mtx);
+  waitForScan(lock);
+
+  const LibraryDirectory* entry = freshDirectory(dir);
+  if (entry == nullptr) {
+    lock.unlock();
+    return getMusicFiles(dir);  // Reports or creates the missing dir
+  }
+
+  std::vector<std::pair<std::string, std::string>> result;
+  result.reserve(entry->files.size());
+  for (const LibraryFile& file : entry->files) {
+    result.emplace_back(file.path, file.cleanName);
+  }
+  return result;
+}
+
+bool MusicLibrary::filesWithStem(const std::string& dir,
+                                 const std::string& baseName,
+                                 std::vector<std::string>& paths) {
+  paths.clear();
+  std::unique_lock<std::mutex> lock(mtx);
+  waitForScan(lock);
+
+  const LibraryDirectory* entry = freshDirectory(dir);
+  if (entry == nullptr) return false;
+
+  auto it = entry->byStem.find(toLowerCopy(baseName));
+  if (it != entry->byStem.end()) {
+    for (size_t index : it->second) paths.push_back(entry->files[index].path);
+  }
+  return true;
+}
+
+bool MusicLibrary::saveCache() {
+  std::unique_lock<std::mutex> lock(mtx);
+  waitForScan(lock);
+  if (!dirty) return true;  // Disk copy is already current
+
+  json cacheJson;
+  cacheJson["version"] = LIBRARY_CACHE_VERSION;
+  json dirsArray = json::array();
+  for (const auto& entry : dirs) {
+    json dirJson;
+    dirJson["path"] = entry.first;
+    dirJson["mtime"] = entry.second.mtime;
+    dirJson["subdirs"] = entry.second.subdirs;
+    json filesArray = json::array();
+    for (const LibraryFile& file : entry.second.files) {
+      // Clean name and extension are derived from the path on load
+      filesArray.push_back(
+          {{"path", file.path}, {"mtime", file.mtime}, {"size", file.size}});
+    }
+    dirJson["files"] = filesArray;
+    dirsArray.push_back(dirJson);
+  }
+  cacheJson["dirs"] = dirsArray;
+
+  // Write a temporary file and rename it so a crash never leaves half a cache
+  const std::string tempName = std::string(LIBRARY_CACHE_FILE) + ".tmp";
+  {
+    std::ofstream file(tempName);
+    if (!file.is_open()) {
+      std::cerr << "\t\tWarning: Could not write library cache '" << tempName
+                << "'." << std::endl;
+      return false;
+    }
+    file << cacheJson.dump();
+    if (!file.good()) return false;
+  }
+  if (std::rename(tempName.c_str(), LIBRARY_CACHE_FILE) != 0) {
+    std::cerr << "\t\tWarning: Could not replace library cache." << std::endl;
+    return false;
+  }
+  dirty = false;
+  return true;
+}
+
+// --- Watcher ---
+
+bool MusicLibrary::startWatching(const std::string& root) {
+  if (watchThread.joinable()) return true;  // Already watching
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  changeEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (inotifyFd < 0 || stopEvent < 0 || changeEvent < 0) {
+    std::cerr << "\t\tWarning: Cannot watch the music directory; listings "
+                 "will be checked when shown."
+              << std::endl;
+    for (int* fd : {&inotifyFd, &stopEvent, &changeEvent}) {
+      if (*fd >= 0) close(*fd);
+      *fd = -1;
+    }
+    return false;
+  }
+  watchThread = std::thread(&MusicLibrary::watchLoop, this, root);
+  return true;
+}
+
+void MusicLibrary::stopWatching() {
+  if (!watchThread.joinable()) return;
+  uint64_t one = 1;
+  if (write(stopEvent, &one, sizeof(one)) < 0) {
+    // Cannot fail short of a saturated counter, which also wakes it
+  }
+  watchThread.join();
+  // Nothing keeps the listings current any more
+  std::lock_guard<std::mutex> lock(mtx);
+  for (auto& entry : dirs) entry.second.watched = false;
+}
+
+void MusicLibrary::announceChange() {
+  changes++;
+  uint64_t one = 1;
+  if (write(changeEvent, &one, sizeof(one)) < 0) {
+    // Counter saturated: readers are due to wake anyway
+  }
+}
+
+void MusicLibrary::watchDirectory(const std::string& dir) {
+  int wd = inotify_add_watch(inotifyFd, dir.c_str(), LIBRARY_WATCH_EVENTS);
+  if (wd < 0) return;  // E.g. out of watches: mtime checks cover it
+  watchPaths[wd] = dir;
+  watchIds[dir] = wd;
+
+  // Anything that changed before the watch existed is caught here
+  std::lock_guard<std::mutex> lock(mtx);
+  std::error_code ec;
+  int64_t mtime = mtimeOf(dir, ec);
+  auto it = dirs.find(dir);
+  if (ec || it == dirs.end()) return;
+  if (it->second.mtime != mtime) {
+    LibraryDirectory entry;
+    if (!listDirectory(dir, mtime, entry)) return;
+    it->second = std::move(entry);
+    dirty = true;
+  }
+  it->second.watched = true;
+}
+
+void MusicLibrary::addTree(const std::string& dir) {
+  // Watch first, then list, so nothing created in between is lost
+  int wd = inotify_add_watch(inotifyFd, dir.c_str(), LIBRARY_WATCH_EVENTS);
+  std::error_code ec;
+  LibraryDirectory entry;
+  if (!listDirectory(dir, mtimeOf(dir, ec), entry)) {
+    if (wd >= 0) inotify_rm_watch(inotifyFd, wd);
+    return;
+  }
+  if (wd >= 0) {
+    watchPaths[wd] = dir;
+    watchIds[dir] = wd;
+    entry.watched = true;
+  }
+  std::vector<std::string> subdirs = entry.subdirs;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const LibraryFile& file : entry.files) {
+      TrackCatalog::instance().setMissing(file.path, false);
+      MetadataStore::instance().request(file.path);
+    }
+    dirs[dir] = std::move(entry);
+    dirty = true;
+  }
+  for (const std::string& sub : subdirs) addTree(sub);
+}
+
+void MusicLibrary::removeTree(const std::string& dir) {
+  const std::string prefix = dir + "/";
+  std::lock_guard<std::mutex> lock(mtx);
+  for (auto it = dirs.begin(); it != dirs.end();) {
+    const std::string& path = it->first;
+    if (path != dir && path.compare(0, prefix.size(), prefix) != 0) {
+      ++it;
+      continue;
+    }
+    for (const LibraryFile& file : it->second.files) {
+      TrackCatalog::instance().setMissing(file.path, true);
+    }
+    auto watch = watchIds.find(path);
+    if (watch != watchIds.end()) {
+      // A moved directory is still watched at its new place
+      inotify_rm_watch(inotifyFd, watch->second);
+      watchPaths.erase(watch->second);
+      watchIds.erase(watch);
+    }
+    it = dirs.erase(it);
+    dirty = true;
+  }
+}
+
+void MusicLibrary::fileChanged(const std::string& dir, const std::string& path,
+                               bool present) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = dirs.find(dir);
+  if (it == dirs.end()) return;
+  std::vector<LibraryFile>& files = it->second.files;
+  auto existing = std::find_if(
+      files.begin(), files.end(),
+      [&path](const LibraryFile& file) { return file.path == path; });
+
+  if (!present) {
+    if (existing == files.end()) return;
+    files.erase(existing);
+    TrackCatalog::instance().setMissing(path, true);
+  } else {
+    std::error_code ec;
+    LibraryFile file;
+    file.path = path;
+    file.cleanName = getCleanSongName(path);
+    file.extension = toLowerCopy(fs::path(path).extension().string());
+    file.size = fs::file_size(path, ec);
+    if (ec) file.size = 0;
+    file.mtime = mtimeOf(path, ec);
+    if (existing != files.end()) {
+      *existing = std::move(file);  // Rewritten in place: same name, order
+    } else {
+      // Same order as sortByLowerKey(): by lowercase name, new ties last
+      const std::string key = toLowerCopy(file.cleanName);
+      auto at = std::upper_bound(
+          files.begin(), files.end(), key,
+          [](const std::string& k, const LibraryFile& f) {
+            return k < toLowerCopy(f.cleanName);
+          });
+      files.insert(at, std::move(file));
+    }
+    TrackCatalog::instance().setMissing(path, false);
+    MetadataStore::instance().request(path);  // Stamp changed: read again
+  }
+  buildStemIndex(it->second);
+  dirty = true;
+}
+
+// Watcher thread: waits for the scan, watches every directory it found,
+// then applies inotify events as they arrive until stopEvent fires.
+void MusicLibrary::watchLoop(const std::string& root) {
+  std::vector<std::string> found;
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    waitForScan(lock);
+    for (const auto& entry : dirs) {
+      if (entry.first == root ||
+          entry.first.compare(0, root.size() + 1, root + "/") == 0) {
+        found.push_back(entry.first);
+      }
+    }
+  }
+  for (const std::string& dir : found) watchDirectory(dir);
+
+  alignas(struct inotify_event) char buffer[16384];
+  while (true) {
+    struct pollfd fds[2];
+    fds[0] = {inotifyFd, POLLIN, 0};
+    fds[1] = {stopEvent, POLLIN, 0};
+    if (poll(fds, 2, -1) < 0) continue;  // EINTR
+    if (fds[1].revents & POLLIN) break;
+
+    ssize_t got = read(inotifyFd, buffer, sizeof(buffer));
+    if (got <= 0) continue;
+    bool changed = false;
+    for (char* at = buffer; at < buffer + got;) {
+      const struct inotify_event* event =
+          reinterpret_cast<const struct inotify_event*>(at);
+      at += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were dropped: fall back to mtime checks everywhere
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto& entry : dirs) entry.second.watched = false;
+        changed = true;
+        continue;
+      }
+      auto watch = watchPaths.find(event->wd);
+      if (watch == watchPaths.end()) continue;
+      const std::string dir = watch->second;
+      if (event->mask & IN_IGNORED) {  // Directory deleted or unmounted
+        watchIds.erase(dir);
+        watchPaths.erase(watch);
+        continue;
+      }
+      if (event->len == 0) continue;
+      const std::string path = dir + "/" + event->name;
+      const bool gone = (event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0;
+
+      if (event->mask & IN_ISDIR) {
+        if (gone) {
+          removeTree(path);
+        } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          addTree(path);
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        auto parent = dirs.find(dir);
+        if (parent == dirs.end()) continue;
+        std::vector<std::string>& subdirs = parent->second.subdirs;
+        subdirs.erase(std::remove(subdirs.begin(), subdirs.end(), path),
+                      subdirs.end());
+        if (!gone && dirs.count(path)) {
+          subdirs.push_back(path);
+          sortByLowerKey(subdirs, [](const std::string& p) {
+            return directoryName(p);
+          });
+        }
+        dirty = true;
+        changed = true;
+        continue;
+      }
+
+      std::string extension = toLowerCopy(fs::path(path).extension().string());
+      if (!isSupportedExtension(extension)) continue;
+      fileChanged(dir, path, !gone);
+      changed = true;
+    }
+    if (changed) announceChange();
+  }
+}
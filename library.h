@@ -0,0 +1,137 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// --- Music Library Scanner ---
+// Walks the music directory recursively on a thread pool and keeps, for
+// every directory, its subdirectories and supported audio files. Results
+// are persisted to an on-disk cache; on the next startup a directory whose
+// mtime is unchanged is taken from the cache instead of being re-listed.
+// The browser in main.cpp reads listings from here rather than the disk.
+//
+// After the scan an inotify watcher keeps the listings current: each
+// create, delete, move or finished write updates just the entries it
+// names, tracks whose files disappear are flagged missing in the catalog,
+// and waiters on changeFd() hear about it. A watched directory's listing
+// is trusted without a stat, so nothing is re-scanned after startup.
+
+// One audio file found by the scanner
+struct LibraryFile {
+  std::string path;       // Full path, e.g. "music/Album/01. Song.mp3"
+  std::string cleanName;  // getCleanSongName(path), shown in the browser
+  std::string extension;  // Lowercase, including the dot (e.g. ".mp3")
+  int64_t mtime;          // Last write time (filesystem clock ticks)
+  uint64_t size;          // File size in bytes
+};
+
+// Direct (non-recursive) contents of one directory
+struct LibraryDirectory {
+  int64_t mtime;                     // Directory mtime when it was listed
+  std::vector<std::string> subdirs;  // Full paths, sorted by name
+  std::vector<LibraryFile> files;    // Sorted by clean name
+
+  // Lowercase file stem (name without extension) -> indices into 'files'.
+  // Rebuilt whenever the directory is listed or loaded, never stored.
+  std::unordered_map<std::string, std::vector<size_t>> byStem;
+
+  // Kept current by the watcher, so the listing needs no mtime check
+  bool watched = false;
+};
+
+class MusicLibrary {
+public:
+  // Returns the single library shared by the whole process
+  static MusicLibrary& instance();
+
+  // Loads the cache and starts scanning 'root' in the background.
+  // Later calls are ignored while a scan is running.
+  void startScan(const std::string& root = "music");
+
+  // Listings for the browser, in the same shape as getSubdirectories() and
+  // getMusicFiles(): (full path, display name), sorted case-insensitively.
+  // They wait for a running scan, then re-list 'dir' only if its mtime
+  // changed since it was cached.
+  std::vector<std::pair<std::string, std::string>> subdirectories(
+      const std::string& dir);
+  std::vector<std::pair<std::string, std::string>> musicFiles(
+      const std::string& dir);
+
+  // Stores in 'paths' every audio file in 'dir' whose stem equals
+  // 'baseName' case-insensitively, using the directory's stem hash.
+  // Returns false if 'dir' cannot be read.
+  bool filesWithStem(const std::string& dir, const std::string& baseName,
+                     std::vector<std::string>& paths);
+
+  // Writes the cache to disk if anything changed. Returns false on failure.
+  bool saveCache();
+
+  // Starts the inotify watcher for the tree under 'root' once the scan is
+  // done. Returns false (leaving mtime checks in charge) if inotify is
+  // unavailable.
+  bool startWatching(const std::string& root = "music");
+  // Ends the watcher thread, if one runs; listings go back to mtime checks.
+  // Called at exit before the metadata readers stop, as it queues reads.
+  void stopWatching();
+
+  // Readable (an eventfd) whenever the watcher has changed a listing;
+  // -1 until startWatching() succeeds. Readers reset it with read().
+  int changeFd() const { return changeEvent; }
+  // Number of changes the watcher has applied so far
+  uint64_t changeCount() const { return changes.load(); }
+
+  MusicLibrary(const MusicLibrary&) = delete;
+  MusicLibrary& operator=(const MusicLibrary&) = delete;
+
+private:
+  MusicLibrary();
+  ~MusicLibrary();
+
+  // Body of the background scan thread
+  void scanAll(const std::string& root);
+  // Returns the up-to-date entry for 'dir', re-listing it if stale, or
+  // nullptr if it cannot be read. Caller holds 'mtx' after waitForScan().
+  const LibraryDirectory* freshDirectory(const std::string& dir);
+  void waitForScan(std::unique_lock<std::mutex>& lock);
+
+  // --- Watcher (watcher thread only, apart from the flags in 'dirs') ---
+  // Body of the watcher thread
+  void watchLoop(const std::string& root);
+  // Watches 'dir' and marks its listing watched, re-listing it first if it
+  // changed since it was listed
+  void watchDirectory(const std::string& dir);
+  // Lists and watches a directory tree that appeared at 'dir'
+  void addTree(const std::string& dir);
+  // Forgets the tree at 'dir' and flags its files missing
+  void removeTree(const std::string& dir);
+  // A file under watched directory 'dir' appeared, changed or went away
+  void fileChanged(const std::string& dir, const std::string& path,
+                   bool present);
+  // Records that a listing changed and wakes changeFd() readers
+  void announceChange();
+
+  std::unordered_map<std::string, LibraryDirectory> dirs;  // Keyed by path
+  bool scanning;  // Background scan in progress
+  bool dirty;     // 'dirs' differs from the cache file on disk
+  std::mutex mtx;
+  std::condition_variable scanDone;
+  std::thread scanThread;
+
+  int inotifyFd;    // -1 when not watching
+  int stopEvent;    // eventfd that ends the watcher thread
+  int changeEvent;  // eventfd behind changeFd()
+  std::atomic<uint64_t> changes;
+  std::unordered_map<int, std::string> watchPaths;  // Watch -> directory
+  std::unordered_map<std::string, int> watchIds;    // Directory -> watch
+  std::thread watchThread;
+};
+
+#endif  // LIBRARY_H
@@ -1,13 +1,35 @@
 #include "link.h"  // Includes string, iostream, algorithm, cctype, iomanip etc.
 // link.h contains declarations for LinkedList and Stack classes
 
+// Required for syncing saved playlists to disk
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>   // For the shared revision counter
+#include <cstdio>   // For std::rename, std::remove
+#include <cstdlib>  // For std::strtol
 #include <fstream>  // For file input/output streams (ofstream, ifstream)
 #include <iomanip>  // Needed for std::setw for output formatting
+#include <limits>   // For std::numeric_limits
+#include <sstream>  // For formatting cached rows
 #include <nlohmann/json.hpp>  // External library for JSON handling
 
+#include "binary_playlist.h"  // isBinaryPlaylist() for format detection
+#include "search_index.h"     // Trigram index behind findMatches()
+#include "stats.h"            // List operation timers
+
 // For convenience - allows using 'json' instead of 'nlohmann::json'
 using json = nlohmann::json;
 
+// Lists shorter than this are searched by a plain scan; at this size and
+// above findMatches() builds and maintains a trigram index
+#define SEARCH_INDEX_MIN_LEN 512
+// The index is only used when its candidates are at most 1/N of the list
+#define SEARCH_INDEX_MAX_SHARE 16
+// Lines around a display() page: its header and footer, and the prompt
+// callers print beneath it
+#define DISPLAY_RESERVED_ROWS 10
+
 // Utility functions (caseInsensitiveCompareEqual, getCleanSongName) are defined
 // inline in link.h - these handle case-insensitive string operations and file
 // path cleaning
@@ -19,7 +41,15 @@ using json = nlohmann::json;
 // listName = "": playlist has no name initially
 // len = 0: list length is zero
 // taken = false: list slot is not in use initially
-LinkedList::LinkedList() : head(nullptr), listName(""), len(0), taken(false) {}
+// root = nullptr: the position index is empty too
+LinkedList::LinkedList()
+    : head(nullptr),
+      listName(""),
+      len(0),
+      taken(false),
+      root(nullptr),
+      prioritySeed(2463534242u),
+      changeStamp(0) {}
 
 // Destructor: Ensures all nodes are deleted when the list object is destroyed
 // Calls clear() to free all allocated memory for nodes
@@ -33,14 +63,11 @@ LinkedList::~LinkedList() {
 // topPtr = nullptr: stack is empty initially
 Stack::Stack() : topPtr(nullptr) {}
 
-// Destructor: Deletes all stackNode structures
-// Iterates through stack nodes and frees memory
+// Destructor: Drops all stackNode structures
+// stackNode is trivially destructible, so the pool frees its slabs at once
 Stack::~Stack() {
-  while (!isEmpty()) {
-    stackNode* temp = topPtr;  // Store current top node
-    topPtr = topPtr->next;     // Move top pointer to next node
-    delete temp;               // Delete the old top node
-  }
+  topPtr = nullptr;
+  nodePool.release();
 }
 
 // Checks if the stack is empty
@@ -52,7 +79,7 @@ bool Stack::isEmpty() const {
 // Pushes a pointer to a LinkedList node onto the stack
 // Creates a new stackNode that holds the item pointer and links to current top
 void Stack::push(node* item) {
-  stackNode* newStackNode = new stackNode(
+  stackNode* newStackNode = nodePool.create(
       item, topPtr);      // Create new node with item and link to current top
   topPtr = newStackNode;  // Update top to point to new node
 }
@@ -66,53 +93,208 @@ node* Stack::pop() {
   stackNode* temp = topPtr;           // Store current top node to delete later
   node* itemToReturn = topPtr->item;  // Get the stored LinkedList node pointer
   topPtr = topPtr->next;              // Move stack top down to next node
-  delete temp;                        // Free memory of the removed stackNode
+  nodePool.destroy(temp);             // Recycle the removed stackNode
   return itemToReturn;                // Return the LinkedList node pointer
 }
 
+// Links 'newNode' into the ring immediately before 'at'
+// Does not touch head or len; callers decide whether the node becomes head
+void LinkedList::linkBefore(node* at, node* newNode) {
+  newNode->next = at;        // New node points forward to 'at'
+  newNode->prev = at->prev;  // ...and back to the node that preceded 'at'
+  at->prev->next = newNode;  // Old predecessor now points to the new node
+  at->prev = newNode;        // 'at' now points back to the new node
+}
+
+// Unlinks 'target' from the ring and frees it
+// Only valid when the list has more than one node; the caller fixes up head
+void LinkedList::unlinkNode(node* target) {
+  target->prev->next = target->next;  // Predecessor skips over target
+  target->next->prev = target->prev;  // Successor points back past target
+  destroyNode(target);                // Return the node's slot to the pool
+}
+
+// --- Position Index (implicit treap) ---
+// Each node is also a treap node: in-order traversal gives list order, and
+// subtree sizes turn a position into a root-to-leaf descent.
+
+// Size of a (possibly empty) subtree
+static int treeSize(const node* t) {
+  return t ? t->size : 0;
+}
+
+// Recomputes t->size from its children and points them back at 't'
+static void updateSize(node* t) {
+  t->size = 1 + treeSize(t->left) + treeSize(t->right);
+  if (t->left) t->left->parent = t;
+  if (t->right) t->right->parent = t;
+}
+
+// Joins two treaps where every node of 'a' comes before every node of 'b'
+static node* treeMerge(node* a, node* b) {
+  if (!a) return b;
+  if (!b) return a;
+  if (a->priority > b->priority) {  // 'a' stays on top
+    a->right = treeMerge(a->right, b);
+    updateSize(a);
+    return a;
+  }
+  b->left = treeMerge(a, b->left);  // 'b' stays on top
+  updateSize(b);
+  return b;
+}
+
+// Splits 't' into the first 'k' nodes ('a') and the rest ('b')
+static void treeSplit(node* t, int k, node*& a, node*& b) {
+  if (!t) {
+    a = b = nullptr;
+    return;
+  }
+  if (treeSize(t->left) < k) {  // 't' belongs to the first part
+    treeSplit(t->right, k - treeSize(t->left) - 1, t->right, b);
+    a = t;
+  } else {  // 't' belongs to the second part
+    treeSplit(t->left, k, a, t->left);
+    b = t;
+  }
+  updateSize(t);
+}
+
+void LinkedList::indexInsert(int pos, node* newNode) {
+  // xorshift32: cheap, well-spread priorities keep the treap balanced
+  prioritySeed ^= prioritySeed << 13;
+  prioritySeed ^= prioritySeed >> 17;
+  prioritySeed ^= prioritySeed << 5;
+  newNode->priority = prioritySeed;
+  newNode->left = newNode->right = nullptr;
+  newNode->size = 1;
+
+  node *before, *after;
+  treeSplit(root, pos - 1, before, after);
+  root = treeMerge(treeMerge(before, newNode), after);
+  root->parent = nullptr;
+}
+
+node* LinkedList::indexErase(int pos) {
+  node *before, *target, *after;
+  treeSplit(root, pos - 1, before, after);
+  treeSplit(after, 1, target, after);
+  root = treeMerge(before, after);
+  if (root) root->parent = nullptr;
+  return target;
+}
+
+// Builds a treap over the ring order in one pass, keeping each node's
+// priority: a stack holds the right spine of the tree built so far.
+void LinkedList::rebuildIndex() {
+  root = nullptr;
+  if (head == nullptr) return;
+
+  std::vector<node*> spine;
+  node* current = head;
+  do {
+    current->left = current->right = nullptr;
+    node* lastPopped = nullptr;
+    while (!spine.empty() && spine.back()->priority < current->priority) {
+      lastPopped = spine.back();
+      spine.pop_back();
+      updateSize(lastPopped);  // Its subtree is final once it leaves the spine
+    }
+    current->left = lastPopped;
+    if (!spine.empty()) spine.back()->right = current;
+    spine.push_back(current);
+    current = current->next;
+  } while (current != head);
+
+  // Remaining spine nodes are finalised bottom-up
+  for (size_t i = spine.size(); i-- > 0;) updateSize(spine[i]);
+  root = spine.front();
+  root->parent = nullptr;
+}
+
+// Returns the node at 1-based position 'pos', or nullptr if out of range
+node* LinkedList::nodeAt(int pos) const {
+  if (pos < 1 || pos > len) return nullptr;
+  node* t = root;
+  while (t) {
+    int leftSize = treeSize(t->left);
+    if (pos <= leftSize) {
+      t = t->left;
+    } else if (pos == leftSize + 1) {
+      return t;
+    } else {
+      pos -= leftSize + 1;
+      t = t->right;
+    }
+  }
+  return nullptr;  // Unreachable while the index matches 'len'
+}
+
+// Returns the 1-based position of 'n', which must belong to this list
+int LinkedList::positionOf(const node* n) const {
+  int pos = treeSize(n->left) + 1;
+  for (const node* t = n; t->parent != nullptr; t = t->parent) {
+    if (t == t->parent->right) {  // Parent and its left subtree come first
+      pos += treeSize(t->parent->left) + 1;
+    }
+  }
+  return pos;
+}
+
+// Revisions come from one process-wide counter, so no two lists ever share
+// one; lists load on several threads at once
+void LinkedList::touch() {
+  static std::atomic<uint64_t> lastStamp{0};
+  changeStamp = lastStamp.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+node* LinkedList::createNode(const std::string& song,
+                             const std::string& artist) {
+  node* newNode = nodePool.create(song, artist);
+  if (searchIndex) searchIndex->add(newNode);
+  touch();
+  return newNode;
+}
+
+void LinkedList::destroyNode(node* target) {
+  if (searchIndex) searchIndex->remove(target);
+  nodePool.destroy(target);
+  touch();
+}
+
 // Adds a song to the beginning of the list
 // Handles both empty and non-empty lists, maintaining circular structure
 void LinkedList::add_beg(const std::string& song, const std::string& artist) {
-  node* newNode = new node(song, artist);  // Create new node with song data
+  ScopedTimer timer(StatTimer::LIST_ADD);
+  node* newNode = createNode(song, artist);  // Node with song data
 
   if (head == nullptr) {   // Case 1: List is currently empty
     head = newNode;        // Set head to the new node
-    newNode->next = head;  // Point to itself to make it circular
-  } else {                 // Case 2: List has existing nodes
-    node* last = head;
-    // Find the current last node (the one pointing back to head)
-    while (last->next !=
-           head) {  // Traverse until we find node pointing to head
-      last = last->next;
-    }
-    newNode->next = head;  // New node points to the old head
-    head = newNode;        // Update head to point to the new node
-    last->next = head;     // Update last node to point to new head (maintaining
-                           // circular structure)
+    newNode->next = head;  // Point to itself in both directions
+    newNode->prev = head;
+  } else {                      // Case 2: List has existing nodes
+    linkBefore(head, newNode);  // Insert between the tail and the old head
+    head = newNode;             // ...and make the new node the head
   }
-  len++;  // Increment the song count
+  indexInsert(1, newNode);  // First position in the index
+  len++;                    // Increment the song count
 }
 
 // Adds a song to the end of the list
 // Handles both empty and non-empty lists, maintaining circular structure
 void LinkedList::add_end(const std::string& song, const std::string& artist) {
-  node* newNode = new node(song, artist);  // Create new node with song data
+  ScopedTimer timer(StatTimer::LIST_ADD);
+  node* newNode = createNode(song, artist);  // Node with song data
 
   if (head == nullptr) {   // Case 1: List is empty
     head = newNode;        // Set head to the new node
-    newNode->next = head;  // Point to itself to make it circular
-  } else {                 // Case 2: List has existing nodes
-    node* temp = head;
-    // Find the current last node
-    while (temp->next !=
-           head) {  // Traverse until we find node pointing to head
-      temp = temp->next;
-    }
-    temp->next = newNode;  // Old last node points to the new node
-    newNode->next =
-        head;  // New node points back to the head to maintain circularity
+    newNode->next = head;  // Point to itself in both directions
+    newNode->prev = head;
+  } else {                      // Case 2: List has existing nodes
+    linkBefore(head, newNode);  // The slot before head is the tail, O(1)
   }
-  len++;  // Increment count
+  indexInsert(len + 1, newNode);  // Last position in the index
+  len++;                          // Increment count
 }
 
 // Adds a song at a specific 1-based position
@@ -131,17 +313,12 @@ void LinkedList::add_at(const std::string& song, const std::string& artist,
   } else if (pos == len + 1) {
     add_end(song, artist);  // Special case: add at end
   } else {                  // Case 3: Inserting somewhere in the middle
-    node* newNode = new node(song, artist);  // Create new node
-    node* temp = head;
-    // Traverse to the node *before* the desired insertion point (pos-1)
-    for (int i = 1; i < pos - 1; ++i) {  // Loop until we reach position-1
-      // Safety check, should not happen with valid pos range
-      if (temp->next == head) break;  // Prevent infinite loop
-      temp = temp->next;              // Move to next node
-    }
-    newNode->next = temp->next;  // New node points to node at position
-    temp->next = newNode;        // Node at position-1 points to new node
-    len++;                       // Increment count
+    // The new node takes the place of the node currently at 'pos'
+    ScopedTimer timer(StatTimer::LIST_ADD);
+    node* newNode = createNode(song, artist);
+    linkBefore(nodeAt(pos), newNode);
+    indexInsert(pos, newNode);
+    len++;  // Increment count
   }
 }
 
@@ -152,22 +329,18 @@ void LinkedList::del_beg() {
     std::cerr << "\t\tWarning: Cannot delete from empty list." << std::endl;
     return;  // Exit if list is empty
   }
+  ScopedTimer timer(StatTimer::LIST_DELETE);
 
-  len--;  // Decrement count first
+  indexErase(1);  // Drop the first node from the position index
+  len--;          // Decrement count first
 
   if (head->next == head) {  // Case 1: List has only one node
-    delete head;             // Delete the single node
+    destroyNode(head);       // Delete the single node
     head = nullptr;          // Reset head to empty list
   } else {                   // Case 2: List has multiple nodes
-    node* last = head;
-    // Find the last node (the one pointing to head)
-    while (last->next != head) {
-      last = last->next;
-    }
-    node* temp = head;  // Store old head to delete
-    head = head->next;  // Move head to the second node
-    last->next = head;  // Update last node to point to new head
-    delete temp;        // Free the memory of the old head
+    node* temp = head;       // Store old head to delete
+    head = head->next;       // Move head to the second node
+    unlinkNode(temp);        // Tail and new head now point to each other
   }
 }
 
@@ -178,24 +351,16 @@ void LinkedList::del_end() {
     std::cerr << "\t\tWarning: Cannot delete from empty list." << std::endl;
     return;  // Exit if list is empty
   }
+  ScopedTimer timer(StatTimer::LIST_DELETE);
 
-  len--;  // Decrement count
+  indexErase(len);  // Drop the last node from the position index
+  len--;            // Decrement count
 
   if (head->next == head) {  // Case 1: Only one node
-    delete head;             // Delete the single node
+    destroyNode(head);       // Delete the single node
     head = nullptr;          // Reset head to empty list
   } else {                   // Case 2: Multiple nodes
-    node* temp = head;
-    node* follow = nullptr;  // Will point to the node *before* temp
-
-    // Traverse until temp is the last node
-    while (temp->next != head) {  // Loop until temp is the last node
-      follow = temp;              // Keep track of node before temp
-      temp = temp->next;          // Move temp forward
-    }
-    // Now temp is the last node, follow is the second-to-last
-    follow->next = head;  // Make second-to-last point back to head
-    delete temp;          // Delete the last node
+    unlinkNode(head->prev);  // The tail is reached directly, no traversal
   }
 }
 
@@ -216,28 +381,47 @@ void LinkedList::del_at(int pos) {
   if (pos == 1) {
     del_beg();  // Special case: delete at beginning
   } else if (pos == len) {
-    del_end();  // Special case: delete at end (more efficient)
+    del_end();  // Special case: delete at end
   } else {      // Case 3: Deleting from the middle
-    node* temp = head;
-    node* follow = nullptr;  // Node before temp
-
-    // Traverse so temp points to the node *at* the desired position 'pos'
-    for (int i = 1; i < pos; ++i) {   // Loop until we reach position
-      if (temp->next == head) break;  // Safety check against infinite loop
-      follow = temp;                  // Keep track of previous node
-      temp = temp->next;              // Move temp forward
-    }
+    ScopedTimer timer(StatTimer::LIST_DELETE);
+    unlinkNode(indexErase(pos));  // Index lookup, then relink neighbours
+    len--;  // Decrement count only for middle deletion
+  }
+}
+
+// One row of display(): position, title, length and artist, truncated
+static std::string formatDisplayRow(const node* n, size_t position) {
+  // Clean name was computed when the node was inserted
+  std::string cleanName = n->track().cleanName;
 
-    // Now follow points to the node before temp, temp is the one to delete
-    follow->next = temp->next;  // Link previous node to next node
-    delete temp;                // Free the memory of the deleted node
-    len--;                      // Decrement count only for middle deletion
+  // Safely handle song name
+  if (cleanName.find('\0') != std::string::npos) {
+    cleanName = "[Corrupted Song]";
   }
+  if (n->track().missing) cleanName = "(missing) " + cleanName;
+
+  // Safely handle artist name (the tagged one if none was entered)
+  std::string safeArtist = n->track().shownArtist();
+  if (safeArtist.find('\0') != std::string::npos) {
+    safeArtist = "[Unknown]";
+  }
+
+  // Length from the metadata pass; blank until it has been read
+  int durationMs = n->track().durationMs.load();
+  std::string length = durationMs > 0 ? formatDuration(durationMs) : "";
+
+  std::ostringstream row;
+  row << "\t\t" << std::left << std::setw(3) << position << ". "
+      << std::setw(35)
+      << cleanName.substr(0, 35)  // Truncate song name if too long
+      << " " << std::right << std::setw(7) << length << std::left << " -- "
+      << safeArtist.substr(0, 20);  // Truncate artist name if too long
+  return row.str();
 }
 
-// Displays the contents of the playlist
-// Shows playlist name and all songs with formatting
-void LinkedList::display() const {
+// Displays one page of the playlist
+// Shows playlist name, the page's songs and the total running time
+ViewPage LinkedList::display(size_t page) const {
   // Safely display playlist name
   std::string safeName = listName;
   if (safeName.find('\0') != std::string::npos) {
@@ -249,39 +433,96 @@ void LinkedList::display() const {
   std::cout << "\t\t\tPlaylist: " << safeName << std::endl;
   std::cout << "\t\t\t------------------------------------" << std::endl;
 
+  ViewPage shown = viewPage(page, static_cast<size_t>(len),
+                            pageRows(DISPLAY_RESERVED_ROWS));
   if (head == nullptr) {
     std::cout << std::endl
               << "\t\t\t(List is empty)"
               << std::endl;  // Message for empty list
-  } else {
-    node* temp = head;  // Start at head node
-    int count = 1;      // Track position for display
-    do {
-      // Get clean name using helper from link.h
-      std::string cleanName = getCleanSongName(temp->song);
+    return shown;
+  }
 
-      // Safely handle song name
-      if (cleanName.find('\0') != std::string::npos) {
-        cleanName = "[Corrupted Song]";
-      }
+  // Rows stay valid until the list changes, or the tags, length or
+  // missing flag of a track do
+  displayRows.sync(changeStamp, TrackCatalog::instance().revision());
 
-      // Safely handle artist name
-      std::string safeArtist = temp->artist;
-      if (safeArtist.find('\0') != std::string::npos) {
-        safeArtist = "[Unknown]";
-      }
+  node* temp = nodeAt(static_cast<int>(shown.first) + 1);  // O(log n)
+  for (size_t i = shown.first; i < shown.first + shown.count; ++i) {
+    const std::string* row = displayRows.find(i);
+    if (row == nullptr) {
+      row = &displayRows.store(i, formatDisplayRow(temp, i + 1));
+    }
+    std::cout << *row << '\n';
+    temp = temp->next;  // Move to next node
+  }
+  std::cout << std::endl;
+
+  // The total walks the whole list, so it is cached like a row
+  const std::string* total = displayRows.find(VIEW_SUMMARY_ROW);
+  if (total == nullptr) {
+    total = &displayRows.store(VIEW_SUMMARY_ROW, totalTimeLine(*this));
+  }
+  if (shown.pages > 1) {
+    std::cout << "\t\t\tPage " << shown.number << " of " << shown.pages
+              << " (N next, P previous)" << std::endl;
+  }
+  std::cout << "\t\t\t" << *total << std::endl << std::endl;
+  return shown;
+}
+
+std::string totalTimeLine(const LinkedList& li) {
+  int unknown = 0;
+  long long totalMs = li.totalDurationMs(&unknown);
+  std::string line = "Total time: " + formatDuration(totalMs);
+  if (unknown > 0) {
+    line += " (+" + std::to_string(unknown) + " not yet known)";
+  }
+  return line;
+}
+
+// Reads positions until one is in range, turning pages on N and P
+int choosePosition(const LinkedList& li, const std::string& prompt) {
+  size_t pageNumber = 1;
+  ViewPage page = li.display(pageNumber);
+  std::string input;
+  while (true) {
+    std::cout << prompt << std::flush;
+    if (!(std::cin >> input)) return 0;  // Input ended
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+    if (turnPage(input, page, pageNumber)) {
+      clearTerminal();  // Redraw in place: one page, not the whole list
+      page = li.display(pageNumber);
+      continue;
+    }
+    char* end = nullptr;
+    long position = std::strtol(input.c_str(), &end, 10);
+    if (*end == '\0' && position >= 1 && position <= li.len) {
+      return static_cast<int>(position);
+    }
+    std::cout << "\t\t⚠️ Invalid input. Please enter a number between 1 and "
+              << li.len << ", or N / P to turn the page." << std::endl;
+  }
+}
 
-      // Use std::setw for formatting (requires <iomanip>)
-      std::cout << "\t\t" << std::left << std::setw(3) << count++ << ". "
-                << std::setw(35)
-                << cleanName.substr(0, 35)  // Truncate song name if too long
-                << " -- "
-                << safeArtist.substr(0, 20)  // Truncate artist name if too long
-                << std::endl;
-      temp = temp->next;  // Move to next node
-    } while (temp != head);  // Loop until back to the start (circular list)
-    std::cout << std::endl;
+// Sums the known track lengths; 'unknown' (if given) counts the rest
+long long LinkedList::totalDurationMs(int* unknown) const {
+  long long total = 0;
+  int missingLengths = 0;
+  node* temp = head;
+  if (temp != nullptr) {
+    do {
+      int durationMs = temp->track().durationMs.load();
+      if (durationMs > 0) {
+        total += durationMs;
+      } else {
+        missingLengths++;
+      }
+      temp = temp->next;
+    } while (temp != head);
   }
+  if (unknown != nullptr) *unknown = missingLengths;
+  return total;
 }
 
 // Deletes all nodes in the list, freeing memory
@@ -289,30 +530,26 @@ void LinkedList::display() const {
 void LinkedList::clear() {
   if (head == nullptr) return;  // Nothing to clear if list is empty
 
-  // Safety check: ensure we have a valid circular list
-  if (head->next == nullptr) {
-    // Single node that's not properly circular
-    delete head;
-    head = nullptr;
-    len = 0;
-    return;
-  }
-
-  node* current = head->next;  // Start from node after head
-  head->next =
+  head->prev->next =
       nullptr;  // IMPORTANT: Break the circle FIRST to avoid infinite loop
 
+  searchIndex.reset();  // Cheaper to drop than to unregister node by node
+
   // Delete all nodes except the original head
-  while (current != nullptr) {     // Continue until we reach the end
-    node* nodeToDelete = current;  // Store current node to delete
-    current = current->next;       // Move to next node
-    delete nodeToDelete;           // Free memory of stored node
+  node* current = head->next;        // Start from node after head
+  while (current != nullptr) {       // Continue until we pass the old tail
+    node* nodeToDelete = current;    // Store current node to delete
+    current = current->next;         // Move to next node
+    nodePool.destroy(nodeToDelete);  // Destroy stored node
   }
 
-  // Now delete the original head node
-  delete head;     // Delete the head node
-  head = nullptr;  // Reset head pointer to null
+  // Now delete the original head node and hand every slab back at once
+  nodePool.destroy(head);  // Delete the head node
+  nodePool.release();      // O(1) in allocations rather than one per node
+  head = nullptr;          // Reset head pointer to null
+  root = nullptr;  // Position index is empty too
   len = 0;         // Reset length to zero
+  touch();         // Cached views of it are stale
   // Note: listName and taken status are NOT reset by clear() itself,
   // the calling function (like handleDeleteList) should handle those.
 }
@@ -323,169 +560,416 @@ bool LinkedList::isEmpty() const {
   return head == nullptr;
 }
 
-// Searches for songs containing the searchTerm (case-insensitive)
-// Displays matching songs with their positions
+// Searches for songs whose title or artist contains searchTerm
+// (case-insensitive) and displays the matches with their positions
 void LinkedList::search(const std::string& searchTerm) const {
   if (head == nullptr) {
     std::cout << "\t\tList is empty. Nothing to search." << std::endl;
     return;  // Exit if list is empty
   }
 
-  node* temp = head;   // Start at head node
-  bool found = false;  // Track if any matches were found
-  int position = 1;    // Track current position
+  std::cout << "\t\tSearching for text: \"" << searchTerm << "\"" << std::endl;
+
+  std::vector<node*> matches = findMatches(searchTerm);
+  for (node* match : matches) {
+    std::cout << "\t\t✅ Match found at position " << positionOf(match) << ":"
+              << std::endl;
+    std::cout << "\t\t   Song: " << match->track().cleanName << std::endl;
+    std::cout << "\t\t   Artist: " << match->track().shownArtist() << std::endl;
+    // Optionally show full path for debugging/clarity
+    // std::cout << "\t\t   (Full Path: " << match->track().path << ")"
+    //           << std::endl;
+  }
+
+  if (matches.empty()) {
+    std::cout << "\t\t❌ No songs found containing that text." << std::endl;
+  }
+}
+
+// Collects matching nodes in list order
+// Uses the trigram index for large lists, a linear scan otherwise
+std::vector<node*> LinkedList::findMatches(
+    const std::string& searchTerm) const {
+  ScopedTimer timer(StatTimer::LIST_SEARCH);
+  std::vector<node*> matches;
+  if (head == nullptr) return matches;
 
   // Prepare lowercase search term for case-insensitive comparison
-  std::string lowerSearchTerm;
-  lowerSearchTerm.reserve(
-      searchTerm.size());  // Pre-allocate memory for efficiency
-  std::transform(
-      searchTerm.begin(), searchTerm.end(), std::back_inserter(lowerSearchTerm),
-      [](unsigned char c) { return std::tolower(c); });  // Convert to lowercase
+  const std::string lowerSearchTerm = toLowerCopy(searchTerm);
+
+  // Indexed path: terms of 3+ bytes on lists worth indexing
+  if (lowerSearchTerm.size() >= 3 && len >= SEARCH_INDEX_MIN_LEN) {
+    // Read before the walks, so tags published during them are caught by
+    // the next search
+    const uint64_t catalogRevision = TrackCatalog::instance().revision();
+    if (!searchIndex) {  // First large search: index every node once
+      searchIndex.reset(new SearchIndex());
+      searchIndex->syncCatalog(catalogRevision);
+      node* temp = head;
+      do {
+        searchIndex->add(temp);
+        temp = temp->next;
+      } while (temp != head);
+    } else if (searchIndex->syncCatalog(catalogRevision)) {
+      // Tags arrived since the last search: re-index tracks whose shown
+      // artist they replaced
+      node* temp = head;
+      do {
+        searchIndex->refresh(temp);
+        temp = temp->next;
+      } while (temp != head);
+    }
 
-  std::cout << "\t\tSearching for text: \"" << searchTerm << "\"" << std::endl;
+    // The index returns matches unordered; order them by list position.
+    // Terms too common to narrow the search fall through to the scan,
+    // which yields list order for free.
+    std::vector<node*> found;
+    if (searchIndex->query(lowerSearchTerm, len / SEARCH_INDEX_MAX_SHARE,
+                           found)) {
+      std::vector<std::pair<int, node*>> ranked;
+      ranked.reserve(found.size());
+      for (node* match : found) ranked.emplace_back(positionOf(match), match);
+      std::sort(ranked.begin(), ranked.end());
+      for (const auto& entry : ranked) matches.push_back(entry.second);
+      return matches;
+    }
+  }
 
-  // Iterate through the list
+  // Linear scan for small lists and short terms (songKey and
+  // shownArtistKey() are the cached lowercase title and listed artist)
+  node* temp = head;
   do {
-    // Get clean version of the current song name (filename without path)
-    std::string cleanListSong = getCleanSongName(temp->song);
-
-    // Prepare lowercase version of the current song name
-    std::string lowerListSong;
-    lowerListSong.reserve(cleanListSong.size());  // Pre-allocate memory
-    std::transform(cleanListSong.begin(), cleanListSong.end(),
-                   std::back_inserter(lowerListSong), [](unsigned char c) {
-                     return std::tolower(c);
-                   });  // Convert to lowercase
-
-    // Check if the lowercase song name contains the lowercase search term
-    if (lowerListSong.find(lowerSearchTerm) !=
-        std::string::npos) {  // String found
-      std::cout << "\t\t✅ Match found at position " << position << ":"
-                << std::endl;
-      std::cout << "\t\t   Song: " << cleanListSong << std::endl;
-      std::cout << "\t\t   Artist: " << temp->artist << std::endl;
-      // Optionally show full path for debugging/clarity
-      // std::cout << "\t\t   (Full Path: " << temp->song << ")" << std::endl;
-      found = true;  // Mark that we found at least one match
-      // Continue searching for more matches (don't break)
+    const Track& track = temp->track();
+    if (track.songKey.find(lowerSearchTerm) != std::string::npos ||
+        track.shownArtistKey().find(lowerSearchTerm) != std::string::npos) {
+      matches.push_back(temp);
     }
     temp = temp->next;  // Move to next node
-    position++;         // Increment position counter
   } while (temp != head);  // Loop through the circular list until back to head
-
-  if (!found) {
-    std::cout << "\t\t❌ No songs found containing that text." << std::endl;
-  }
+  return matches;
 }
 
 // Private helper to swap the *data* fields of two nodes
 // Used by sorting algorithms to exchange node contents without changing links
 void LinkedList::swapNodesData(node* a, node* b) {
-  if (a && b && a != b) {             // Ensure nodes are valid and different
-    std::swap(a->song, b->song);      // Swap song data
-    std::swap(a->artist, b->artist);  // Swap artist data
+  if (a && b && a != b) {  // Ensure nodes are valid and different
+    if (searchIndex) {  // Index entries follow the keys
+      searchIndex->remove(a);
+      searchIndex->remove(b);
+    }
+    std::swap(a->trackId, b->trackId);  // All song data lives in the catalog
+    touch();
+    if (searchIndex) {
+      searchIndex->add(a);
+      searchIndex->add(b);
+    }
   }
 }
 
-// Sorts the list by song title (case-insensitive) using Bubble Sort
-// Maintains list structure while sorting just the data
-void LinkedList::sortBySong() {
-  if (head == nullptr || head->next == head)
+// Returns the cached lowercase collation key for one node and sort field.
+// The artist is the tagged one when only a placeholder was entered.
+static const std::string& collationKey(const node* n, SortKey key) {
+  return (key == SortKey::SONG) ? n->track().songKey
+                                : n->track().shownArtistKey();
+}
+
+// Sorts the list on 'keys' (most significant first) with a stable sort.
+// Keys are cached on each node at insert time, so comparisons are plain
+// string compares; the nodes are relinked in sorted order afterwards.
+void LinkedList::sortBy(const std::vector<SortKey>& keys) {
+  if (head == nullptr || head->next == head || keys.empty())
     return;  // Already sorted if 0 or 1 element
+  ScopedTimer timer(StatTimer::LIST_SORT);
 
-  bool swapped;  // Flag to track if any swaps occurred in pass
+  // Collect nodes in their current order
+  std::vector<node*> nodes;
+  nodes.reserve(len);
+  node* current = head;
   do {
-    swapped = false;       // Reset swap flag for each pass
-    node* current = head;  // Start at head
-    // In a circular list, we iterate 'len-1' times for comparisons in one pass
-    for (int i = 0; i < len - 1; ++i) {
-      node* nextNode = current->next;  // Get next node
-
-      // Get clean names for comparison (filenames without paths)
-      std::string nameCurrent = getCleanSongName(current->song);
-      std::string nameNext = getCleanSongName(nextNode->song);
-
-      // Convert to lowercase for case-insensitive comparison
-      std::string lowerCurrent, lowerNext;
-      std::transform(nameCurrent.begin(), nameCurrent.end(),
-                     std::back_inserter(lowerCurrent), ::tolower);
-      std::transform(nameNext.begin(), nameNext.end(),
-                     std::back_inserter(lowerNext), ::tolower);
-
-      // Compare lowercase strings lexicographically
-      if (lowerCurrent > lowerNext) {      // If current should come after next
-        swapNodesData(current, nextNode);  // Swap their data fields
-        swapped = true;  // Mark that a swap occurred in this pass
-      }
-      current = nextNode;  // Move to the next node for next comparison
+    nodes.push_back(current);
+    current = current->next;
+  } while (current != head);
+
+  // Look every key up once: the metadata pass may publish a track's tags
+  // (and so change its artist key) while the sort runs
+  const size_t width = keys.size();
+  std::vector<const std::string*> keyTable(nodes.size() * width);
+  std::vector<size_t> order(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (size_t k = 0; k < width; ++k) {
+      keyTable[i * width + k] = &collationKey(nodes[i], keys[k]);
+    }
+    order[i] = i;
+  }
+
+  // Stable merge sort so nodes with equal keys keep their relative order
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    for (size_t k = 0; k < width; ++k) {
+      int cmp = keyTable[a * width + k]->compare(*keyTable[b * width + k]);
+      if (cmp != 0) return cmp < 0;
     }
-    // After one full pass, the largest element is at the 'end' relative to the
-    // start
-  } while (swapped);  // Repeat passes until no swaps occur (sorted)
+    return false;
+  });
+  std::vector<node*> sorted(nodes.size());
+  for (size_t i = 0; i < order.size(); ++i) sorted[i] = nodes[order[i]];
+  nodes.swap(sorted);
+
+  // Relink nodes in sorted order, keeping the list circular
+  head = nodes.front();
+  for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+    nodes[i]->next = nodes[i + 1];
+    nodes[i + 1]->prev = nodes[i];
+  }
+  nodes.back()->next = head;
+  head->prev = nodes.back();
+  rebuildIndex();  // Positions changed; rebuild the treap in one pass
+  touch();
+}
+
+// Sorts the list by song title (case-insensitive)
+void LinkedList::sortBySong() {
+  sortBy({SortKey::SONG});
 }
 
-// Sorts the list by artist name (case-insensitive) using Bubble Sort
-// Maintains list structure while sorting just the data
+// Sorts the list by artist name (case-insensitive)
 void LinkedList::sortByArtist() {
-  if (head == nullptr || head->next == head)
-    return;  // Already sorted if 0 or 1 element
+  sortBy({SortKey::ARTIST});
+}
 
-  bool swapped;  // Flag to track if any swaps occurred in pass
-  do {
-    swapped = false;       // Reset swap flag for each pass
-    node* current = head;  // Start at head
-    for (int i = 0; i < len - 1; ++i) {
-      node* nextNode = current->next;  // Get next node
-
-      // Convert artist names to lowercase for comparison
-      std::string lowerCurrentArtist, lowerNextArtist;
-      std::transform(current->artist.begin(), current->artist.end(),
-                     std::back_inserter(lowerCurrentArtist),
-                     ::tolower);  // Current artist to lowercase
-      std::transform(nextNode->artist.begin(), nextNode->artist.end(),
-                     std::back_inserter(lowerNextArtist),
-                     ::tolower);  // Next artist to lowercase
-
-      // Compare lowercase strings
-      if (lowerCurrentArtist >
-          lowerNextArtist) {               // If current should come after next
-        swapNodesData(current, nextNode);  // Swap node data fields
-        swapped = true;                    // Mark swap occurred
-      }
-      current = nextNode;  // Move to next node
-    }
-  } while (swapped);  // Repeat if swaps occurred (until sorted)
+// Flushes 'tempName' to disk and renames it over 'filename', then syncs the
+// directory so the rename itself survives a crash
+// Returns true on success, false on failure (the temp file is removed)
+bool replaceFileDurably(const std::string& tempName,
+                        const std::string& filename) {
+  int fd = open(tempName.c_str(), O_RDONLY);
+  bool synced = fd >= 0 && fsync(fd) == 0;
+  if (fd >= 0) close(fd);
+  if (!synced || std::rename(tempName.c_str(), filename.c_str()) != 0) {
+    std::cerr << "\t\tError: Could not replace '" << filename
+              << "' with the newly written file." << std::endl;
+    std::remove(tempName.c_str());
+    return false;
+  }
+
+  std::string dir = fs::path(filename).parent_path().string();
+  int dirFd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dirFd >= 0) {
+    fsync(dirFd);  // Best effort: the data itself is already safe
+    close(dirFd);
+  }
+  return true;
 }
 
-// Saves the playlist data to a JSON file
+// Saves the playlist in the requested format (binary unless JSON is asked
+// for). The data goes to a temporary file that replaces 'filename' only
+// once it is complete and synced, so a crash mid-save keeps the old file
 // Returns true on success, false on failure
-bool LinkedList::saveToFile(const std::string& filename) const {
-  try {
-    json playlistJson;  // Create JSON object for the playlist
+bool LinkedList::saveToFile(const std::string& filename,
+                            PlaylistFormat format) const {
+  ScopedTimer timer(StatTimer::LIST_SAVE);
+  const std::string tempName = filename + ".tmp";
+  bool written = (format == PlaylistFormat::JSON) ? saveJson(tempName)
+                                                  : saveBinary(tempName);
+  if (!written) {
+    std::remove(tempName.c_str());  // Don't leave a partial file behind
+    return false;
+  }
+  return replaceFileDurably(tempName, filename);
+}
 
-    // Store list metadata
-    playlistJson["listName"] = listName;  // Save playlist name
-    playlistJson["length"] = len;         // Save number of songs
+// Loads a playlist file in either format, chosen by sniffing its first
+// bytes rather than trusting the extension
+// Returns true on success, false on failure
+bool LinkedList::loadFromFile(const std::string& filename) {
+  ScopedTimer timer(StatTimer::LIST_LOAD);
+  std::ifstream probe(filename, std::ios::binary);
+  if (!probe.is_open()) {
+    return false;  // Missing file: fail silently, as callers expect
+  }
+  char magic[4] = {0, 0, 0, 0};
+  probe.read(magic, sizeof(magic));
+  size_t got = static_cast<size_t>(probe.gcount());
+  probe.close();
 
-    // Create an array for songs
-    json songsArray = json::array();  // Create empty JSON array
+  return isBinaryPlaylist(magic, got) ? loadBinary(filename)
+                                      : loadJson(filename);
+}
 
-    // Add each song as a JSON object with song path and artist
-    if (head != nullptr) {
-      node* current = head;  // Start at head
-      do {
-        json songObj;                     // Create JSON object for current song
-        songObj["song"] = current->song;  // Add song path/name
-        songObj["artist"] = current->artist;  // Add artist name
-        songsArray.push_back(songObj);        // Add song object to array
-        current = current->next;              // Move to next song
-      } while (current != head);  // Continue until we loop back to head
+// Checks a playlist name read from disk; returns the name to use
+std::string LinkedList::sanitizeListName(const std::string& loadedName) {
+  // Validate the loaded string - check for null bytes or excessive length
+  if (loadedName.find('\0') != std::string::npos) {
+    std::cerr << "\t\tWarning: Playlist name contains null bytes, using "
+                 "default name."
+              << std::endl;
+    return "";
+  } else if (loadedName.length() > 100) {
+    std::cerr << "\t\tWarning: Playlist name too long, truncating."
+              << std::endl;
+    return loadedName.substr(0, 100);
+  }
+  return loadedName;
+}
+
+// --- Streaming JSON Loader ---
+// SAX handler that appends each song to the list as soon as its entry has
+// been parsed, so memory use grows with the list itself and never with a
+// whole-document JSON tree. Accepts the layout saveJson() writes:
+//   {"listName": "...", "length": N, "songs": [{"song": ..., "artist": ...}]}
+// Unknown keys are skipped; a malformed song entry is reported and skipped.
+class PlaylistSaxLoader : public json::json_sax_t {
+public:
+  PlaylistSaxLoader(LinkedList& target, const std::string& sourceName)
+      : list(target), filename(sourceName), depth(0), inSongs(false),
+        inEntry(false), hasLength(false), expectedLen(0), songOk(false),
+        artistOk(false) {}
+
+  // --- Scalar values ---
+  bool null() override { return value(); }
+  bool boolean(bool) override { return value(); }
+  bool number_integer(number_integer_t v) override {
+    return lengthValue(static_cast<long long>(v));
+  }
+  bool number_unsigned(number_unsigned_t v) override {
+    return lengthValue(static_cast<long long>(v));
+  }
+  bool number_float(number_float_t, const string_t&) override {
+    return value();
+  }
+  bool binary(binary_t&) override { return value(); }
+  bool string(string_t& s) override {
+    if (inEntry && depth == 3) {
+      if (currentKey == "song") {
+        song = std::move(s);
+        songOk = true;
+        return true;
+      }
+      if (currentKey == "artist") {
+        artist = std::move(s);
+        artistOk = true;
+        return true;
+      }
+    } else if (depth == 1 && currentKey == "listName") {
+      listName = std::move(s);
+      return true;
     }
+    return value();
+  }
 
-    // Add songs array to the main JSON object
-    playlistJson["songs"] = songsArray;  // Add songs array to playlist object
+  // --- Containers ---
+  bool start_object(std::size_t) override {
+    if (inSongs && depth == 2) {  // A new song entry
+      inEntry = true;
+      songOk = artistOk = false;
+      currentKey.clear();
+    } else {
+      value();
+    }
+    depth++;
+    return true;
+  }
+  bool end_object() override {
+    depth--;
+    if (inEntry && depth == 2) {  // Song entry complete
+      inEntry = false;
+      if (songOk && artistOk) {
+        list.add_end(song, artist);  // Add to end of playlist
+      } else {
+        warnSkipped();
+      }
+    }
+    return true;
+  }
+  bool start_array(std::size_t) override {
+    if (depth == 1 && currentKey == "songs") {
+      inSongs = true;
+    } else {
+      value();
+    }
+    depth++;
+    return true;
+  }
+  bool end_array() override {
+    depth--;
+    if (inSongs && depth == 1) inSongs = false;
+    return true;
+  }
+  bool key(string_t& k) override {
+    // Only keys of the top-level object and of song entries matter
+    if (depth == 1 || (inEntry && depth == 3)) currentKey = std::move(k);
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string&,
+                   const nlohmann::detail::exception& e) override {
+    std::cerr << "\t\tError: Failed to parse JSON from '" << filename
+              << "': " << e.what() << std::endl;
+    return false;  // Stop parsing
+  }
+
+  // The top-level "listName" string, or "" if there was none
+  const std::string& loadedName() const { return listName; }
+
+  // Warns if the file declared a length that does not match what loaded
+  void checkLength() const {
+    if (hasLength && list.len != expectedLen) {
+      std::cerr << "\t\tWarning: Expected " << expectedLen << " songs, loaded "
+                << list.len << " from '" << filename << "'." << std::endl;
+    }
+  }
+
+private:
+  // Any value not handled above: it can only invalidate a song entry
+  bool value() {
+    if (inEntry && depth == 3) {
+      if (currentKey == "song") songOk = false;
+      if (currentKey == "artist") artistOk = false;
+    } else if (inSongs && depth == 2) {
+      warnSkipped();  // Entry is not an object at all
+    } else if (depth == 1 && currentKey == "listName") {
+      listName.clear();  // Default to empty name if it is not a string
+    }
+    return true;
+  }
+  bool lengthValue(long long v) {
+    if (depth == 1 && currentKey == "length") {
+      hasLength = true;
+      expectedLen = static_cast<int>(v);
+      return true;
+    }
+    return value();
+  }
+  void warnSkipped() const {
+    std::cerr << "\t\tWarning: Skipping improperly formatted song entry in '"
+              << filename << "'." << std::endl;
+  }
+
+  LinkedList& list;
+  const std::string& filename;
+  int depth;               // Containers currently open
+  bool inSongs;            // Inside the top-level "songs" array
+  bool inEntry;            // Inside one song object of that array
+  bool hasLength;          // A top-level integer "length" was seen
+  int expectedLen;         // Its value
+  std::string listName;    // Top-level "listName", unsanitised
+  std::string currentKey;  // Last key at the top level or in an entry
+  std::string song;        // Fields of the current entry
+  std::string artist;
+  bool songOk;    // "song" seen and is a string
+  bool artistOk;  // "artist" seen and is a string
+};
+
+// Writes 's' to 'out' as a quoted, escaped JSON string
+static void writeJsonString(std::ostream& out, const std::string& s) {
+  out << json(s).dump();  // Throws json::type_error on invalid UTF-8
+}
 
+// Saves the playlist data to a JSON file
+// Entries are streamed straight to the file in the same layout (and the
+// same 4-space indentation) that dumping a full JSON tree would produce
+// Returns true on success, false on failure
+bool LinkedList::saveJson(const std::string& filename) const {
+  try {
     // Open file for writing
     std::ofstream file(filename);  // Create/open output file stream
     if (!file.is_open()) {
@@ -494,8 +978,29 @@ bool LinkedList::saveToFile(const std::string& filename) const {
       return false;  // Return failure if can't open file
     }
 
-    // Write pretty-printed JSON to file
-    file << playlistJson.dump(4);  // 4 spaces for indentation
+    // List metadata first (keys in the order a JSON object sorts them)
+    file << "{\n    \"length\": " << len << ",\n    \"listName\": ";
+    writeJsonString(file, listName);
+    file << ",\n    \"songs\": ";
+
+    // Then one object per song, with its path and artist
+    if (head == nullptr) {
+      file << "[]";
+    } else {
+      file << "[";
+      node* current = head;  // Start at head
+      do {
+        file << (current == head ? "\n" : ",\n");
+        file << "        {\n            \"artist\": ";
+        writeJsonString(file, current->track().artist);
+        file << ",\n            \"song\": ";
+        writeJsonString(file, current->track().path);
+        file << "\n        }";
+        current = current->next;  // Move to next song
+      } while (current != head);  // Continue until we loop back to head
+      file << "\n    ]";
+    }
+    file << "\n}";
 
     // Check for errors and close file
     bool success = file.good();  // Check if stream is in good state
@@ -519,8 +1024,10 @@ bool LinkedList::saveToFile(const std::string& filename) const {
 }
 
 // Loads playlist data from a JSON file
+// Songs are added while the file is parsed (see PlaylistSaxLoader); if the
+// file turns out to be malformed, whatever was loaded is discarded
 // Returns true on success, false on failure
-bool LinkedList::loadFromFile(const std::string& filename) {
+bool LinkedList::loadJson(const std::string& filename) {
   try {
     // Open file for reading
     std::ifstream file(filename);  // Open input file stream
@@ -530,80 +1037,16 @@ bool LinkedList::loadFromFile(const std::string& filename) {
       return false;  // Return failure if can't open file
     }
 
-    // Parse JSON from file
-    json playlistJson;  // Create JSON object to hold parsed data
-    try {
-      file >> playlistJson;  // Read JSON from file into object
-    } catch (const json::parse_error& e) {
-      std::cerr << "\t\tError: Failed to parse JSON from '" << filename
-                << "': " << e.what() << std::endl;
-      file.close();  // Close file
-      return false;  // Return failure on parse error
-    }
-
     // Clear existing list
     clear();  // Remove all existing nodes
 
-    // Read list name
-    if (playlistJson.contains("listName") &&
-        playlistJson["listName"].is_string()) {
-      std::string loadedName = playlistJson["listName"].get<std::string>();
-      // Validate the loaded string - check for null bytes or excessive length
-      if (loadedName.find('\0') != std::string::npos) {
-        std::cerr << "\t\tWarning: Playlist name contains null bytes, using "
-                     "default name."
-                  << std::endl;
-        listName = "";
-      } else if (loadedName.length() > 100) {
-        std::cerr << "\t\tWarning: Playlist name too long, truncating."
-                  << std::endl;
-        listName = loadedName.substr(0, 100);
-      } else {
-        listName = loadedName;
-      }
-    } else {
-      listName = "";  // Default to empty name if not in JSON
-    }
-
-    // Check for songs array
-    if (playlistJson.contains("songs") && playlistJson["songs"].is_array()) {
-      // Get the songs array
-      const json& songsArray =
-          playlistJson["songs"];  // Reference to the songs array
-
-      // Process each song in the array
-      for (const auto& songObj :
-           songsArray) {  // Iterate through each song object
-        if (songObj.contains("song") && songObj.contains("artist") &&
-            songObj["song"].is_string() && songObj["artist"].is_string()) {
-          std::string songPath =
-              songObj["song"].get<std::string>();  // Get song path
-          std::string artistName =
-              songObj["artist"].get<std::string>();  // Get artist name
-
-          // Add song to the list
-          add_end(songPath, artistName);  // Add to end of playlist
-        } else {
-          std::cerr
-              << "\t\tWarning: Skipping improperly formatted song entry in '"
-              << filename << "'." << std::endl;
-          // Continue loading other songs
-        }
-      }
-    }
-
-    // Additional check: Verify expected length if provided
-    if (playlistJson.contains("length") &&
-        playlistJson["length"].is_number_integer()) {
-      int expectedLen =
-          playlistJson["length"].get<int>();  // Get expected length
-      if (len != expectedLen) {
-        std::cerr << "\t\tWarning: Expected " << expectedLen
-                  << " songs, loaded " << len << " from '" << filename << "'."
-                  << std::endl;
-        // Continue despite mismatch
-      }
+    PlaylistSaxLoader loader(*this, filename);
+    if (!json::sax_parse(file, &loader)) {
+      clear();       // Parse error (already reported): drop partial data
+      return false;  // Return failure on parse error
     }
+    listName = sanitizeListName(loader.loadedName());
+    loader.checkLength();  // Verify expected length if provided
 
     file.close();  // Close the file
     taken = true;  // Mark list slot as taken/in-use
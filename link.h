@@ -3,33 +3,81 @@
 
 #include <algorithm>   // Needed for std::equal, std::swap, std::transform
 #include <cctype>      // Needed for ::tolower
+#include <cstdint>     // For uint32_t
 #include <filesystem>  // For directory operations
 #include <iostream>
-#include <regex>  // For regex operations
+#include <iterator>  // For std::back_inserter
+#include <memory>    // For std::unique_ptr
 #include <string>
 #include <vector>  // For storing file lists
 
+#include "catalog.h"  // Interned track data that nodes refer to by ID
+#include "pool.h"     // Slab allocator for list and stack nodes
+#include "view.h"     // Paged, cached drawing of display()
+
 // For convenience
 namespace fs = std::filesystem;
 
 // --- Node Structure ---
 struct node {
-  std::string song;    // Full path to the song file
-  std::string artist;  // Artist name
-  node* next;          // Pointer to the next node in the circular list
-
-  // Constructor for convenient node creation
+  uint32_t trackId;  // Catalog entry with the path, artist and sort keys
+  node* next;        // Pointer to the next node in the circular list
+  node* prev;        // Pointer to the previous node (head->prev is the tail)
+
+  // Position index: the same nodes also form an implicit treap ordered by
+  // list position, maintained by LinkedList. 'size' counts this subtree.
+  node* left;
+  node* right;
+  node* parent;  // nullptr at the root; lets positionOf() walk upwards
+  uint32_t priority;
+  int size;
+
+  // Constructor for convenient node creation; interns (s, a) in the catalog
   node(const std::string& s = "", const std::string& a = "", node* n = nullptr)
-      : song(s), artist(a), next(n) {}
+      : trackId(TrackCatalog::instance().intern(s, a)),
+        next(n),
+        prev(nullptr),
+        left(nullptr),
+        right(nullptr),
+        parent(nullptr),
+        priority(0),
+        size(1) {}
+
+  // The shared track data: path, artist, cleanName, songKey, artistKey
+  const Track& track() const { return TrackCatalog::instance().get(trackId); }
+};
+
+// --- Sort Keys ---
+// Fields a playlist can be ordered by; sortBy() accepts several in priority
+// order (e.g. artist, then song title).
+enum class SortKey {
+  SONG,   // Clean song title (case-insensitive)
+  ARTIST  // Artist name (case-insensitive)
+};
+
+class SearchIndex;  // Trigram index used by findMatches (search_index.h)
+
+// --- Playlist File Formats ---
+// saveToFile() writes either one; loadFromFile() detects which it is given.
+enum class PlaylistFormat {
+  BINARY,  // Compact string-table format (.mpl), memory-mapped on load
+  JSON     // Human-readable format, kept for import/export
 };
 
 // --- LinkedList Class ---
+// Circular doubly linked list: head->prev is the last node, so appending,
+// deleting at either end and walking backwards are all constant time.
+// A treap over the same nodes, keyed by position, makes nodeAt() and
+// positional insert/delete O(log n).
 class LinkedList {
 public:        // Data members kept public as per original design for simplicity
   node* head;  // Pointer to the first node (or nullptr if empty)
   std::string listName;  // Name of the playlist
   int len;               // Number of songs currently in the list
   bool taken;            // Flag indicating if this list slot is in use
+  // Rows printList() (main.cpp) has formatted for this list, so each
+  // playlist keeps its own when the user switches between them
+  RowCache printRows;
 
   // --- Constructor & Destructor ---
   LinkedList();   // Default constructor
@@ -46,26 +94,84 @@ public:        // Data members kept public as per original design for simplicity
 
   // --- Information & Utility Methods ---
   bool isEmpty() const;  // Checks if the list is empty
-  void display()
-      const;  // Displays the list content (const indicates no modification)
+  // Returns the node at 1-based 'pos', or nullptr if out of range, O(log n)
+  node* nodeAt(int pos) const;
+  // Returns the 1-based position of a node in this list, O(log n)
+  int positionOf(const node* n) const;
+  // Draws page 'page' (1-based, clamped) of the list: a screenful of
+  // numbered rows, each formatted once and cached until the list or its
+  // tracks change. Returns the page drawn.
+  ViewPage display(size_t page = 1) const;
+  // Sum of the track lengths the metadata pass has found, in milliseconds;
+  // 'unknown' (if given) receives the number of tracks still without one
+  long long totalDurationMs(int* unknown = nullptr) const;
   void search(
       const std::string& searchTerm) const;  // Searches for a song (const)
+  // Nodes whose title or shown artist contains 'searchTerm'
+  // (case-insensitive), in list order. Large lists answer from a trigram
+  // index built on first use and kept current by every add/delete and by
+  // tags as they arrive; small ones are scanned.
+  std::vector<node*> findMatches(const std::string& searchTerm) const;
 
   // --- Sorting Methods ---
+  // Stable O(n log n) sort on one or more keys, most significant first.
+  // Compares the lowercase keys cached on each node, then relinks the nodes
+  // in sorted order.
+  void sortBy(const std::vector<SortKey>& keys);
   void sortBySong();    // Sorts by song title (case-insensitive)
   void sortByArtist();  // Sorts by artist name (case-insensitive)
 
   // --- Persistence Methods ---
-  bool saveToFile(
-      const std::string& filename) const;          // Saves list to file (const)
-  bool loadFromFile(const std::string& filename);  // Loads list from file
+  bool saveToFile(const std::string& filename,
+                  PlaylistFormat format = PlaylistFormat::BINARY) const;
+  bool loadFromFile(const std::string& filename);  // Either format, detected
+
+  // Changes whenever songs are added, removed or reordered. Unique across
+  // lists, so a view cached for one list never matches another.
+  uint64_t revision() const { return changeStamp; }
 
 private:
+  // --- Format-specific persistence ---
+  bool saveJson(const std::string& filename) const;    // link.cpp
+  bool loadJson(const std::string& filename);          // link.cpp
+  bool saveBinary(const std::string& filename) const;  // binary_playlist.cpp
+  bool loadBinary(const std::string& filename);        // binary_playlist.cpp
+  // Applies the null-byte and length checks used for loaded list names
+  static std::string sanitizeListName(const std::string& loadedName);
+
   // Helper to swap data between two nodes (used by sorting)
   void swapNodesData(node* a, node* b);
+  // Links 'newNode' into the ring just before 'at' (which must be non-null)
+  void linkBefore(node* at, node* newNode);
+  // Unlinks 'target' from the ring and frees it (list must stay non-empty)
+  void unlinkNode(node* target);
+  // Allocates a node from the pool and registers it with the search index
+  node* createNode(const std::string& song, const std::string& artist);
+  // Unregisters a node from the search index and returns it to the pool
+  void destroyNode(node* target);
+
+  // --- Position Index (treap) ---
+  // Places 'newNode' at 1-based 'pos' in the index (ring is linked apart)
+  void indexInsert(int pos, node* newNode);
+  // Removes the node at 1-based 'pos' from the index and returns it
+  node* indexErase(int pos);
+  // Rebuilds the index from the ring order in O(n), used after sorting
+  void rebuildIndex();
+
+  Pool<node> nodePool;    // Owns every node in this list
+  node* root;             // Root of the position index (nullptr if empty)
+  uint32_t prioritySeed;  // xorshift state for treap priorities
+  uint64_t changeStamp;   // Behind revision(); 0 until the first change
+  void touch();           // Gives the list a new revision()
+
+  // Built lazily by findMatches() (hence mutable); nullptr until then
+  mutable std::unique_ptr<SearchIndex> searchIndex;
+  // Rows display() has formatted so far (filled while drawing, hence
+  // mutable)
+  mutable RowCache displayRows;
 };
 
-// --- Stack Node Structure (for reverse playback) ---
+// --- Stack Node Structure (LIFO of playlist node pointers) ---
 struct stackNode {
   node* item;       // Pointer to a node *within* a LinkedList
   stackNode* next;  // Pointer to the next node in the stack
@@ -88,11 +194,27 @@ public:
   void push(
       node* item);  // Adds an item (pointer to LinkedList node) to the top
   node* pop();  // Removes and returns the top item (pointer to LinkedList node)
+
+private:
+  Pool<stackNode> nodePool;  // Owns every stackNode in this stack
 };
 
+// "Total time: m:ss", noting how many tracks have no known length yet.
+// Walks the list, so views cache it (VIEW_SUMMARY_ROW).
+std::string totalTimeLine(const LinkedList& li);
+
+// Shows 'li' a page at a time with display() and reads a position in
+// 1..li.len after 'prompt'; N and P turn the page. Returns 0 if input ends.
+int choosePosition(const LinkedList& li, const std::string& prompt);
+
 // Forward declaration of function from main.cpp
 void ensureMusicDirectoryExists();
 
+// Syncs 'tempName' to disk and renames it over 'filename' (link.cpp).
+// Returns false on failure, after removing the temp file.
+bool replaceFileDurably(const std::string& tempName,
+                        const std::string& filename);
+
 // --- Utility Function Definitions (inline in header) ---
 
 // Helper for case-insensitive string comparison (Equality Check)
@@ -108,6 +230,32 @@ inline bool caseInsensitiveCompareEqual(const std::string& str1,
                     });
 }
 
+// Helper returning a lowercase copy of 'str' (ASCII, via std::tolower)
+inline std::string toLowerCopy(const std::string& str) {
+  std::string lower;
+  lower.reserve(str.size());
+  std::transform(str.begin(), str.end(), std::back_inserter(lower),
+                 [](unsigned char c) { return std::tolower(c); });
+  return lower;
+}
+
+// Length of a leading track number such as "01. " or " 7 " in 'name'
+// (whitespace, digits, an optional '.', whitespace), or 0 if there is none.
+// Matches the regex ^\s*\d+\.?\s* without building a std::regex per call.
+inline size_t numericPrefixLength(const std::string& name) {
+  size_t i = 0;
+  while (i < name.size() && std::isspace(static_cast<unsigned char>(name[i])))
+    ++i;
+  size_t digitsStart = i;
+  while (i < name.size() && std::isdigit(static_cast<unsigned char>(name[i])))
+    ++i;
+  if (i == digitsStart) return 0;  // No digits: not a numeric prefix
+  if (i < name.size() && name[i] == '.') ++i;
+  while (i < name.size() && std::isspace(static_cast<unsigned char>(name[i])))
+    ++i;
+  return i;
+}
+
 // Helper to get clean song name (remove path and extension)
 inline std::string getCleanSongName(const std::string& fullPath) {
   if (fullPath.empty()) {
@@ -136,14 +284,32 @@ inline std::string getCleanSongName(const std::string& fullPath) {
     return fullPath;  // Avoid returning empty string for these
 
   // Remove numeric prefixes like "01. ", "1. ", etc.
-  std::regex numericPrefix("^\\s*\\d+\\.?\\s*");
-  temp = std::regex_replace(temp, numericPrefix, "");
+  temp.erase(0, numericPrefixLength(temp));
 
   return temp.empty()
              ? "[Unnamed]"
              : temp;  // Return "[Unnamed]" if cleaning results in empty string
 }
 
+// Sorts (path, name) pairs by name, case-insensitively. Each name is
+// lowercased once rather than on every comparison.
+inline void sortEntriesByName(
+    std::vector<std::pair<std::string, std::string>>& entries) {
+  std::vector<std::pair<std::string, size_t>> keyed;
+  keyed.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    keyed.emplace_back(toLowerCopy(entries[i].second), i);
+  }
+  std::sort(keyed.begin(), keyed.end());
+
+  std::vector<std::pair<std::string, std::string>> sorted;
+  sorted.reserve(entries.size());
+  for (const auto& key : keyed) {
+    sorted.push_back(std::move(entries[key.second]));
+  }
+  entries.swap(sorted);
+}
+
 // Helper to get all supported audio files from the music directory and its
 // subdirectories Returns a vector of pairs containing:
 // - first: full path to the audio file
@@ -177,9 +343,7 @@ inline std::vector<std::pair<std::string, std::string>> getMusicFiles(
         std::string extension = entry.path().extension().string();
 
         // Convert extension to lowercase for case-insensitive comparison
-        std::string lowerExt = extension;
-        std::transform(lowerExt.begin(), lowerExt.end(), lowerExt.begin(),
-                       [](unsigned char c) { return std::tolower(c); });
+        std::string lowerExt = toLowerCopy(extension);
 
         // Check if it's a supported audio file
         if (lowerExt == ".mp3" || lowerExt == ".wav" || lowerExt == ".flac" ||
@@ -191,15 +355,7 @@ inline std::vector<std::pair<std::string, std::string>> getMusicFiles(
     }
 
     // Sort the result by clean song name (case insensitive)
-    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-      std::string lowerA = a.second;
-      std::transform(lowerA.begin(), lowerA.end(), lowerA.begin(), ::tolower);
-
-      std::string lowerB = b.second;
-      std::transform(lowerB.begin(), lowerB.end(), lowerB.begin(), ::tolower);
-
-      return lowerA < lowerB;
-    });
+    sortEntriesByName(result);
   } catch (const fs::filesystem_error& e) {
     std::cerr << "\t\tError accessing directory: " << e.what() << std::endl;
   }
@@ -243,15 +399,7 @@ inline std::vector<std::pair<std::string, std::string>> getSubdirectories(
     }
 
     // Sort the result by directory name (case insensitive)
-    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-      std::string lowerA = a.second;
-      std::transform(lowerA.begin(), lowerA.end(), lowerA.begin(), ::tolower);
-
-      std::string lowerB = b.second;
-      std::transform(lowerB.begin(), lowerB.end(), lowerB.begin(), ::tolower);
-
-      return lowerA < lowerB;
-    });
+    sortEntriesByName(result);
   } catch (const fs::filesystem_error& e) {
     std::cerr << "\t\tError accessing directory: " << e.what() << std::endl;
   }
@@ -1,20 +1,34 @@
+#include <poll.h>    // Browser waits on stdin and library changes
+#include <unistd.h>  // For read(), STDIN_FILENO
+
 #include <algorithm>   // For std::transform
 #include <cctype>      // For toupper, tolower
-#include <cstdlib>     // For system() for clear screen
 #include <filesystem>  // For directory searching (requires C++17)
+#include <functional>  // For std::function (per-slot file tasks)
 #include <iomanip>     // For setw
 #include <limits>      // For numeric_limits
+#include <map>         // For ordering imported playlist files
+#include <sstream>     // For parsing selections and formatting cached rows
 #include <vector>      // For storing playlists vector and active indices
 
 #include "audio.h"  // Includes link.h again (harmless), declares playback functions
+#include "batch.h"  // Command-line options and the headless --batch mode
+#include "library.h"  // Cached, recursively scanned music directory listings
 #include "link.h"  // Includes string, iostream, utilities, iomanip etc.
+#include "metadata.h"  // Tags and lengths read in the background
+#include "registry.h"    // Named playlists, manifest and lazy loading
+#include "stats.h"       // Stage timers behind the stats screen
+#include "threadpool.h"  // Saves and loads playlist slots concurrently
+#include "view.h"        // Paged listings and the ANSI screen clear
 
 // Use std namespace to reduce typing, or qualify everything with std::
 using namespace std;
 namespace fs = std::filesystem;  // Alias for convenience
 
 // Forward declarations
-void printList(LinkedList& li);
+// Shows 'li' a page at a time. With several pages it reads N / P until
+// Enter, and returns true; with one it returns false at once.
+bool printList(LinkedList& li);
 
 // --- Enums for Menu Options ---
 enum class MainMenuOption {
@@ -22,7 +36,8 @@ enum class MainMenuOption {
   MANAGE_LISTS = 2,
   SAVE_LISTS = 3,
   LOAD_LISTS = 4,
-  EXIT = 5
+  SHOW_STATS = 5,
+  EXIT = 6
 };
 
 enum class ManageMenuOption {
@@ -44,33 +59,43 @@ enum class ManageMenuOption {
   PLAY_SEQUENTIAL = 11,
   PLAY_REPEAT = 12,
   PLAY_REVERSE = 13,
+  PLAY_SHUFFLE = 14,
 
   // Organization Section
-  SEARCH = 14,
-  SORT = 15,
+  SEARCH = 15,
+  SORT = 16,
 
   // Navigation
-  BACK = 16
+  BACK = 17
 };
 
-enum class SortOption { BY_SONG = 1, BY_ARTIST = 2 };
+enum class SortOption {
+  BY_SONG = 1,
+  BY_ARTIST = 2,
+  BY_ARTIST_THEN_SONG = 3
+};
 
 // --- Global Variables ---
-bool shouldExitProgram = false;        // Controls the main application loop
-std::vector<LinkedList> playlists(3);  // Holds up to 3 playlist objects
+bool shouldExitProgram = false;  // Controls the main application loop
+PlaylistRegistry registry;       // Every playlist, loaded on first use
+
+// Playlists named on the main menu before it summarises the rest
+#define PLAYLIST_STATUS_MAX 5
+// Playlists numbered in the manage picker; beyond that, pick by name
+#define PLAYLIST_PICKER_MAX 20
+// Upper bound on threads used to save or import playlist files
+#define PLAYLIST_IO_THREADS_MAX 8
+// Lines around a printList() page: menu header, box, totals and prompt
+#define PRINT_LIST_RESERVED_ROWS 21
+// Lines around a browser page: menu header, navigation and section boxes,
+// page line and prompt
+#define BROWSER_RESERVED_ROWS 27
 
 // --- Menu UI Class ---
 class MenuUI {
 private:
-  // Clears the console screen (platform-dependent)
-  static void clearScreen() {
-#ifdef _WIN32
-    system("cls");
-#else
-    // Assume POSIX-compatible system (Linux, macOS)
-    system("clear");
-#endif
-  }
+  // Clears the console screen with ANSI sequences (no shell is forked)
+  static void clearScreen() { clearTerminal(); }
 
   // Draws a horizontal line using a specified symbol
   static void drawLine(int length = 60, const string& symbol = "━") {
@@ -275,48 +300,11 @@ string findFileCaseInsensitive(const string& dirPath, const string& baseName) {
     }
   }
 
-  // Prepare lowercase version of the name we're searching for
-  string lowerBaseName;
-  lowerBaseName.reserve(baseName.size());
-  transform(baseName.begin(), baseName.end(), back_inserter(lowerBaseName),
-            [](unsigned char c) { return std::tolower(c); });
-
-  vector<fs::path> matches;  // Store paths of files that match
-
-  try {
-    // Iterate through the specified directory
-    for (const auto& entry : fs::directory_iterator(dirPath)) {
-      // Consider only regular files
-      if (entry.is_regular_file()) {
-        fs::path currentPath = entry.path();
-        string currentStem =
-            currentPath.stem().string();  // Filename without extension
-        string currentExt = currentPath.extension().string();  // File extension
-
-        // Check if it's a common audio extension (case-insensitive check)
-        string lowerExt;
-        transform(currentExt.begin(), currentExt.end(), back_inserter(lowerExt),
-                  ::tolower);
-        if (lowerExt == ".mp3" || lowerExt == ".wav" || lowerExt == ".flac" ||
-            lowerExt == ".ogg") {
-          // Prepare lowercase version of the current file's stem
-          string lowerCurrentStem;
-          lowerCurrentStem.reserve(currentStem.size());
-          transform(currentStem.begin(), currentStem.end(),
-                    back_inserter(lowerCurrentStem),
-                    [](unsigned char c) { return std::tolower(c); });
-
-          // Compare lowercase stem with lowercase search name
-          if (lowerCurrentStem == lowerBaseName) {
-            matches.push_back(currentPath);  // Add to list of matches
-          }
-        }
-      }
-    }
-  } catch (const fs::filesystem_error& e) {
-    // Handle potential errors during directory iteration (e.g., permissions)
-    MenuUI::displayError("Filesystem error accessing '" + dirPath +
-                         "': " + e.what());
+  // Look the stem up in the library's per-directory hash (re-listed only
+  // when the directory's mtime changes)
+  vector<string> matches;  // Paths of files that match
+  if (!MusicLibrary::instance().filesWithStem(dirPath, baseName, matches)) {
+    MenuUI::displayError("Filesystem error accessing '" + dirPath + "'.");
     return "";
   }
 
@@ -324,8 +312,7 @@ string findFileCaseInsensitive(const string& dirPath, const string& baseName) {
   if (matches.empty()) {
     return "";  // No match found
   } else if (matches.size() == 1) {
-    return matches[0]
-        .string();  // Exactly one match, return its full path string
+    return matches[0];  // Exactly one match, return its full path string
   } else {
     // Multiple files matched case-insensitively
     MenuUI::displayError("Ambiguous song title! Multiple files match '" +
@@ -333,7 +320,7 @@ string findFileCaseInsensitive(const string& dirPath, const string& baseName) {
     // List the conflicting filenames
     for (size_t i = 0; i < matches.size(); ++i) {
       cout << MenuUI::DOUBLE_TAB << (i + 1) << ". "
-           << matches[i].filename().string() << endl;
+           << fs::path(matches[i]).filename().string() << endl;
     }
     MenuUI::displayError(
         "Please ensure unique filenames (ignoring case and extension) in the "
@@ -343,6 +330,144 @@ string findFileCaseInsensitive(const string& dirPath, const string& baseName) {
   }
 }
 
+// Directory listing as shown by the browser: (full path, display name)
+using BrowserListing = vector<pair<string, string>>;
+
+// Blocks until a choice can be read from stdin. Returns false instead if
+// the library watcher changes the listing of 'dir' first, so the browser
+// can redraw it; 'subdirs' and 'files' are what is on screen.
+static bool waitForBrowserInput(const string& dir,
+                                const BrowserListing& subdirs,
+                                const BrowserListing& files) {
+  MusicLibrary& library = MusicLibrary::instance();
+  int changeFd = library.changeFd();
+  if (changeFd < 0) return true;  // Not watching: just read
+
+  uint64_t seen = library.changeCount();
+  struct pollfd fds[2];
+  fds[0] = {STDIN_FILENO, POLLIN, 0};
+  fds[1] = {changeFd, POLLIN, 0};
+  while (true) {
+    if (poll(fds, 2, -1) < 0) continue;  // EINTR
+    if (fds[0].revents != 0) return true;  // Input, or end of input
+    uint64_t wakeups;
+    if (read(changeFd, &wakeups, sizeof(wakeups)) < 0) {
+      // Another reader reset it; changeCount() still tells
+    }
+    if (library.changeCount() == seen) continue;
+    seen = library.changeCount();
+    // Other directories changing must not disturb what is being typed
+    if (library.subdirectories(dir) != subdirs ||
+        library.musicFiles(dir) != files) {
+      return false;
+    }
+  }
+}
+
+// One directory as the browser shows it. The listing is fetched from the
+// library only when the directory or the library changes, and each row is
+// formatted once per fetch, so a redraw costs one page of output however
+// many files the directory holds.
+class BrowserView {
+public:
+  string path;  // Directory held; empty before the first fetch
+  uint64_t libraryChanges = 0;  // MusicLibrary::changeCount() at the fetch
+  uint64_t fetches = 0;         // Stamp for 'rows'
+  BrowserListing subdirs;
+  BrowserListing files;
+  RowCache rows;
+  size_t pageNumber = 1;
+  ViewPage page{0, 0, 1, 1};  // Last page drawn
+
+  // Fetches the listing of 'dir' unless it is the one held and the watcher
+  // has reported nothing since. Without a watcher the library's own mtime
+  // check decides.
+  void refresh(const string& dir) {
+    MusicLibrary& library = MusicLibrary::instance();
+    if (dir == path && library.changeFd() >= 0 &&
+        library.changeCount() == libraryChanges) {
+      return;
+    }
+    libraryChanges = library.changeCount();  // Before: later changes count
+    BrowserListing newSubdirs = library.subdirectories(dir);
+    BrowserListing newFiles = library.musicFiles(dir);
+    if (dir != path) {
+      pageNumber = 1;  // A new directory opens at its first page
+    } else if (newSubdirs == subdirs && newFiles == files) {
+      return;  // Another directory changed; these rows are still right
+    }
+    path = dir;
+    subdirs.swap(newSubdirs);
+    files.swap(newFiles);
+    ++fetches;
+  }
+
+  // Draws the current page: directories (D#) first, then files (F#)
+  void draw() {
+    rows.sync(fetches, 0);
+    const size_t total = subdirs.size() + files.size();
+    page = viewPage(pageNumber, total, pageRows(BROWSER_RESERVED_ROWS));
+    pageNumber = page.number;
+    const size_t end = page.first + page.count;
+
+    const size_t dirEnd = std::min(end, subdirs.size());
+    if (page.first < dirEnd) {
+      std::cout << MenuUI::DOUBLE_TAB
+                << "┌─ DIRECTORIES ────────────────────────────────┐"
+                << std::endl;
+      for (size_t i = page.first; i < dirEnd; ++i) {
+        std::cout << row(i, 'D', i + 1, subdirs[i].second) << '\n';
+      }
+      std::cout << MenuUI::DOUBLE_TAB
+                << "└──────────────────────────────────────────────┘"
+                << std::endl;
+      std::cout << std::endl;
+    }
+
+    const size_t fileBegin = std::max(page.first, subdirs.size());
+    if (fileBegin < end) {
+      std::cout << MenuUI::DOUBLE_TAB
+                << "┌─ AUDIO FILES ────────────────────────────────┐"
+                << std::endl;
+      for (size_t i = fileBegin; i < end; ++i) {
+        size_t fileIndex = i - subdirs.size();
+        std::cout << row(i, 'F', fileIndex + 1, files[fileIndex].second)
+                  << '\n';
+      }
+      std::cout << MenuUI::DOUBLE_TAB
+                << "└──────────────────────────────────────────────┘"
+                << std::endl;
+    } else if (total == 0) {
+      std::cout << MenuUI::DOUBLE_TAB << "📂 This directory is empty."
+                << std::endl;
+    }
+
+    if (page.pages > 1) {
+      std::cout << MenuUI::DOUBLE_TAB << "Page " << page.number << " of "
+                << page.pages << std::endl;
+    }
+  }
+
+private:
+  // Row 'index' of the combined listing, e.g. "│ F12. Song name   │"
+  const std::string& row(size_t index, char kind, size_t number,
+                         const std::string& name) {
+    const std::string* cached = rows.find(index);
+    if (cached != nullptr) return *cached;
+
+    // Format for display: limit length and add ellipsis if too long
+    const size_t maxDisplayLength = 45;
+    std::string displayName = name;
+    if (displayName.length() > maxDisplayLength) {
+      displayName = displayName.substr(0, maxDisplayLength - 3) + "...";
+    }
+    std::ostringstream text;
+    text << MenuUI::DOUBLE_TAB << "│ " << kind << std::left << std::setw(2)
+         << number << ". " << std::setw(45) << displayName << " │";
+    return rows.store(index, text.str());
+  }
+};
+
 // --- Handler Functions for Menu Actions ---
 
 // Modified handler for adding songs with file browser
@@ -350,11 +475,13 @@ void handleAddSong(LinkedList& li, bool addToBeginning) {
   std::string currentPath = "music";
   std::vector<std::string> breadcrumbs = {"music"};
   bool exitBrowser = false;
+  BrowserView view;
 
   while (!exitBrowser) {
-    // Get subdirectories and music files from current directory
-    auto subdirectories = getSubdirectories(currentPath);
-    auto musicFiles = getMusicFiles(currentPath);
+    // Subdirectories and music files, fetched again only after a change
+    view.refresh(currentPath);
+    const BrowserListing& subdirectories = view.subdirs;
+    const BrowserListing& musicFiles = view.files;
 
     // Display header with breadcrumb trail
     std::string breadcrumbTrail = "";
@@ -396,58 +523,8 @@ void handleAddSong(LinkedList& li, bool addToBeginning) {
               << std::endl;
     std::cout << std::endl;
 
-    // Display directories if available
-    if (!subdirectories.empty()) {
-      std::cout << MenuUI::DOUBLE_TAB
-                << "┌─ DIRECTORIES ────────────────────────────────┐"
-                << std::endl;
-      int dirIndex = 1;
-      for (const auto& dir : subdirectories) {
-        std::string displayName = dir.second;
-
-        // Format for display: limit length and add ellipsis if too long
-        const int maxDisplayLength = 45;
-        if (displayName.length() > maxDisplayLength) {
-          displayName = displayName.substr(0, maxDisplayLength - 3) + "...";
-        }
-
-        std::cout << MenuUI::DOUBLE_TAB << "│ D" << std::left << std::setw(2)
-                  << dirIndex++ << ". " << std::setw(45) << displayName << " │"
-                  << std::endl;
-      }
-      std::cout << MenuUI::DOUBLE_TAB
-                << "└──────────────────────────────────────────────┘"
-                << std::endl;
-      std::cout << std::endl;
-    }
-
-    // Display audio files if available
-    if (!musicFiles.empty()) {
-      std::cout << MenuUI::DOUBLE_TAB
-                << "┌─ AUDIO FILES ────────────────────────────────┐"
-                << std::endl;
-      int fileIndex = 1;
-      for (const auto& file : musicFiles) {
-        // Get the clean name
-        std::string displayName = file.second;
-
-        // Format for display: limit length and add ellipsis if too long
-        const int maxDisplayLength = 45;
-        if (displayName.length() > maxDisplayLength) {
-          displayName = displayName.substr(0, maxDisplayLength - 3) + "...";
-        }
-
-        std::cout << MenuUI::DOUBLE_TAB << "│ F" << std::left << std::setw(2)
-                  << fileIndex++ << ". " << std::setw(45) << displayName << " │"
-                  << std::endl;
-      }
-      std::cout << MenuUI::DOUBLE_TAB
-                << "└──────────────────────────────────────────────┘"
-                << std::endl;
-    } else if (subdirectories.empty() && musicFiles.empty()) {
-      std::cout << MenuUI::DOUBLE_TAB << "📂 This directory is empty."
-                << std::endl;
-    }
+    // One page of directories and files, from rows formatted per listing
+    view.draw();
 
     std::cout << std::endl;
 
@@ -459,14 +536,21 @@ void handleAddSong(LinkedList& li, bool addToBeginning) {
       std::cout << ", A to add all, S to select multiple";
     if (!subdirectories.empty()) std::cout << ", D# for directory";
     if (!musicFiles.empty()) std::cout << ", F# for file";
-    std::cout << "): ";
+    if (view.page.pages > 1) std::cout << ", N/P for more";
+    std::cout << "): " << std::flush;
 
+    // Files added or removed meanwhile are shown at once
+    if (!waitForBrowserInput(currentPath, subdirectories, musicFiles)) {
+      continue;
+    }
     std::cin >> choice;
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(),
                     '\n');  // Clear input buffer
 
     // Process choice
-    if (choice == "0") {
+    if (turnPage(choice, view.page, view.pageNumber)) {
+      continue;  // Redrawn from the cached rows
+    } else if (choice == "0") {
       MenuUI::displayInfo("Song addition canceled.");
       return;
     } else if (choice == "B" || choice == "b") {
@@ -479,7 +563,8 @@ void handleAddSong(LinkedList& li, bool addToBeginning) {
       std::string artistName;
       std::cout
           << MenuUI::DOUBLE_TAB
-          << "Enter artist name for all songs (leave empty for '[Unknown]'): ";
+          << "Enter artist name for all songs (leave empty to use their "
+             "tags): ";
       getline(std::cin, artistName);
 
       if (artistName.empty()) {
@@ -541,8 +626,8 @@ void handleAddSong(LinkedList& li, bool addToBeginning) {
       // Get artist name
       std::string artistName;
       std::cout << MenuUI::DOUBLE_TAB
-                << "Enter artist name for selected songs (leave empty for "
-                   "'[Unknown]'): ";
+                << "Enter artist name for selected songs (leave empty to use "
+                   "their tags): ";
       getline(std::cin, artistName);
 
       if (artistName.empty()) {
@@ -594,7 +679,8 @@ void handleAddSong(LinkedList& li, bool addToBeginning) {
         getline(std::cin, artistName);
 
         if (artistName.empty()) {
-          MenuUI::displayInfo("Artist name left empty, using '[Unknown]'.");
+          MenuUI::displayInfo(
+              "Artist name left empty; the file's tags will name it.");
           artistName = "[Unknown]";
         }
 
@@ -643,8 +729,9 @@ void handleSort(LinkedList& li) {
        << (li.listName.empty() ? "[Unnamed]" : li.listName) << "' by:" << endl;
   cout << MenuUI::DOUBLE_TAB << "1. Song Title" << endl;
   cout << MenuUI::DOUBLE_TAB << "2. Artist Name" << endl;
+  cout << MenuUI::DOUBLE_TAB << "3. Artist Name, then Song Title" << endl;
 
-  int choiceVal = MenuUI::getValidatedInput(1, 2);
+  int choiceVal = MenuUI::getValidatedInput(1, 3);
   SortOption choice = static_cast<SortOption>(choiceVal);
 
   switch (choice) {
@@ -656,6 +743,10 @@ void handleSort(LinkedList& li) {
       li.sortByArtist();
       MenuUI::displaySuccess("List sorted by Artist Name.");
       break;
+    case SortOption::BY_ARTIST_THEN_SONG:
+      li.sortBy({SortKey::ARTIST, SortKey::SONG});
+      MenuUI::displaySuccess("List sorted by Artist Name, then Song Title.");
+      break;
   }
 }
 
@@ -671,11 +762,13 @@ void handleAddMiddle(LinkedList& li) {
   std::string currentPath = "music";
   std::vector<std::string> breadcrumbs = {"music"};
   bool exitBrowser = false;
+  BrowserView view;
 
   while (!exitBrowser) {
-    // Get subdirectories and music files from current directory
-    auto subdirectories = getSubdirectories(currentPath);
-    auto musicFiles = getMusicFiles(currentPath);
+    // Subdirectories and music files, fetched again only after a change
+    view.refresh(currentPath);
+    const BrowserListing& subdirectories = view.subdirs;
+    const BrowserListing& musicFiles = view.files;
 
     // Display header with breadcrumb trail
     std::string breadcrumbTrail = "";
@@ -707,58 +800,8 @@ void handleAddMiddle(LinkedList& li) {
               << std::endl;
     std::cout << std::endl;
 
-    // Display directories if available
-    if (!subdirectories.empty()) {
-      std::cout << MenuUI::DOUBLE_TAB
-                << "┌─ DIRECTORIES ────────────────────────────────┐"
-                << std::endl;
-      int dirIndex = 1;
-      for (const auto& dir : subdirectories) {
-        std::string displayName = dir.second;
-
-        // Format for display: limit length and add ellipsis if too long
-        const int maxDisplayLength = 45;
-        if (displayName.length() > maxDisplayLength) {
-          displayName = displayName.substr(0, maxDisplayLength - 3) + "...";
-        }
-
-        std::cout << MenuUI::DOUBLE_TAB << "│ D" << std::left << std::setw(2)
-                  << dirIndex++ << ". " << std::setw(45) << displayName << " │"
-                  << std::endl;
-      }
-      std::cout << MenuUI::DOUBLE_TAB
-                << "└──────────────────────────────────────────────┘"
-                << std::endl;
-      std::cout << std::endl;
-    }
-
-    // Display audio files if available
-    if (!musicFiles.empty()) {
-      std::cout << MenuUI::DOUBLE_TAB
-                << "┌─ AUDIO FILES ────────────────────────────────┐"
-                << std::endl;
-      int fileIndex = 1;
-      for (const auto& file : musicFiles) {
-        // Get the clean name
-        std::string displayName = file.second;
-
-        // Format for display: limit length and add ellipsis if too long
-        const int maxDisplayLength = 45;
-        if (displayName.length() > maxDisplayLength) {
-          displayName = displayName.substr(0, maxDisplayLength - 3) + "...";
-        }
-
-        std::cout << MenuUI::DOUBLE_TAB << "│ F" << std::left << std::setw(2)
-                  << fileIndex++ << ". " << std::setw(45) << displayName << " │"
-                  << std::endl;
-      }
-      std::cout << MenuUI::DOUBLE_TAB
-                << "└──────────────────────────────────────────────┘"
-                << std::endl;
-    } else if (subdirectories.empty() && musicFiles.empty()) {
-      std::cout << MenuUI::DOUBLE_TAB << "📂 This directory is empty."
-                << std::endl;
-    }
+    // One page of directories and files, from rows formatted per listing
+    view.draw();
 
     std::cout << std::endl;
 
@@ -768,14 +811,21 @@ void handleAddMiddle(LinkedList& li) {
     if (breadcrumbs.size() > 1) std::cout << ", B to go back";
     if (!subdirectories.empty()) std::cout << ", D# for directory";
     if (!musicFiles.empty()) std::cout << ", F# for file";
-    std::cout << "): ";
+    if (view.page.pages > 1) std::cout << ", N/P for more";
+    std::cout << "): " << std::flush;
 
+    // Files added or removed meanwhile are shown at once
+    if (!waitForBrowserInput(currentPath, subdirectories, musicFiles)) {
+      continue;
+    }
     std::cin >> choice;
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(),
                     '\n');  // Clear input buffer
 
     // Process choice
-    if (choice == "0") {
+    if (turnPage(choice, view.page, view.pageNumber)) {
+      continue;  // Redrawn from the cached rows
+    } else if (choice == "0") {
       MenuUI::displayInfo("Song addition canceled.");
       return;
     } else if (choice == "B" || choice == "b") {
@@ -812,7 +862,8 @@ void handleAddMiddle(LinkedList& li) {
         getline(std::cin, artistName);
 
         if (artistName.empty()) {
-          MenuUI::displayInfo("Artist name left empty, using '[Unknown]'.");
+          MenuUI::displayInfo(
+              "Artist name left empty; the file's tags will name it.");
           artistName = "[Unknown]";
         }
 
@@ -840,11 +891,10 @@ void handleDeleteMiddle(LinkedList& li) {
     return;
   }
   cout << MenuUI::DOUBLE_TAB << "Current list contents:" << endl;
-  li.display();
-  int position = MenuUI::getValidatedInput<int>(
-      MenuUI::DOUBLE_TAB + "Enter position of song to delete (1-" +
-          to_string(li.len) + "): ",
-      1, li.len);
+  int position = choosePosition(
+      li, MenuUI::DOUBLE_TAB + "Enter position of song to delete (1-" +
+              to_string(li.len) + ", N/P for more): ");
+  if (position == 0) return;  // Input ended
   li.del_at(position);
   MenuUI::displaySuccess("Song deleted successfully from position " +
                          to_string(position) + ".");
@@ -858,7 +908,7 @@ void handleSearch(LinkedList& li) {
   }
   string searchTerm;
   cout << MenuUI::DOUBLE_TAB
-       << "Enter song title (or part of it) to search for: ";
+       << "Enter song title or artist (or part of it) to search for: ";
   getline(cin >> ws, searchTerm);
   if (searchTerm.empty()) {
     MenuUI::displayError("Search term cannot be empty.");
@@ -867,8 +917,8 @@ void handleSearch(LinkedList& li) {
   li.search(searchTerm);
 }
 
-// Handles renaming the list 'li'
-void handleRename(LinkedList& li) {
+// Handles renaming the list 'li' (registry entry 'listIndex')
+void handleRename(LinkedList& li, int listIndex) {
   string newName;
   cout << MenuUI::DOUBLE_TAB << "Current list name: "
        << (li.listName.empty() ? "[Unnamed]" : li.listName) << endl;
@@ -883,12 +933,16 @@ void handleRename(LinkedList& li) {
         "List name contains invalid characters (e.g., \\ / : * ? \" < > | ).");
     return;
   }
-  li.listName = newName;
+  if (!registry.rename(listIndex, newName)) {  // Also updates li.listName
+    MenuUI::displayError("A playlist named '" + newName + "' already exists.");
+    return;
+  }
   MenuUI::displaySuccess("List renamed successfully to '" + li.listName + "'.");
 }
 
-// Handles deleting the entire list object's content and freeing the slot
-void handleDeleteList(LinkedList& li, int listIndex) {
+// Handles deleting the entire list and its registry entry
+// Returns true if it was deleted, in which case 'li' no longer exists
+bool handleDeleteList(LinkedList& li, int listIndex) {
   string currentName = li.listName.empty()
                            ? ("[Unnamed List " + to_string(listIndex + 1) + "]")
                            : li.listName;
@@ -896,38 +950,25 @@ void handleDeleteList(LinkedList& li, int listIndex) {
   cout << MenuUI::DOUBLE_TAB
        << "⚠️ WARNING: This will permanently delete all songs" << endl;
   cout << MenuUI::DOUBLE_TAB << "   in the list '" << currentName
-       << "' and free up slot " << (listIndex + 1) << "." << endl;
+       << "' and remove it from the library." << endl;
   cout << MenuUI::DOUBLE_TAB << "   Are you sure you want to proceed? (Y/N): ";
   cin >> confirm;
   cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
   if (toupper(static_cast<unsigned char>(confirm)) == 'Y') {
-    li.clear();
-    li.listName = "";
-    li.taken = false;
-    MenuUI::displaySuccess("List '" + currentName +
-                           "' deleted successfully. Slot " +
-                           to_string(listIndex + 1) + " is now available.");
-  } else {
-    MenuUI::displayInfo("List deletion cancelled.");
+    registry.remove(listIndex);  // Destroys 'li'
+    MenuUI::displaySuccess("List '" + currentName + "' deleted successfully.");
+    MenuUI::displayInfo("Its file is removed the next time you save.");
+    return true;
   }
+  MenuUI::displayInfo("List deletion cancelled.");
+  return false;
 }
 
 // --- Main Menu Flow Functions ---
 
-// Creates a new list in the passed (available) LinkedList object 'li'
+// Fills the newly created (empty) LinkedList object 'li' with songs
 void createListObject(LinkedList& li) {
-  cout << MenuUI::DOUBLE_TAB << "Enter name for the new playlist: ";
-  getline(cin >> ws, li.listName);
-  if (li.listName.empty()) {
-    li.listName = "[Unnamed]";
-    MenuUI::displayInfo("List name set to '[Unnamed]'.");
-  } else if (!isValidNamePart(li.listName)) {
-    MenuUI::displayError(
-        "List name contains invalid characters. Using '[Unnamed]'.");
-    li.listName = "[Unnamed]";
-  }
-
   int num_songs = MenuUI::getValidatedInput<int>(
       MenuUI::DOUBLE_TAB + "How many songs to add initially (0-50)? ", 0, 50);
 
@@ -938,7 +979,6 @@ void createListObject(LinkedList& li) {
     handleAddEnd(li);  // Uses file searching handler
   }
 
-  li.taken = true;
   MenuUI::displayHeader("New Playlist Creation Finished");
   MenuUI::displayInfo(
       "List '" + (li.listName.empty() ? "[Unnamed]" : li.listName) +
@@ -948,22 +988,26 @@ void createListObject(LinkedList& li) {
 // Handles the "Create New Playlist" menu option
 void createMenuOption() {
   MenuUI::displayHeader("Create New Playlist");
-  int availableSlot = -1;
-  for (size_t i = 0; i < playlists.size(); ++i) {
-    if (!playlists[i].taken) {
-      availableSlot = i;
-      break;
-    }
+  string name;
+  cout << MenuUI::DOUBLE_TAB << "Enter name for the new playlist: ";
+  getline(cin >> ws, name);
+  if (name.empty()) {
+    name = "[Unnamed]";
+    MenuUI::displayInfo("List name set to '[Unnamed]'.");
+  } else if (!isValidNamePart(name)) {
+    MenuUI::displayError(
+        "List name contains invalid characters. Using '[Unnamed]'.");
+    name = "[Unnamed]";
   }
-  if (availableSlot == -1) {
-    MenuUI::displayError("All " + to_string(playlists.size()) +
-                         " playlist slots are currently in use.");
-    MenuUI::pressEnterToContinue();
-    return;
+
+  // Names are the registry's lookup key, so they must be unique
+  string uniqueName = registry.uniqueName(name);
+  if (uniqueName != name) {
+    MenuUI::displayInfo("A playlist named '" + name +
+                        "' already exists. Using '" + uniqueName + "'.");
   }
-  MenuUI::displayInfo("Creating playlist in available slot #" +
-                      to_string(availableSlot + 1) + "...");
-  createListObject(playlists[availableSlot]);
+  int index = registry.create(uniqueName);
+  createListObject(*registry.open(index));
   MenuUI::pressEnterToContinue();
 }
 
@@ -1020,6 +1064,8 @@ void manageListMenu(LinkedList& li, int listIndex) {
          << "│ 12. 🔁 Play with Repeat...                  │" << endl;
     cout << MenuUI::DOUBLE_TAB
          << "│ 13. ◀️  Play in Reverse                     │" << endl;
+    cout << MenuUI::DOUBLE_TAB
+         << "│ 14. 🔀 Shuffle...                           │" << endl;
     cout << MenuUI::DOUBLE_TAB << "└────────────────────────────────────────┘"
          << endl
          << endl;
@@ -1028,9 +1074,9 @@ void manageListMenu(LinkedList& li, int listIndex) {
     cout << MenuUI::DOUBLE_TAB << "┌─ ORGANIZATION ───────────────────────────┐"
          << endl;
     cout << MenuUI::DOUBLE_TAB
-         << "│ 14. 🔍 Search for Song                    │" << endl;
+         << "│ 15. 🔍 Search for Song                    │" << endl;
     cout << MenuUI::DOUBLE_TAB
-         << "│ 15. 🔤 Sort Playlist                      │" << endl;
+         << "│ 16. 🔤 Sort Playlist                      │" << endl;
     cout << MenuUI::DOUBLE_TAB << "└────────────────────────────────────────┘"
          << endl
          << endl;
@@ -1038,12 +1084,12 @@ void manageListMenu(LinkedList& li, int listIndex) {
     // Navigation
     cout << MenuUI::DOUBLE_TAB << "┌─ NAVIGATION ─────────────────────────────┐"
          << endl;
-    cout << MenuUI::DOUBLE_TAB << "│ 16. ↩️  Back to Main Menu                 │"
+    cout << MenuUI::DOUBLE_TAB << "│ 17. ↩️  Back to Main Menu                 │"
          << endl;
     cout << MenuUI::DOUBLE_TAB << "└────────────────────────────────────────┘"
          << endl;
 
-    int choiceVal = MenuUI::getValidatedInput(1, 16);
+    int choiceVal = MenuUI::getValidatedInput(1, 17);
     ManageMenuOption choice = static_cast<ManageMenuOption>(choiceVal);
     bool requiresPause = true;
 
@@ -1051,15 +1097,14 @@ void manageListMenu(LinkedList& li, int listIndex) {
       // Playlist Management
       case ManageMenuOption::DISPLAY:
         cout << endl;
-        printList(li);
+        requiresPause = !printList(li);  // Paging ended with Enter already
         break;
       case ManageMenuOption::RENAME:
-        handleRename(li);
+        handleRename(li, listIndex);
         break;
       case ManageMenuOption::DELETE_LIST:
-        handleDeleteList(li, listIndex);
-        if (!li.taken) {
-          backToMainMenu = true;
+        if (handleDeleteList(li, listIndex)) {
+          backToMainMenu = true;  // 'li' went away with its entry
         }
         requiresPause = false;
         break;
@@ -1133,6 +1178,19 @@ void manageListMenu(LinkedList& li, int listIndex) {
         playWithControlsReverse(li);
         requiresPause = false;
         break;
+      case ManageMenuOption::PLAY_SHUFFLE: {
+        if (li.head == nullptr) {
+          MenuUI::displayError("List is empty.");
+          break;
+        }
+        cout << MenuUI::DOUBLE_TAB << "1. Random order" << endl;
+        cout << MenuUI::DOUBLE_TAB << "2. Random order, artists spread out"
+             << endl;
+        int mode = MenuUI::getValidatedInput(1, 2);
+        MenuUI::displayHeader("Play List (Shuffle): " + li.listName);
+        playWithControlsShuffle(li, mode == 2);
+        requiresPause = false;
+      } break;
 
       // Organization
       case ManageMenuOption::SEARCH:
@@ -1155,111 +1213,207 @@ void manageListMenu(LinkedList& li, int listIndex) {
   }
 }
 
-// Handles the "Manage Playlists" menu option (shows active lists for selection)
+// Handles the "Manage Playlists" menu option (shows lists for selection)
+// The first PLAYLIST_PICKER_MAX lists are numbered; any list can be picked
+// by typing its name, which is a hash lookup in the registry
 void manageCoordinatingMenu() {
   MenuUI::displayHeader("Manage Playlists");
-  vector<int> activeListIndices;
-  for (size_t i = 0; i < playlists.size(); ++i) {
-    if (playlists[i].taken) {
-      activeListIndices.push_back(i);
-    }
-  }
-  if (activeListIndices.empty()) {
+  if (registry.size() == 0) {
     MenuUI::displayInfo(
-        "No playlists available to manage. Please create or load one first.");
+        "No playlists available to manage. Please create or import one "
+        "first.");
     MenuUI::pressEnterToContinue();
     return;
   }
+  size_t shown = min(registry.size(), static_cast<size_t>(PLAYLIST_PICKER_MAX));
   cout << MenuUI::DOUBLE_TAB << "Select a list to manage:" << endl;
   cout << MenuUI::DOUBLE_TAB << "------------------------------------" << endl;
-  for (size_t i = 0; i < activeListIndices.size(); ++i) {
-    int actualIndex = activeListIndices[i];
+  for (size_t i = 0; i < shown; ++i) {
     cout << MenuUI::DOUBLE_TAB << (i + 1) << ". "
-         << getSafePlaylistName(playlists[actualIndex].listName, actualIndex)
-         << " (" << playlists[actualIndex].len << " songs)" << endl;
+         << getSafePlaylistName(registry.nameAt(i), i) << " ("
+         << registry.lengthAt(i) << " songs)" << endl;
+  }
+  if (registry.size() > shown) {
+    cout << MenuUI::DOUBLE_TAB << "... and " << (registry.size() - shown)
+         << " more (enter a name to open one)" << endl;
   }
   cout << MenuUI::DOUBLE_TAB << "------------------------------------" << endl;
-  int choice =
-      MenuUI::getValidatedInput(1, static_cast<int>(activeListIndices.size()));
-  int selectedListIndex = activeListIndices[choice - 1];
-  manageListMenu(playlists[selectedListIndex], selectedListIndex);
+
+  string choice;
+  cout << MenuUI::DOUBLE_TAB << "Enter a number (1-" << shown
+       << ") or a playlist name: ";
+  getline(cin >> ws, choice);
+
+  // A number within range picks from the list above; anything else is a name
+  int selectedListIndex = -1;
+  bool isNumber = !choice.empty() && choice.size() < 10 &&
+                  all_of(choice.begin(), choice.end(),
+                         [](unsigned char c) { return isdigit(c); });
+  if (isNumber) {
+    size_t number = stoul(choice);
+    if (number >= 1 && number <= shown) {
+      selectedListIndex = static_cast<int>(number - 1);
+    }
+  }
+  if (selectedListIndex < 0) selectedListIndex = registry.find(choice);
+  if (selectedListIndex < 0) {
+    MenuUI::displayError("No playlist named '" + choice + "'.");
+    MenuUI::pressEnterToContinue();
+    return;
+  }
+
+  LinkedList* li = registry.open(selectedListIndex);  // Loads on first use
+  if (li == nullptr) {
+    MenuUI::displayError("Could not load '" +
+                         registry.nameAt(selectedListIndex) + "'.");
+    MenuUI::pressEnterToContinue();
+    return;
+  }
+  manageListMenu(*li, selectedListIndex);
+}
+
+// Runs task(item) for every entry of 'items' on a small worker pool and
+// waits for all of them; returns each result in the same order. Playlist
+// files are independent, so a handful of them take about as long as the
+// slowest one.
+static vector<char> runPerPlaylist(const vector<size_t>& items,
+                                   const function<bool(size_t)>& task) {
+  vector<char> results(items.size(), 0);  // char, not bool: written in parallel
+  {
+    ThreadPool pool(static_cast<unsigned>(
+        min(items.size(), static_cast<size_t>(PLAYLIST_IO_THREADS_MAX))));
+    for (size_t j = 0; j < items.size(); ++j) {
+      pool.submit([&, j]() { results[j] = task(items[j]); });
+    }
+    pool.wait();
+  }
+  return results;
 }
 
 // Handles the "Save Playlists" menu option
+// Writes every playlist opened this session (the others are unchanged on
+// disk), then the manifest, which also drops deleted playlists for good
 void handleSaveLists() {
   MenuUI::displayHeader("Save Active Playlists");
-  int savedCount = 0;
-  int activeCount = 0;
-  for (size_t i = 0; i < playlists.size(); ++i) {
-    if (playlists[i].taken) {
-      activeCount++;
-      string filename = "playlist" + to_string(i + 1) + ".json";
-      string listDisplayName = playlists[i].listName.empty()
-                                   ? ("[Unnamed List " + to_string(i + 1) + "]")
-                                   : playlists[i].listName;
-      MenuUI::displayInfo("Attempting to save '" + listDisplayName + "' to '" +
-                          filename + "'...");
-      if (playlists[i].saveToFile(filename)) {
+  vector<size_t> openLists = registry.loadedIndices();
+
+  if (openLists.empty()) {
+    MenuUI::displayInfo("No open playlists to save.");
+  } else {
+    cout << MenuUI::DOUBLE_TAB << "Save format:" << endl;
+    cout << MenuUI::DOUBLE_TAB << "1. Binary (.mpl, fast)" << endl;
+    cout << MenuUI::DOUBLE_TAB << "2. JSON (.json, export)" << endl;
+    bool asJson = MenuUI::getValidatedInput(1, 2) == 2;
+    PlaylistFormat format =
+        asJson ? PlaylistFormat::JSON : PlaylistFormat::BINARY;
+
+    MenuUI::displayInfo("Saving " + to_string(openLists.size()) +
+                        " open playlist(s) to '" + registry.path() +
+                        "/'...");
+    vector<char> saved = runPerPlaylist(
+        openLists, [&](size_t i) { return registry.save(i, format); });
+
+    int savedCount = 0;
+    for (size_t j = 0; j < openLists.size(); ++j) {
+      string listDisplayName =
+          getSafePlaylistName(registry.nameAt(openLists[j]), openLists[j]);
+      if (saved[j]) {
         MenuUI::displaySuccess("Saved '" + listDisplayName + "' successfully.");
         savedCount++;
       } else {
         MenuUI::displayError("Failed to save '" + listDisplayName + "'.");
       }
     }
+    MenuUI::displayInfo(to_string(savedCount) + "/" +
+                        to_string(openLists.size()) +
+                        " open list(s) saved.");
   }
-  if (activeCount == 0) {
-    MenuUI::displayInfo("No active playlists to save.");
+
+  if (registry.saveManifest()) {
+    MenuUI::displaySuccess("Playlist manifest updated (" +
+                           to_string(registry.size()) + " playlist(s)).");
   } else {
-    MenuUI::displayInfo(to_string(savedCount) + "/" + to_string(activeCount) +
-                        " active list(s) saved.");
+    MenuUI::displayError("Failed to update the playlist manifest.");
   }
   MenuUI::pressEnterToContinue();
 }
 
-// Handles the "Load Playlists" menu option
+// Shows the stage timers and counters gathered so far this session
+void handleShowStats() {
+  MenuUI::displayHeader("Performance Stats");
+  Stats::instance().print(cout);
+  MenuUI::pressEnterToContinue();
+}
+
+// True if 'p' is a file name the old fixed-slot version saved, e.g.
+// "playlist2.json" or "playlist2.mpl"
+static bool isLegacySlotFile(const fs::path& p) {
+  string stem = p.stem().string();
+  string extension = p.extension().string();
+  if (extension != ".mpl" && extension != ".json") return false;
+  if (stem.size() <= 8 || stem.compare(0, 8, "playlist") != 0) return false;
+  return all_of(stem.begin() + 8, stem.end(),
+                [](unsigned char c) { return isdigit(c); });
+}
+
+// Handles the "Import Playlist Files" menu option
+// Adds playlistN.mpl / playlistN.json files from the working directory (as
+// written by the old fixed-slot version) to the registry. When both exist
+// for the same slot, the binary one is used.
 void handleLoadLists() {
-  MenuUI::displayHeader("Load Playlists From Files");
+  MenuUI::displayHeader("Import Playlist Files");
+
+  map<string, string> byStem;  // "playlistN" -> file, ordered by name
+  error_code ec;
+  for (const auto& entry : fs::directory_iterator(".", ec)) {
+    const fs::path& p = entry.path();
+    if (!entry.is_regular_file(ec) || !isLegacySlotFile(p)) continue;
+    string& chosen = byStem[p.stem().string()];
+    if (chosen.empty() || p.extension() == ".mpl") {
+      chosen = p.filename().string();
+    }
+  }
+  if (byStem.empty()) {
+    MenuUI::displayInfo(
+        "No playlistN.mpl or playlistN.json files found to import.");
+    MenuUI::pressEnterToContinue();
+    return;
+  }
+
+  vector<string> filenames;
+  vector<size_t> items;
+  for (const auto& stemAndFile : byStem) {
+    MenuUI::displayInfo("Reading '" + stemAndFile.second + "'...");
+    items.push_back(filenames.size());
+    filenames.push_back(stemAndFile.second);
+  }
+
+  // Load every file concurrently, then register them in name order
+  vector<unique_ptr<LinkedList>> lists(filenames.size());
+  for (auto& list : lists) list = make_unique<LinkedList>();
+  vector<char> loaded = runPerPlaylist(items, [&](size_t j) {
+    return lists[j]->loadFromFile(filenames[j]);
+  });
 
-  MenuUI::displayInfo(
-      "Attempting to load playlist1.json, playlist2.json, etc., into available "
-      "slots.");
   int loadedCount = 0;
-  int attemptedLoads = 0;
-  for (size_t i = 0; i < playlists.size(); ++i) {
-    string filename =
-        "playlist" + to_string(i + 1) + ".json";  // Changed from .txt to .json
-    if (!playlists[i].taken) {
-      attemptedLoads++;
-      MenuUI::displayInfo("Checking slot " + to_string(i + 1) +
-                          " (free) for file '" + filename + "'...");
-      if (playlists[i].loadFromFile(filename)) {
-        string loadedName =
-            playlists[i].listName.empty() ? "[Unnamed]" : playlists[i].listName;
-        MenuUI::displaySuccess("Loaded '" + loadedName + "' (" +
-                               to_string(playlists[i].len) +
-                               " songs) into slot " + to_string(i + 1) + ".");
-        loadedCount++;
-      } else {
-        MenuUI::displayInfo("Could not load '" + filename + "' into slot " +
-                            to_string(i + 1) +
-                            ". (File not found or invalid).");
-      }
+  for (size_t j = 0; j < filenames.size(); ++j) {
+    if (loaded[j]) {
+      size_t index = registry.adopt(std::move(lists[j]));
+      MenuUI::displaySuccess("Imported '" + registry.nameAt(index) + "' (" +
+                             to_string(registry.lengthAt(index)) +
+                             " songs) from '" + filenames[j] + "'.");
+      loadedCount++;
     } else {
-      MenuUI::displayInfo("Slot " + to_string(i + 1) + " occupied by '" +
-                          (playlists[i].listName.empty()
-                               ? "[Unnamed]"
-                               : playlists[i].listName) +
-                          "'. Skipping load.");
+      MenuUI::displayInfo("Could not import '" + filenames[j] +
+                          "'. (File invalid).");
     }
   }
-  if (attemptedLoads == 0) {
-    MenuUI::displayInfo("All playlist slots are full.");
-  } else if (loadedCount == 0) {
+  if (loadedCount == 0) {
     MenuUI::displayInfo(
-        "No playlists loaded. Check if .json files exist/are valid.");
+        "No playlists imported. Check if .mpl/.json files are valid.");
   } else {
     MenuUI::displayInfo(to_string(loadedCount) +
-                        " list(s) loaded successfully.");
+                        " list(s) imported. Save to keep them in the library.");
   }
   MenuUI::pressEnterToContinue();
 }
@@ -1279,32 +1433,33 @@ bool displayMainMenu() {
        << endl;
   cout << MenuUI::DOUBLE_TAB << "│  3. 💾 Save Active Playlists            │"
        << endl;
-  cout << MenuUI::DOUBLE_TAB << "│  4. 📂 Load Playlists from Files        │"
+  cout << MenuUI::DOUBLE_TAB << "│  4. 📂 Import Playlist Files            │"
        << endl;
-  cout << MenuUI::DOUBLE_TAB << "│  5. 🚪 Exit                             │"
+  cout << MenuUI::DOUBLE_TAB << "│  5. 📊 Performance Stats                │"
+       << endl;
+  cout << MenuUI::DOUBLE_TAB << "│  6. 🚪 Exit                             │"
        << endl;
   cout << MenuUI::DOUBLE_TAB << "└─────────────────────────────────────────┘"
        << endl;
   cout << endl;
-  // Display Playlist Status
-  int activeCount = 0;
-  cout << MenuUI::DOUBLE_TAB << "Playlist Slots Status:" << endl;
-  for (size_t i = 0; i < playlists.size(); ++i) {
-    cout << MenuUI::DOUBLE_TAB << "  Slot " << (i + 1) << ": ";
-    if (playlists[i].taken) {
-      cout << "Active - '" << getSafePlaylistName(playlists[i].listName, i)
-           << "' (" << playlists[i].len << " songs)";
-      activeCount++;
-    } else {
-      cout << "Available";
-    }
-    cout << endl;
+  // Display Playlist Status (lengths come from the manifest, so listing a
+  // playlist never loads it)
+  size_t shown = min(registry.size(), static_cast<size_t>(PLAYLIST_STATUS_MAX));
+  cout << MenuUI::DOUBLE_TAB << "Playlists:" << endl;
+  for (size_t i = 0; i < shown; ++i) {
+    cout << MenuUI::DOUBLE_TAB << "  " << (i + 1) << ". '"
+         << getSafePlaylistName(registry.nameAt(i), i) << "' ("
+         << registry.lengthAt(i) << " songs)" << endl;
+  }
+  if (registry.size() > shown) {
+    cout << MenuUI::DOUBLE_TAB << "  ... and " << (registry.size() - shown)
+         << " more" << endl;
   }
-  cout << MenuUI::DOUBLE_TAB << "Total Active: " << activeCount << "/"
-       << playlists.size() << endl
+  cout << MenuUI::DOUBLE_TAB << "Total: " << registry.size() << " ("
+       << registry.loadedIndices().size() << " open)" << endl
        << endl;
   // Get Input
-  int choiceVal = MenuUI::getValidatedInput(1, 5);
+  int choiceVal = MenuUI::getValidatedInput(1, 6);
   MainMenuOption choice = static_cast<MainMenuOption>(choiceVal);
   bool shouldExit = false;
   // Process Choice
@@ -1321,6 +1476,9 @@ bool displayMainMenu() {
     case MainMenuOption::LOAD_LISTS:
       handleLoadLists();
       break;
+    case MainMenuOption::SHOW_STATS:
+      handleShowStats();
+      break;
     case MainMenuOption::EXIT:
       cout << endl
            << MenuUI::DOUBLE_TAB << "Exiting... Goodbye! 👋" << endl
@@ -1332,76 +1490,138 @@ bool displayMainMenu() {
 }
 
 // --- Program Entry Point ---
-int main() {
+int main(int argc, char** argv) {
+  // Options, and --batch runs that skip the menu entirely
+  int cliResult = runCommandLine(argc, argv);
+  if (cliResult != CLI_START_MENU) {
+    Stats::instance().dumpIfRequested();
+    return cliResult;
+  }
+
   // Ensure music directory exists
   ensureMusicDirectoryExists();
+  // Index it in the background so the browser opens from the cache
+  MusicLibrary::instance().startScan("music");
+  // Then keep the listings current as files come and go
+  MusicLibrary::instance().startWatching("music");
+  // Read tags and lengths of every track as its playlist loads
+  MetadataStore::instance().start();
+  // Only the manifest is read here; playlists load when first opened
+  if (!registry.loadManifest()) {
+    MenuUI::displayError("Playlist manifest unreadable; starting empty.");
+  }
 
   while (!shouldExitProgram) {
     shouldExitProgram = displayMainMenu();
   }
 
-  // Clean up before exit
-  for (auto& playlist : playlists) {
-    if (playlist.taken) {
-      playlist.clear();
-    }
-  }
+  // Stop the background work before anything it uses is destroyed: the
+  // watcher queues tag reads, and the reads use the decoders
+  MusicLibrary::instance().stopWatching();
+  MetadataStore::instance().shutdown();
+
+  // Playlists are freed with the registry at exit
+  MusicLibrary::instance().saveCache();  // Keep browser re-listings
+  MetadataStore::instance().saveCache();  // And the tags read so far
+  Stats::instance().dumpIfRequested();   // --stats-json
 
   return 0;
 }
 
-void printList(LinkedList& li) {
-  if (li.isEmpty()) {
-    MenuUI::displayInfo("Playlist is empty.");
-    return;
+// One row of printList()'s box: position, title, length and artist
+static string formatPrintRow(const node* temp, size_t position) {
+  // Get the cached clean song name and ensure it's safe
+  std::string songName = temp->track().cleanName;
+  if (songName.find('\0') != std::string::npos) {
+    songName = "[Corrupted Song]";
+  }
+  if (temp->track().missing) {
+    songName = "(missing) " + songName;  // Deleted since it was added
   }
 
-  node* temp = li.head;
-  int songCount = 0;
+  // Get artist (the tagged one if none was entered) and ensure it's safe
+  std::string artistName = temp->track().shownArtist();
+  if (artistName.find('\0') != std::string::npos) {
+    artistName = "[Unknown]";
+  }
 
-  // Use safe playlist name
-  std::string safeListName = getSafePlaylistName(li.listName, 0);
-  MenuUI::displayHeader("Playlist: " + safeListName);
+  // Format display string
+  const int maxSongLength = 30;
+  const int maxArtistLength = 15;
 
-  std::cout << MenuUI::DOUBLE_TAB
-            << "┌─ PLAYLIST CONTENTS ─────────────────────────────────────────┐"
-            << std::endl;
+  if (songName.length() > maxSongLength) {
+    songName = songName.substr(0, maxSongLength - 3) + "...";
+  }
 
-  do {
-    // Get clean song name and ensure it's safe
-    std::string songName = getCleanSongName(temp->song);
-    if (songName.find('\0') != std::string::npos) {
-      songName = "[Corrupted Song]";
-    }
+  if (artistName.length() > maxArtistLength) {
+    artistName = artistName.substr(0, maxArtistLength - 3) + "...";
+  }
 
-    // Get artist and ensure it's safe
-    std::string artistName = temp->artist;
-    if (artistName.find('\0') != std::string::npos) {
-      artistName = "[Unknown]";
-    }
+  // Length from the metadata pass; blank until it has been read
+  int durationMs = temp->track().durationMs.load();
+  std::string length = durationMs > 0 ? formatDuration(durationMs) : "";
+
+  // Format output with song name, length and artist
+  std::ostringstream row;
+  row << MenuUI::DOUBLE_TAB << "│ " << std::left << std::setw(3) << position
+      << ". " << std::setw(maxSongLength) << songName << std::right
+      << std::setw(8) << length << std::left << " - "
+      << std::setw(maxArtistLength) << artistName << " │";
+  return row.str();
+}
 
-    // Format display string
-    const int maxSongLength = 30;
-    const int maxArtistLength = 15;
+bool printList(LinkedList& li) {
+  if (li.isEmpty()) {
+    MenuUI::displayInfo("Playlist is empty.");
+    return false;
+  }
 
-    if (songName.length() > maxSongLength) {
-      songName = songName.substr(0, maxSongLength - 3) + "...";
-    }
+  // Use safe playlist name
+  std::string safeListName = getSafePlaylistName(li.listName, 0);
 
-    if (artistName.length() > maxArtistLength) {
-      artistName = artistName.substr(0, maxArtistLength - 3) + "...";
+  // Rows are formatted once and kept until the list or its tracks change
+  RowCache& rows = li.printRows;
+  size_t pageNumber = 1;
+  while (true) {
+    rows.sync(li.revision(), TrackCatalog::instance().revision());
+    ViewPage page = viewPage(pageNumber, static_cast<size_t>(li.len),
+                             pageRows(PRINT_LIST_RESERVED_ROWS));
+    MenuUI::displayHeader("Playlist: " + safeListName);
+
+    std::cout
+        << MenuUI::DOUBLE_TAB
+        << "┌─ PLAYLIST CONTENTS ─────────────────────────────────────────────────┐"
+        << std::endl;
+
+    node* temp = li.nodeAt(static_cast<int>(page.first) + 1);  // O(log n)
+    for (size_t i = page.first; i < page.first + page.count; ++i) {
+      const std::string* row = rows.find(i);
+      if (row == nullptr) row = &rows.store(i, formatPrintRow(temp, i + 1));
+      std::cout << *row << '\n';
+      temp = temp->next;
     }
 
-    // Format output with song name and artist
-    std::cout << MenuUI::DOUBLE_TAB << "│ " << std::left << std::setw(3)
-              << (++songCount) << ". " << std::setw(maxSongLength) << songName
-              << " - " << std::setw(maxArtistLength) << artistName << " │"
-              << std::endl;
-    temp = temp->next;
-  } while (temp != li.head);
+    std::cout
+        << MenuUI::DOUBLE_TAB
+        << "└───────────────────────────────────────────────────────────────────┘"
+        << std::endl;
+    std::cout << MenuUI::DOUBLE_TAB << "Total songs: " << li.len << std::endl;
 
-  std::cout << MenuUI::DOUBLE_TAB
-            << "└───────────────────────────────────────────────────────────┘"
-            << std::endl;
-  std::cout << MenuUI::DOUBLE_TAB << "Total songs: " << songCount << std::endl;
+    // The total walks the whole list, so it is cached like a row
+    const std::string* total = rows.find(VIEW_SUMMARY_ROW);
+    if (total == nullptr) {
+      total = &rows.store(VIEW_SUMMARY_ROW, totalTimeLine(li));
+    }
+    std::cout << MenuUI::DOUBLE_TAB << *total << std::endl;
+
+    if (page.pages == 1) return false;  // Caller's pause ends the view
+    std::cout << std::endl
+              << MenuUI::DOUBLE_TAB << "Page " << page.number << " of "
+              << page.pages << " (N next, P previous, Enter to return): "
+              << std::flush;
+    std::string input;
+    if (!std::getline(std::cin, input) || !turnPage(input, page, pageNumber)) {
+      return true;
+    }
+  }
 }
\ No newline at end of file
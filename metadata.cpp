@@ -0,0 +1,187 @@
+#include "metadata.h"
+
+#include <algorithm>
+#include <cstdio>  // For std::rename
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#include "decoder.h"  // DecoderRegistry::probe()
+#include "link.h"     // toLowerCopy(), fs
+#include "session.h"  // AudioSession, which the decoders rely on
+
+using json = nlohmann::json;
+
+MetadataStore& MetadataStore::instance() {
+  static MetadataStore store;  // Destroyed at process exit
+  return store;
+}
+
+MetadataStore::MetadataStore()
+    : started(false),
+      dirty(false),
+      stopping(false),
+      readers(std::max(std::thread::hardware_concurrency(),
+                       static_cast<unsigned>(METADATA_READ_THREADS_MIN))) {
+  // Constructed first, so the catalog outlives the reads that publish to
+  // it, and the decoders and the session the reads use outlive them too
+  TrackCatalog::instance();
+  DecoderRegistry::instance();
+  AudioSession::instance();
+}
+
+MetadataStore::~MetadataStore() {
+  shutdown();
+}
+
+void MetadataStore::shutdown() {
+  stopping = true;
+  TrackCatalog::instance().setNewPathHandler(nullptr);
+  readers.wait();  // Queued reads return at once
+}
+
+void MetadataStore::start() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (started) return;
+    started = true;
+  }
+  loadCache();
+  TrackCatalog& catalog = TrackCatalog::instance();
+  catalog.setNewPathHandler(
+      [this](const std::string& path) { request(path); });
+  for (const std::string& path : catalog.paths()) request(path);
+}
+
+void MetadataStore::request(const std::string& path) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!started || stopping || !queued.insert(path).second) {
+      return;  // Not running, or pending already
+    }
+  }
+  readers.submit([this, path]() { read(path); });
+}
+
+void MetadataStore::wait() {
+  readers.wait();
+}
+
+void MetadataStore::read(const std::string& path) {
+  if (stopping) return;  // Process is exiting
+  std::error_code ec;
+  auto written = fs::last_write_time(path, ec);
+  uintmax_t size = ec ? 0 : fs::file_size(path, ec);
+
+  std::unique_lock<std::mutex> lock(mtx);
+  queued.erase(path);  // A request from here on reads the file again
+  if (ec) {
+    // Gone: its entry would only grow the cache
+    if (entries.erase(path) > 0) dirty = true;
+    return;
+  }
+  const int64_t mtime =
+      static_cast<int64_t>(written.time_since_epoch().count());
+
+  auto cached = entries.find(path);
+  if (cached == entries.end() || cached->second.mtime != mtime ||
+      cached->second.size != size) {
+    lock.unlock();
+    Entry entry{mtime, static_cast<uint64_t>(size), -1, TrackTags()};
+    std::string error;
+    std::unique_ptr<Decoder> decoder =
+        DecoderRegistry::instance().probe(path, error);
+    if (decoder) {
+      const StreamInfo& info = decoder->info();
+      if (info.totalFrames > 0 && info.rate > 0) {
+        entry.durationMs =
+            static_cast<int>(info.totalFrames * 1000 / info.rate);
+      }
+      entry.tags.artist = info.tags.artist;
+      entry.tags.title = info.tags.title;
+      entry.tags.album = info.tags.album;
+    }
+    // An unreadable file is cached too, so it is not probed every run
+
+    lock.lock();
+    cached = entries.insert_or_assign(path, std::move(entry)).first;
+    dirty = true;
+  }
+
+  TrackTags tags = cached->second.tags;
+  int durationMs = cached->second.durationMs;
+  lock.unlock();
+  tags.artistKey = toLowerCopy(tags.artist);
+  TrackCatalog::instance().setMetadata(path, tags, durationMs);
+}
+
+void MetadataStore::loadCache() {
+  std::ifstream file(METADATA_CACHE_FILE);
+  if (!file.is_open()) return;  // First run: nothing cached yet
+
+  std::unordered_map<std::string, Entry> loaded;
+  try {
+    json cacheJson = json::parse(file);
+    if (cacheJson.value("version", 0) != METADATA_CACHE_VERSION) return;
+
+    for (const auto& trackJson : cacheJson.at("tracks")) {
+      Entry entry;
+      entry.mtime = trackJson.at("mtime").get<int64_t>();
+      entry.size = trackJson.at("size").get<uint64_t>();
+      entry.durationMs = trackJson.at("durationMs").get<int>();
+      entry.tags.artist = trackJson.value("artist", "");
+      entry.tags.title = trackJson.value("title", "");
+      entry.tags.album = trackJson.value("album", "");
+      loaded[trackJson.at("path").get<std::string>()] = std::move(entry);
+    }
+  } catch (const json::exception& e) {
+    std::cerr << "\t\tWarning: Ignoring damaged metadata cache: " << e.what()
+              << std::endl;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  entries.swap(loaded);
+}
+
+bool MetadataStore::saveCache() {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!dirty) return true;  // Disk copy is already current
+
+  json tracksArray = json::array();
+  for (const auto& entry : entries) {
+    json trackJson = {{"path", entry.first},
+                      {"mtime", entry.second.mtime},
+                      {"size", entry.second.size},
+                      {"durationMs", entry.second.durationMs}};
+    // Untagged files (most WAVs) leave the fields out
+    const TrackTags& tags = entry.second.tags;
+    if (!tags.artist.empty()) trackJson["artist"] = tags.artist;
+    if (!tags.title.empty()) trackJson["title"] = tags.title;
+    if (!tags.album.empty()) trackJson["album"] = tags.album;
+    tracksArray.push_back(std::move(trackJson));
+  }
+  json cacheJson;
+  cacheJson["version"] = METADATA_CACHE_VERSION;
+  cacheJson["tracks"] = std::move(tracksArray);
+
+  // Write a temporary file and rename it so a crash never leaves half a cache
+  const std::string tempName = std::string(METADATA_CACHE_FILE) + ".tmp";
+  {
+    std::ofstream file(tempName);
+    if (!file.is_open()) {
+      std::cerr << "\t\tWarning: Could not write metadata cache '" << tempName
+                << "'." << std::endl;
+      return false;
+    }
+    // Tags are arbitrary bytes; invalid UTF-8 is replaced, not fatal
+    file << cacheJson.dump(-1, ' ', false, json::error_handler_t::replace);
+    if (!file.good()) return false;
+  }
+  if (std::rename(tempName.c_str(), METADATA_CACHE_FILE) != 0) {
+    std::cerr << "\t\tWarning: Could not replace metadata cache." << std::endl;
+    return false;
+  }
+  dirty = false;
+  return true;
+}
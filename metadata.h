@@ -0,0 +1,83 @@
+#ifndef METADATA_H
+#define METADATA_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "catalog.h"     // TrackTags, and where results are published
+#include "threadpool.h"  // Worker pool for the reads
+
+// --- Track Metadata Pass ---
+// Reads the tags (ID3, Vorbis comments, FLAC and WAV INFO tags) and the
+// header-derived length of every catalogued track on a thread pool, and
+// publishes them to the TrackCatalog, so listings can show lengths and
+// tagged artists, and sort on them, without decoding anything. Files are
+// opened with DecoderRegistry::probe(), which reads headers only.
+// Results are cached on disk keyed by path, modification time and size;
+// an unchanged file is never opened again.
+
+// Cache file written next to the playlists, and its format version
+#define METADATA_CACHE_FILE "track_metadata_cache.json"
+#define METADATA_CACHE_VERSION 1
+// Reads are mostly waiting on the disk, so use at least this many threads
+// even on machines with fewer cores
+#define METADATA_READ_THREADS_MIN 4
+
+class MetadataStore {
+public:
+  // Returns the store shared by the whole process
+  static MetadataStore& instance();
+
+  // Loads the cache, queues every track catalogued so far, then every
+  // path the catalog sees from now on (as playlists load or grow).
+  // Later calls are ignored.
+  void start();
+
+  // Queues a read of 'path' (e.g. after the file was rewritten). The read
+  // only opens the file if its cached stamp no longer matches. Ignored
+  // before start().
+  void request(const std::string& path);
+
+  // Blocks until every queued read has finished
+  void wait();
+
+  // Skips the reads still queued and waits for the running ones; later
+  // requests are ignored. Called at exit once nothing else requests reads.
+  void shutdown();
+
+  // Writes the cache to disk if anything changed. Returns false on failure.
+  bool saveCache();
+
+  MetadataStore(const MetadataStore&) = delete;
+  MetadataStore& operator=(const MetadataStore&) = delete;
+
+private:
+  MetadataStore();
+  ~MetadataStore();  // Calls shutdown()
+
+  // What was read from one version of a file
+  struct Entry {
+    int64_t mtime;
+    uint64_t size;
+    int durationMs;  // -1 if the headers do not give it
+    TrackTags tags;
+  };
+
+  // Body of one read task (runs on 'readers')
+  void read(const std::string& path);
+  void loadCache();  // Called once by start()
+
+  std::unordered_map<std::string, Entry> entries;  // Keyed by path
+  std::unordered_set<std::string> queued;  // Paths with a read pending
+  bool started;
+  bool dirty;  // 'entries' differs from the cache file on disk
+  std::atomic<bool> stopping;
+  std::mutex mtx;
+  ThreadPool readers;  // Last, so it is joined before the rest goes
+};
+
+#endif  // METADATA_H
@@ -0,0 +1,112 @@
+#include "mp3_index.h"
+
+// Required for MP3 decoding
+#include <mpg123.h>
+
+#include "link.h"     // fs
+#include "session.h"  // Shared mpg123 initialisation
+#include "stats.h"    // Scan timing
+
+Mp3IndexCache& Mp3IndexCache::instance() {
+  static Mp3IndexCache cache;
+  return cache;
+}
+
+// One scanning thread: scans are disk-bound and only the next few tracks
+// ever need one
+Mp3IndexCache::Mp3IndexCache() : useCounter(0), stopping(false), scanner(1) {}
+
+Mp3IndexCache::~Mp3IndexCache() {
+  stopping = true;
+}
+
+bool Mp3IndexCache::stampOf(const std::string& path, Mp3FileStamp& stamp) {
+  std::error_code ec;
+  auto written = fs::last_write_time(path, ec);
+  if (ec) return false;
+  uintmax_t size = fs::file_size(path, ec);
+  if (ec) return false;
+  stamp.mtime = static_cast<int64_t>(written.time_since_epoch().count());
+  stamp.size = size;
+  return true;
+}
+
+std::shared_ptr<const Mp3SeekIndex> Mp3IndexCache::find(
+    const std::string& path, const Mp3FileStamp& stamp) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = entries.find(path);
+  if (it == entries.end() || !(it->second.stamp == stamp)) return nullptr;
+  it->second.lastUsed = ++useCounter;
+  return it->second.index;
+}
+
+void Mp3IndexCache::request(const std::string& path,
+                            const Mp3FileStamp& stamp) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(path);
+    if (it != entries.end() && it->second.stamp == stamp) {
+      it->second.lastUsed = ++useCounter;
+      return;  // Cached, or its scan is queued already
+    }
+    if (it == entries.end() && entries.size() >= MP3_INDEX_CACHE_ENTRIES) {
+      evictOldest();
+    }
+    entries[path] = Entry{stamp, nullptr, false, ++useCounter};
+  }
+
+  scanner.submit([this, path, stamp]() {
+    if (stopping) return;  // Process is exiting
+    std::shared_ptr<const Mp3SeekIndex> index = scan(path);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(path);
+    if (it != entries.end() && it->second.stamp == stamp) {
+      it->second.index = index;
+      it->second.done = true;
+    }
+  });
+}
+
+// Scans in progress are never evicted: their result has somewhere to go
+void Mp3IndexCache::evictOldest() {
+  auto oldest = entries.end();
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (!it->second.done) continue;
+    if (oldest == entries.end() ||
+        it->second.lastUsed < oldest->second.lastUsed) {
+      oldest = it;
+    }
+  }
+  if (oldest != entries.end()) entries.erase(oldest);
+}
+
+std::shared_ptr<const Mp3SeekIndex> Mp3IndexCache::scan(
+    const std::string& path) {
+  if (!AudioSession::instance().ensureMpg123()) return nullptr;
+  ScopedTimer timer(StatTimer::MP3_SCAN);
+
+  int mpg123_error_code = MPG123_OK;
+  mpg123_handle* mh = mpg123_new(NULL, &mpg123_error_code);
+  if (mh == NULL) return nullptr;
+  mpg123_param(mh, MPG123_VERBOSE, 0, 0.0);
+  mpg123_param(mh, MPG123_RESYNC_LIMIT, -1, 0.0);
+
+  std::shared_ptr<Mp3SeekIndex> index;
+  if (mpg123_open(mh, path.c_str()) == MPG123_OK &&
+      mpg123_scan(mh) == MPG123_OK) {
+    index = std::make_shared<Mp3SeekIndex>();
+    index->totalFrames = mpg123_length(mh);  // Exact after a scan
+
+    off_t* offsets = nullptr;
+    off_t step = 0;
+    size_t fill = 0;
+    if (mpg123_index(mh, &offsets, &step, &fill) == MPG123_OK && offsets) {
+      index->step = step;
+      index->offsets.assign(offsets, offsets + fill);
+    }
+  }
+  mpg123_close(mh);
+  mpg123_delete(mh);
+  return index;
+}
@@ -0,0 +1,84 @@
+#ifndef MP3_INDEX_H
+#define MP3_INDEX_H
+
+#include <sys/types.h>  // off_t
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "threadpool.h"
+
+// --- MP3 Seek Index Cache ---
+// The mpg123 backend opens files without mpg123_scan(), taking the length
+// from the Xing/Info or VBRI header (or the bitrate for plain CBR). A full
+// scan still gives the exact length and a frame index that makes seeking
+// cheap, so it runs here on a background thread while the track plays.
+// Results are kept per file, keyed by path, modification time and size,
+// so replaying or seeking in an unchanged file never scans it again.
+
+// Scans kept at once; the least recently used one is dropped first
+#define MP3_INDEX_CACHE_ENTRIES 64
+
+// Result of one full scan
+struct Mp3SeekIndex {
+  off_t totalFrames = -1;      // Exact length in PCM frames
+  off_t step = 0;              // MPEG frames between index entries
+  std::vector<off_t> offsets;  // Byte offset of every step'th MPEG frame
+};
+
+// Identifies one version of a file
+struct Mp3FileStamp {
+  int64_t mtime = 0;
+  uintmax_t size = 0;
+  bool operator==(const Mp3FileStamp& other) const {
+    return mtime == other.mtime && size == other.size;
+  }
+};
+
+class Mp3IndexCache {
+public:
+  // Returns the cache shared by every mpg123 decoder
+  static Mp3IndexCache& instance();
+
+  // Current stamp of 'path'; false if it cannot be read
+  static bool stampOf(const std::string& path, Mp3FileStamp& stamp);
+
+  // The finished scan of this version of 'path', or nullptr
+  std::shared_ptr<const Mp3SeekIndex> find(const std::string& path,
+                                           const Mp3FileStamp& stamp);
+
+  // Queues a scan unless one is cached or already queued. Scans of tracks
+  // further ahead wait behind those requested earlier.
+  void request(const std::string& path, const Mp3FileStamp& stamp);
+
+  Mp3IndexCache(const Mp3IndexCache&) = delete;
+  Mp3IndexCache& operator=(const Mp3IndexCache&) = delete;
+
+private:
+  Mp3IndexCache();
+  ~Mp3IndexCache();  // Skips queued scans; waits for a running one
+
+  struct Entry {
+    Mp3FileStamp stamp;
+    std::shared_ptr<const Mp3SeekIndex> index;  // nullptr until scanned
+    bool done;  // Scan finished (even unsuccessfully: not retried)
+    uint64_t lastUsed;
+  };
+
+  // Scans 'path' with a handle of its own; nullptr if it cannot be read
+  static std::shared_ptr<const Mp3SeekIndex> scan(const std::string& path);
+  void evictOldest();  // Called with 'mtx' held
+
+  std::unordered_map<std::string, Entry> entries;
+  uint64_t useCounter;
+  std::atomic<bool> stopping;
+  std::mutex mtx;
+  ThreadPool scanner;  // Last, so it is joined before the rest goes
+};
+
+#endif  // MP3_INDEX_H
@@ -0,0 +1,86 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// --- Audio Outputs ---
+// One interface over the places the player can send S16 PCM: the sound
+// server, or for headless runs nowhere or a file. Each backend lives in its
+// own output_<name>.cpp. AudioSession opens and caches them; the playback
+// engine writes through them.
+
+// Default server-side buffer the player keeps filled (PulseAudio tlength)
+#define OUTPUT_TARGET_LATENCY_MS 50
+// Default smallest refill the server asks for (PulseAudio minreq)
+#define OUTPUT_MIN_REQUEST_MS 10
+
+// Where the PCM goes
+enum class OutputSink {
+  PULSE,      // The sound server (async backend, pa_simple fallback)
+  NULL_SINK,  // Discarded as fast as it arrives
+  WAV_FILE,   // 16-bit PCM WAV at 'filePath'
+  RAW_FILE    // Headerless interleaved S16LE at 'filePath'
+};
+
+// How outputs are opened; see AudioSession::setOutputConfig()
+struct OutputConfig {
+  OutputSink sink = OutputSink::PULSE;
+  // File sinks: the first sample spec writes here; any other spec goes to
+  // the same name with ".<rate>Hz-<channels>ch" before the extension
+  std::string filePath;
+  bool useAsync = true;  // pa_stream backend first; false forces pa_simple
+  int targetLatencyMs = OUTPUT_TARGET_LATENCY_MS;
+  int minRequestMs = OUTPUT_MIN_REQUEST_MS;
+};
+
+// An open playback stream with a fixed (rate, channels) S16 format.
+// write(), drain() and latencyUs() are called by the output thread; flush()
+// and setPaused() may be called from another thread at the same time, so
+// that pause, stop and seek take effect without waiting for write().
+class AudioOutput {
+public:
+  virtual ~AudioOutput() = default;
+
+  // Backend name, e.g. "pulse-async"
+  virtual const char* name() const = 0;
+
+  // Connects to the server. On failure returns false and fills 'error'.
+  virtual bool open(long rate, int channels, std::string& error) = 0;
+
+  // Queues 'samples' interleaved samples, blocking while the server-side
+  // buffer is full. Returns false on a stream error.
+  virtual bool write(const short* data, size_t samples,
+                     std::string& error) = 0;
+
+  // Blocks until everything queued has been played
+  virtual bool drain(std::string& error) = 0;
+
+  // Drops everything queued and not yet played
+  virtual void flush() = 0;
+
+  // Holds playback (keeping what is queued) or resumes it. Backends that
+  // cannot cork ignore it; output then stops once write() stops.
+  virtual void setPaused(bool paused) { (void)paused; }
+
+  // Time until a sample written now is heard, in microseconds (-1 unknown)
+  virtual int64_t latencyUs() = 0;
+};
+
+// --- Built-in Backends ---
+
+// Threaded-mainloop pa_stream with the configured buffer attributes;
+// corks and flushes immediately
+std::unique_ptr<AudioOutput> makePulseAsyncOutput(const OutputConfig& config);
+// Blocking pa_simple API, the fallback if the async backend cannot connect
+std::unique_ptr<AudioOutput> makePulseSimpleOutput(const OutputConfig& config);
+// Accepts and drops everything, without pacing; for headless runs
+std::unique_ptr<AudioOutput> makeNullOutput();
+// Writes to 'path' as WAV (header completed by drain() and on close) or
+// as raw S16LE, without pacing
+std::unique_ptr<AudioOutput> makeFileOutput(const std::string& path,
+                                            bool wavHeader);
+
+#endif  // OUTPUT_H
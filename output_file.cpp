@@ -0,0 +1,118 @@
+#include "output.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// --- File Sink (WAV or raw S16LE) ---
+// Writes the stream to disk as fast as it arrives. A WAV file starts with a
+// header whose sizes are zero; drain() and close fill them in, so a file
+// cut short by a crash still has its samples. Sizes are capped at the
+// 4 GiB a RIFF header can describe.
+class FileOutput : public AudioOutput {
+public:
+  FileOutput(const std::string& path, bool wavHeader)
+      : path(path),
+        wavHeader(wavHeader),
+        file(nullptr),
+        rate(0),
+        channels(0),
+        dataBytes(0) {}
+
+  ~FileOutput() override {
+    if (file) {
+      finishHeader();
+      fclose(file);
+    }
+  }
+
+  const char* name() const override { return wavHeader ? "wav" : "raw"; }
+
+  bool open(long sampleRate, int channelCount, std::string& error) override {
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+      error = "Cannot create '" + path + "': " + strerror(errno);
+      return false;
+    }
+    rate = sampleRate;
+    channels = channelCount;
+    if (wavHeader && !writeHeader()) {
+      error = "Cannot write to '" + path + "'";
+      return false;
+    }
+    return true;
+  }
+
+  bool write(const short* data, size_t samples, std::string& error) override {
+    if (fwrite(data, sizeof(short), samples, file) != samples) {
+      error = "Cannot write to '" + path + "': " + strerror(errno);
+      return false;
+    }
+    dataBytes += samples * sizeof(short);
+    return true;
+  }
+
+  bool drain(std::string& error) override {
+    if (!finishHeader() || fflush(file) != 0) {
+      error = "Cannot write to '" + path + "'";
+      return false;
+    }
+    return true;
+  }
+
+  void flush() override {}  // Nothing is queued: every write is on disk
+  int64_t latencyUs() override { return 0; }
+
+private:
+  // Writes the 44-byte header for the current data size at the start
+  bool writeHeader() {
+    const uint32_t data = dataBytes > 0xFFFFFFFFull - 36
+                              ? static_cast<uint32_t>(0xFFFFFFFFull - 36)
+                              : static_cast<uint32_t>(dataBytes);
+    const uint16_t blockAlign = static_cast<uint16_t>(channels * 2);
+    unsigned char header[44];
+    std::memcpy(header, "RIFF", 4);
+    putLE32(header + 4, 36 + data);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    putLE32(header + 16, 16);  // fmt chunk size
+    putLE16(header + 20, 1);   // PCM
+    putLE16(header + 22, static_cast<uint16_t>(channels));
+    putLE32(header + 24, static_cast<uint32_t>(rate));
+    putLE32(header + 28, static_cast<uint32_t>(rate) * blockAlign);
+    putLE16(header + 32, blockAlign);
+    putLE16(header + 34, 16);  // Bits per sample
+    std::memcpy(header + 36, "data", 4);
+    putLE32(header + 40, data);
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+  }
+
+  // Rewrites the header with the final sizes and returns to the end
+  bool finishHeader() {
+    if (!wavHeader) return true;
+    if (fseek(file, 0, SEEK_SET) != 0) return false;
+    bool ok = writeHeader();
+    return fseek(file, 0, SEEK_END) == 0 && ok;
+  }
+
+  static void putLE16(unsigned char* at, uint16_t v) {
+    at[0] = static_cast<unsigned char>(v);
+    at[1] = static_cast<unsigned char>(v >> 8);
+  }
+  static void putLE32(unsigned char* at, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+      at[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+  }
+
+  std::string path;
+  bool wavHeader;
+  FILE* file;
+  long rate;
+  int channels;
+  uint64_t dataBytes;  // Sample bytes written so far
+};
+
+std::unique_ptr<AudioOutput> makeFileOutput(const std::string& path,
+                                            bool wavHeader) {
+  return std::make_unique<FileOutput>(path, wavHeader);
+}
@@ -0,0 +1,27 @@
+#include "output.h"
+
+// --- Null Sink ---
+// Takes every block at once and keeps nothing, so playback runs as fast as
+// the decoders can go. Used for throughput runs on hosts without a sound
+// server.
+class NullOutput : public AudioOutput {
+public:
+  const char* name() const override { return "null"; }
+
+  bool open(long /*rate*/, int /*channels*/, std::string& /*error*/) override {
+    return true;
+  }
+
+  bool write(const short* /*data*/, size_t /*samples*/,
+             std::string& /*error*/) override {
+    return true;
+  }
+
+  bool drain(std::string& /*error*/) override { return true; }
+  void flush() override {}
+  int64_t latencyUs() override { return 0; }
+};
+
+std::unique_ptr<AudioOutput> makeNullOutput() {
+  return std::make_unique<NullOutput>();
+}
@@ -0,0 +1,245 @@
+#include "output.h"
+
+// Required for PulseAudio output
+#include <pulse/pulseaudio.h>
+
+#include <algorithm>
+
+// --- pa_stream Backend ---
+// A pa_stream on a threaded mainloop owned by the output. Every call takes
+// the mainloop lock, so flush() and setPaused() from the UI thread act at
+// once, even while write() waits for space. The callbacks only wake the
+// waiting caller.
+class PulseAsyncOutput : public AudioOutput {
+public:
+  explicit PulseAsyncOutput(const OutputConfig& config)
+      : config(config),
+        mainloop(nullptr),
+        context(nullptr),
+        stream(nullptr),
+        corked(false),
+        operationSucceeded(false) {}
+
+  ~PulseAsyncOutput() override {
+    if (mainloop) pa_threaded_mainloop_stop(mainloop);  // Without the lock
+    if (stream) {
+      pa_stream_disconnect(stream);
+      pa_stream_unref(stream);
+    }
+    if (context) {
+      pa_context_disconnect(context);
+      pa_context_unref(context);
+    }
+    if (mainloop) pa_threaded_mainloop_free(mainloop);
+  }
+
+  const char* name() const override { return "pulse-async"; }
+
+  bool open(long rate, int channels, std::string& error) override {
+    mainloop = pa_threaded_mainloop_new();
+    if (!mainloop) {
+      error = "Cannot create PulseAudio mainloop.";
+      return false;
+    }
+    context = pa_context_new(pa_threaded_mainloop_get_api(mainloop),
+                             "Audio Playlist App");
+    if (!context) {
+      error = "Cannot create PulseAudio context.";
+      return false;
+    }
+    pa_context_set_state_callback(context, contextStateCallback, this);
+
+    pa_threaded_mainloop_lock(mainloop);
+    bool ok = connect(rate, channels, error);
+    pa_threaded_mainloop_unlock(mainloop);
+    return ok;
+  }
+
+  bool write(const short* data, size_t samples, std::string& error) override {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t remaining = samples * sizeof(short);
+
+    pa_threaded_mainloop_lock(mainloop);
+    while (remaining > 0) {
+      size_t writable = pa_stream_writable_size(stream);
+      if (writable == static_cast<size_t>(-1) || !streamGood()) {
+        error = pa_strerror(pa_context_errno(context));
+        pa_threaded_mainloop_unlock(mainloop);
+        return false;
+      }
+      if (writable == 0) {  // Buffer full: the write callback wakes us
+        pa_threaded_mainloop_wait(mainloop);
+        continue;
+      }
+      size_t chunk = std::min(writable, remaining);
+      if (pa_stream_write(stream, bytes, chunk, NULL, 0, PA_SEEK_RELATIVE) <
+          0) {
+        error = pa_strerror(pa_context_errno(context));
+        pa_threaded_mainloop_unlock(mainloop);
+        return false;
+      }
+      bytes += chunk;
+      remaining -= chunk;
+    }
+    pa_threaded_mainloop_unlock(mainloop);
+    return true;
+  }
+
+  bool drain(std::string& error) override {
+    pa_threaded_mainloop_lock(mainloop);
+    if (corked) cork(false);  // A corked stream never drains
+    bool ok = runOperation(pa_stream_drain(stream, successCallback, this));
+    if (!ok) error = pa_strerror(pa_context_errno(context));
+    pa_threaded_mainloop_unlock(mainloop);
+    return ok;
+  }
+
+  // Not waited for: later writes queue behind the flush on the server
+  void flush() override {
+    pa_threaded_mainloop_lock(mainloop);
+    pa_operation* op = pa_stream_flush(stream, NULL, NULL);
+    if (op) pa_operation_unref(op);
+    pa_threaded_mainloop_unlock(mainloop);
+  }
+
+  void setPaused(bool paused) override {
+    pa_threaded_mainloop_lock(mainloop);
+    if (paused != corked) cork(paused);
+    pa_threaded_mainloop_unlock(mainloop);
+  }
+
+  // Interpolated from the server's timing updates; no round trip
+  int64_t latencyUs() override {
+    pa_usec_t latency = 0;
+    int negative = 0;
+    pa_threaded_mainloop_lock(mainloop);
+    int result = pa_stream_get_latency(stream, &latency, &negative);
+    pa_threaded_mainloop_unlock(mainloop);
+    if (result < 0) return -1;  // No timing information yet
+    return negative ? 0 : static_cast<int64_t>(latency);
+  }
+
+private:
+  // Connects the context, then the playback stream, waiting for each to
+  // become ready. Called with the mainloop lock held.
+  bool connect(long rate, int channels, std::string& error) {
+    if (pa_context_connect(context, NULL, PA_CONTEXT_NOFLAGS, NULL) < 0 ||
+        pa_threaded_mainloop_start(mainloop) < 0) {
+      error = pa_strerror(pa_context_errno(context));
+      return false;
+    }
+    while (true) {
+      pa_context_state_t state = pa_context_get_state(context);
+      if (state == PA_CONTEXT_READY) break;
+      if (!PA_CONTEXT_IS_GOOD(state)) {
+        error = pa_strerror(pa_context_errno(context));
+        return false;
+      }
+      pa_threaded_mainloop_wait(mainloop);
+    }
+
+    pa_sample_spec sample_spec;
+    sample_spec.format = PA_SAMPLE_S16LE;  // The gain stage produces S16LE
+    sample_spec.rate = static_cast<uint32_t>(rate);
+    sample_spec.channels = static_cast<uint8_t>(channels);
+
+    stream = pa_stream_new(context, "Music", &sample_spec, NULL);
+    if (!stream) {
+      error = pa_strerror(pa_context_errno(context));
+      return false;
+    }
+    pa_stream_set_state_callback(stream, streamStateCallback, this);
+    pa_stream_set_write_callback(stream, writeCallback, this);
+
+    // tlength is the latency target; ADJUST_LATENCY makes the server size
+    // its own buffers to it instead of adding them on top
+    pa_buffer_attr attr;
+    attr.maxlength = static_cast<uint32_t>(-1);  // Server defaults
+    attr.prebuf = static_cast<uint32_t>(-1);
+    attr.fragsize = static_cast<uint32_t>(-1);
+    attr.tlength = static_cast<uint32_t>(pa_usec_to_bytes(
+        config.targetLatencyMs * PA_USEC_PER_MSEC, &sample_spec));
+    attr.minreq = static_cast<uint32_t>(pa_usec_to_bytes(
+        config.minRequestMs * PA_USEC_PER_MSEC, &sample_spec));
+    pa_stream_flags_t flags = static_cast<pa_stream_flags_t>(
+        PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING |
+        PA_STREAM_AUTO_TIMING_UPDATE);
+
+    if (pa_stream_connect_playback(stream, NULL, &attr, flags, NULL, NULL) <
+        0) {
+      error = pa_strerror(pa_context_errno(context));
+      return false;
+    }
+    while (true) {
+      pa_stream_state_t state = pa_stream_get_state(stream);
+      if (state == PA_STREAM_READY) break;
+      if (!PA_STREAM_IS_GOOD(state)) {
+        error = pa_strerror(pa_context_errno(context));
+        return false;
+      }
+      pa_threaded_mainloop_wait(mainloop);
+    }
+    return true;
+  }
+
+  bool streamGood() const {
+    return PA_CONTEXT_IS_GOOD(pa_context_get_state(context)) &&
+           PA_STREAM_IS_GOOD(pa_stream_get_state(stream));
+  }
+
+  // Corks or uncorks and waits for the server to confirm (lock held)
+  void cork(bool paused) {
+    if (runOperation(pa_stream_cork(stream, paused ? 1 : 0, successCallback,
+                                    this))) {
+      corked = paused;
+    }
+  }
+
+  // Waits for 'op' to complete (lock held). Returns false if it could not
+  // be started or the server reported failure.
+  bool runOperation(pa_operation* op) {
+    if (!op) return false;
+    operationSucceeded = false;
+    while (pa_operation_get_state(op) == PA_OPERATION_RUNNING) {
+      pa_threaded_mainloop_wait(mainloop);
+    }
+    pa_operation_unref(op);
+    return operationSucceeded;
+  }
+
+  // --- Mainloop callbacks (run on the mainloop thread, lock held) ---
+
+  static void contextStateCallback(pa_context* /*context*/, void* userdata) {
+    PulseAsyncOutput* self = static_cast<PulseAsyncOutput*>(userdata);
+    pa_threaded_mainloop_signal(self->mainloop, 0);
+  }
+
+  static void streamStateCallback(pa_stream* /*stream*/, void* userdata) {
+    PulseAsyncOutput* self = static_cast<PulseAsyncOutput*>(userdata);
+    pa_threaded_mainloop_signal(self->mainloop, 0);
+  }
+
+  static void writeCallback(pa_stream* /*stream*/, size_t /*nbytes*/,
+                            void* userdata) {
+    PulseAsyncOutput* self = static_cast<PulseAsyncOutput*>(userdata);
+    pa_threaded_mainloop_signal(self->mainloop, 0);
+  }
+
+  static void successCallback(pa_stream* /*stream*/, int success,
+                              void* userdata) {
+    PulseAsyncOutput* self = static_cast<PulseAsyncOutput*>(userdata);
+    self->operationSucceeded = success != 0;
+    pa_threaded_mainloop_signal(self->mainloop, 0);
+  }
+
+  OutputConfig config;
+  pa_threaded_mainloop* mainloop;
+  pa_context* context;
+  pa_stream* stream;
+  bool corked;              // Stream is paused on the server
+  bool operationSucceeded;  // Result of the last waited-for operation
+};
+
+std::unique_ptr<AudioOutput> makePulseAsyncOutput(const OutputConfig& config) {
+  return std::make_unique<PulseAsyncOutput>(config);
+}
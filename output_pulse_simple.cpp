@@ -0,0 +1,85 @@
+#include "output.h"
+
+// Required for PulseAudio output
+#include <pulse/pulseaudio.h>
+#include <pulse/simple.h>
+
+// --- pa_simple Backend ---
+// The blocking simple API. It has no cork, so pausing only stops writes
+// and the server plays out what it already holds. The latency targets
+// are still passed as buffer attributes.
+class PulseSimpleOutput : public AudioOutput {
+public:
+  explicit PulseSimpleOutput(const OutputConfig& config)
+      : config(config), stream(nullptr) {}
+  ~PulseSimpleOutput() override {
+    if (stream) pa_simple_free(stream);
+  }
+
+  const char* name() const override { return "pulse-simple"; }
+
+  bool open(long rate, int channels, std::string& error) override {
+    pa_sample_spec sample_spec;
+    sample_spec.format = PA_SAMPLE_S16LE;  // The gain stage produces S16LE
+    sample_spec.rate = static_cast<uint32_t>(rate);
+    sample_spec.channels = static_cast<uint8_t>(channels);
+
+    pa_buffer_attr attr;
+    attr.maxlength = static_cast<uint32_t>(-1);  // Server defaults
+    attr.prebuf = static_cast<uint32_t>(-1);
+    attr.fragsize = static_cast<uint32_t>(-1);
+    attr.tlength = static_cast<uint32_t>(pa_usec_to_bytes(
+        config.targetLatencyMs * PA_USEC_PER_MSEC, &sample_spec));
+    attr.minreq = static_cast<uint32_t>(pa_usec_to_bytes(
+        config.minRequestMs * PA_USEC_PER_MSEC, &sample_spec));
+
+    int pa_error_code = 0;
+    stream = pa_simple_new(NULL, "Audio Playlist App", PA_STREAM_PLAYBACK, NULL,
+                           "Music", &sample_spec, NULL, &attr, &pa_error_code);
+    if (!stream) {
+      error = pa_strerror(pa_error_code);
+      return false;
+    }
+    return true;
+  }
+
+  bool write(const short* data, size_t samples, std::string& error) override {
+    int pa_error_code = 0;
+    if (pa_simple_write(stream, data, samples * sizeof(short),
+                        &pa_error_code) < 0) {
+      error = pa_strerror(pa_error_code);
+      return false;
+    }
+    return true;
+  }
+
+  bool drain(std::string& error) override {
+    int pa_error_code = 0;
+    if (pa_simple_drain(stream, &pa_error_code) < 0) {
+      error = pa_strerror(pa_error_code);
+      return false;
+    }
+    return true;
+  }
+
+  // pa_simple locks its own mainloop, so this is safe during write()
+  void flush() override {
+    int pa_error_code = 0;
+    pa_simple_flush(stream, &pa_error_code);
+  }
+
+  int64_t latencyUs() override {
+    int pa_error_code = 0;
+    pa_usec_t latency = pa_simple_get_latency(stream, &pa_error_code);
+    if (latency == static_cast<pa_usec_t>(-1)) return -1;
+    return static_cast<int64_t>(latency);
+  }
+
+private:
+  OutputConfig config;
+  pa_simple* stream;
+};
+
+std::unique_ptr<AudioOutput> makePulseSimpleOutput(const OutputConfig& config) {
+  return std::make_unique<PulseSimpleOutput>(config);
+}
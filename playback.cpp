@@ -0,0 +1,974 @@
+#include "playback.h"
+
+// Required for terminal raw mode, polling stdin and waking the UI thread
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "decoder.h"  // Decoder backends, chosen per file
+#include "dsp.h"      // GainStage: gain, dither and S16 conversion
+#include "output.h"   // AudioOutput: where the S16 blocks go
+#include "session.h"  // Shared mpg123 init, cached outputs, volume
+#include "spsc_ring.h"  // Lock-free PCM ring between decoder and output
+#include "stats.h"      // Stage timers and counters
+
+// Samples held in each track's ring buffer (~3 seconds of 44.1 kHz stereo)
+#define PREFETCH_BUFFER_SAMPLES (1 << 18)
+// Samples written to the output per block
+#define OUTPUT_BLOCK_SAMPLES 4096
+// Volume change per key press
+#define VOLUME_STEP_DB 2.0
+// Longest the decoder thread sleeps before re-checking ring space it may not
+// have been told about
+#define DECODER_RECHECK_MS 50
+// Shortest time between two progress bar redraws
+#define PROGRESS_REDRAW_MS 250
+// How long the output thread waits for the decoder during an underrun
+#define UNDERRUN_WAIT_MS 5
+
+// --- Prepared Track ---
+// One queued track: its decoder plus the PCM ring the decoder thread fills
+// and the output thread drains without locking. 'opened', 'failed', 'busy'
+// and 'error' are guarded by PlaybackEngine::mtx; the rest are atomics. The
+// decoder is only touched by whichever thread owns the track (the opener,
+// then the decoder thread); once 'opened' is set its info() is fixed and
+// may be read anywhere.
+struct PreparedTrack {
+  node* item;  // Playlist node being played
+  int index;   // 0-based position in the queue
+  std::unique_ptr<Decoder> decoder;  // Set by the opener on success
+  std::future<void> opening;         // Pending asynchronous open
+
+  SpscRing<float> ring;  // Interleaved PCM, decoder thread -> output thread
+
+  bool opened;        // Decoder is ready and 'ring' is allocated
+  bool failed;        // Track could not be opened
+  bool busy;          // Decoder thread is using it with 'mtx' released
+  std::string error;  // Reason for 'failed' or a mid-stream decode error
+  std::atomic<bool> finished;  // Decoder wrote its last sample (or failed)
+
+  std::atomic<off_t> position;    // Frames handed to the output so far
+  std::atomic<off_t> totalFrames;  // Length; the decoder may refine it
+  std::atomic<off_t> seekTarget;  // Seek requested by the UI thread (-1 none)
+  // Published by the decoder after each seek: samples in the ring before
+  // 'seekMark' (a ring.written() value) predate it and are skipped by the
+  // output, which then resumes counting from 'seekFrame'
+  std::atomic<uint64_t> seekEpoch;
+  std::atomic<uint64_t> seekMark;
+  std::atomic<off_t> seekFrame;
+
+  StatClock::time_point queuedAt;  // Taken from the provider
+
+  PreparedTrack(node* n, int i)
+      : item(n),
+        index(i),
+        opened(false),
+        failed(false),
+        busy(false),
+        finished(false),
+        position(0),
+        totalFrames(-1),
+        seekTarget(-1),
+        seekEpoch(0),
+        seekMark(0),
+        seekFrame(0),
+        queuedAt(statNow()) {}
+};
+
+// --- Terminal Helpers ---
+
+// Puts stdin into non-canonical, non-blocking mode for key controls and
+// restores the previous settings on leave() or destruction.
+struct RawTerminal {
+  struct termios old_tio;
+  int old_flags;
+  bool active = false;
+
+  void enter() {
+    if (active) return;
+    struct termios new_tio;
+    tcgetattr(STDIN_FILENO, &old_tio);
+    new_tio = old_tio;
+    new_tio.c_lflag &= ~(ICANON | ECHO);  // Disable canonical mode and echo
+    tcsetattr(STDIN_FILENO, TCSANOW, &new_tio);
+
+    old_flags = fcntl(STDIN_FILENO, F_GETFL);
+    fcntl(STDIN_FILENO, F_SETFL, old_flags | O_NONBLOCK);
+    active = true;
+  }
+
+  void leave() {
+    if (!active) return;
+    tcsetattr(STDIN_FILENO, TCSANOW, &old_tio);  // Restore terminal settings
+    fcntl(STDIN_FILENO, F_SETFL, old_flags);     // Restore flags
+    active = false;
+  }
+
+  ~RawTerminal() { leave(); }
+};
+
+// Progress line for the audible track, or "" if what is on screen is still
+// current. With a known length the bar changes with the whole percentage;
+// otherwise the elapsed time is shown, changing once a second. 'last' holds
+// the value drawn last time (-1 forces a redraw).
+static std::string renderProgress(off_t position, off_t total, long rate,
+                                  int& last) {
+  std::string line;
+  if (total > 0) {
+    double fraction_complete = static_cast<double>(position) / total;
+    int percent = static_cast<int>(fraction_complete * 100.0);
+    percent = std::min(100, std::max(0, percent));
+    if (percent == last) return line;
+    last = percent;
+
+    int progress_bar_width = 25;
+    int pos = static_cast<int>(fraction_complete * progress_bar_width);
+    pos = std::min(progress_bar_width, std::max(0, pos));
+
+    line = "\r\t\tProgress: [";
+    for (int i = 0; i < progress_bar_width; ++i) {
+      line += (i < pos ? "■" : " ");
+    }
+    line += "] " + std::to_string(percent) + "% ";
+  } else {
+    int elapsed = rate > 0 ? static_cast<int>(position / rate) : 0;
+    if (elapsed == last) return line;
+    last = elapsed;
+
+    char clock[32];
+    std::snprintf(clock, sizeof(clock), "%d:%02d", elapsed / 60, elapsed % 60);
+    line = std::string("\r\t\tPlaying... ") + clock + " (duration unknown) ";
+  }
+  return line;
+}
+
+// Caches a track's length in the catalog for later listings
+static void recordDuration(const PreparedTrack& track, off_t totalFrames) {
+  long rate = track.decoder->info().rate;
+  if (rate > 0 && totalFrames > 0) {
+    TrackCatalog::instance().setDuration(
+        track.item->trackId, static_cast<int>(totalFrames * 1000 / rate));
+  }
+}
+
+// The "Now playing" banner for a track that is about to start
+static std::string nowPlayingText(const PreparedTrack& track,
+                                  AudioOutput& output) {
+  std::ostringstream out;
+  std::string displayName = track.item->track().cleanName;
+  out << "\t\t" << "▶️ Now playing: " << displayName << std::endl;
+
+  const StreamInfo& dec = track.decoder->info();
+  const off_t total = track.totalFrames;
+  double total_seconds = (dec.rate > 0 && total > 0)
+                             ? static_cast<double>(total) / dec.rate
+                             : 0.0;
+  if (total_seconds > 0) {
+    int minutes = static_cast<int>(total_seconds) / 60;
+    double seconds_part = total_seconds - minutes * 60;
+    out << "\t\t" << "   Duration: " << minutes << ":" << std::fixed
+        << std::setprecision(1) << std::setfill('0') << std::setw(4)
+        << seconds_part << std::setfill(' ') << std::endl;
+  }
+  if (dec.replayGain.found) {
+    out << "\t\t" << "   ReplayGain: " << std::showpos << std::fixed
+        << std::setprecision(1) << dec.replayGain.gainDb
+        << std::noshowpos << " dB" << std::endl;
+  }
+  out << "\t\t" << "   Output: " << output.name();
+  int64_t latency = output.latencyUs();
+  if (latency >= 0) out << ", " << latency / 1000 << " ms latency";
+  out << std::endl;
+  out << "\t\t"
+      << "   Controls: [Space] Play/Pause, [s] Stop, [j] -10s, [k] +10s,"
+      << " [-/+] Volume" << std::endl;
+  out << "\t\t" << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+      << std::endl;
+  return out.str();
+}
+
+// --- PlaybackEngine Implementation ---
+
+PlaybackEngine::PlaybackEngine(bool interactive)
+    : interactive(interactive),
+      providerDone(false),
+      shutdown(false),
+      queued(0),
+      queueAudible(false),
+      audible(nullptr),
+      audibleOutput(nullptr),
+      progressPercent(-1),
+      tasksRunning(false),
+      uiWakeFd(-1),
+      uiShutdown(false),
+      paused(false),
+      stopRequested(false),
+      flushRequested(false),
+      underruns(0),
+      samplesPlayed(0),
+      bufferedSamples(0),
+      bufferCapacity(0),
+      lowestBuffered(SIZE_MAX),
+      outputLatencyUs(-1) {}
+
+PlaybackEngine::~PlaybackEngine() {
+  stopDecoder();
+}
+
+PlaybackStats PlaybackEngine::stats() const {
+  PlaybackStats result;
+  result.underruns = underruns.load();
+  result.samplesPlayed = samplesPlayed.load();
+  result.bufferedSamples = bufferedSamples.load();
+  result.bufferCapacity = bufferCapacity.load();
+  size_t lowest = lowestBuffered.load();
+  result.lowestBuffered = lowest == SIZE_MAX ? 0 : lowest;
+  result.outputLatencyUs = outputLatencyUs.load();
+  return result;
+}
+
+// Asks the decoder thread to exit and drops every queued track.
+// Tracks are destroyed without holding 'mtx' because a pending open still
+// needs the lock to publish its result.
+void PlaybackEngine::stopDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    shutdown = true;
+  }
+  cv.notify_all();
+  if (decoderThread.joinable()) decoderThread.join();
+
+  std::deque<std::unique_ptr<PreparedTrack>> leftovers;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    leftovers.swap(queue);
+  }
+  leftovers.clear();
+}
+
+// Takes the next node from the provider and starts opening it on a helper
+// thread, so a slow open never starves the audible track's buffer.
+void PlaybackEngine::prefetchNext(std::unique_lock<std::mutex>& lock) {
+  lock.unlock();
+  node* item = provider();
+  lock.lock();
+
+  if (item == nullptr) {
+    providerDone = true;
+    cv.notify_all();
+    return;
+  }
+
+  queue.push_back(std::make_unique<PreparedTrack>(item, queued++));
+  PreparedTrack* track = queue.back().get();
+  track->opening = std::async(std::launch::async, [this, track]() {
+    std::string error;
+    std::unique_ptr<Decoder> decoder;
+    {
+      ScopedTimer timer(StatTimer::TRACK_OPEN);
+      decoder =
+          DecoderRegistry::instance().open(track->item->track().path, error);
+    }
+
+    std::lock_guard<std::mutex> guard(mtx);
+    if (decoder) {
+      // Room for at least two of the decoder's blocks
+      const StreamInfo& dec = decoder->info();
+      track->ring.allocate(std::max<size_t>(
+          PREFETCH_BUFFER_SAMPLES, 2 * decoder->preferredBlockSamples()));
+      track->totalFrames = dec.totalFrames;
+      track->decoder = std::move(decoder);
+      track->opened = true;
+      recordDuration(*track, dec.totalFrames);
+    } else {
+      track->failed = true;
+      track->error = error;
+    }
+    cv.notify_all();
+  });
+}
+
+// Decoder thread: services seeks on the audible track, keeps the earliest
+// track with free buffer space topped up, and keeps one track prefetched.
+// Every backend goes through the same steps; one with a zero-copy read
+// hands its own buffer to the ring instead of decoding into 'block'.
+void PlaybackEngine::decodeLoop() {
+  std::vector<float> block;
+  std::unique_lock<std::mutex> lock(mtx);
+
+  while (!shutdown) {
+    // 1. A pending seek on the audible track takes priority
+    if (!queue.empty() && queue.front()->opened &&
+        queue.front()->seekTarget >= 0) {
+      PreparedTrack* current = queue.front().get();
+      off_t target = current->seekTarget;
+      current->busy = true;
+      lock.unlock();
+      bool ok = current->decoder->seek(target);
+      lock.lock();
+      current->busy = false;
+
+      // Everything written so far predates the seek
+      current->seekMark = current->ring.written();
+      current->seekFrame = target;
+      current->finished = !ok;
+      current->seekEpoch++;
+      // A newer request stays pending and is serviced next time round
+      current->seekTarget.compare_exchange_strong(target, -1);
+      cv.notify_all();
+      continue;
+    }
+
+    // 2. Decode into the first queued track that still needs audio
+    PreparedTrack* target = nullptr;
+    for (auto& track : queue) {
+      if (track->opened && !track->finished && track->seekTarget < 0 &&
+          track->ring.space() >=
+              static_cast<size_t>(track->decoder->preferredBlockSamples())) {
+        target = track.get();
+        break;
+      }
+    }
+
+    if (target) {
+      Decoder& decoder = *target->decoder;
+      long blockSamples = decoder.preferredBlockSamples();
+      if (block.size() < static_cast<size_t>(blockSamples)) {
+        block.resize(blockSamples);
+      }
+      target->busy = true;
+      lock.unlock();
+      std::string error;
+      const float* data = block.data();
+      long decoded;
+      {
+        ScopedTimer timer(StatTimer::DECODE_BLOCK);
+        decoded = decoder.supportsDirectRead()
+                      ? decoder.readDirect(data, error)
+                      : decoder.read(block.data(), blockSamples, error);
+      }
+      if (decoded > 0) {
+        if (target->ring.written() == 0) {
+          Stats::instance().record(StatTimer::FIRST_DECODE,
+                                   statNow() - target->queuedAt);
+        }
+        // Only this thread writes, so the space checked above is still free
+        target->ring.write(data, static_cast<size_t>(decoded));
+      }
+      off_t length = decoder.refinedLength();
+      lock.lock();
+      target->busy = false;
+
+      if (decoded <= 0) {
+        if (decoded < 0) target->error = error;
+        target->finished = true;
+      }
+      if (length > 0 && length != target->totalFrames) {
+        target->totalFrames = length;  // Progress bar and seeks follow it
+        recordDuration(*target, length);
+      }
+      cv.notify_all();
+      continue;
+    }
+
+    // 3. Keep one track queued behind the audible one
+    if (!providerDone && queue.size() < 2) {
+      prefetchNext(lock);
+      continue;
+    }
+
+    // The output frees ring space without the lock, so a wake-up can be
+    // missed; the timeout bounds how late the refill starts
+    // While paused nothing drains, so sleep until a key changes that
+    if (paused) {
+      cv.wait(lock);
+    } else {
+      cv.wait_for(lock, std::chrono::milliseconds(DECODER_RECHECK_MS));
+    }
+  }
+}
+
+// Streams one opened track to 'output'. Only PCM work happens here: keys
+// and the progress bar are on the UI thread.
+// Returns 0 when the track ended, 1 on an output error, 2 if stopped.
+int PlaybackEngine::playTrack(PreparedTrack* track, AudioOutput* output) {
+  const StreamInfo& info = track->decoder->info();
+  const int channels = info.channels;
+
+  std::vector<float> buffer(OUTPUT_BLOCK_SAMPLES -
+                            OUTPUT_BLOCK_SAMPLES % channels);
+  std::vector<short> pcm(buffer.size());  // 'buffer' after the gain stage
+  std::string error;
+  uint64_t seenSeekEpoch = 0;
+  bool starving = false;  // Inside an underrun already counted
+  bufferCapacity = track->ring.capacity();
+  const StatClock::time_point audibleAt = statNow();
+  bool firstWrite = true;
+
+  // Gain is the session volume times the track's ReplayGain; it is rebuilt
+  // whenever the volume changes
+  AudioSession& session = AudioSession::instance();
+  GainStage stage;
+  double stageVolumeDb = 0.0;
+  bool stageReady = false;
+
+  // Sleeps until the decoder makes progress or 'ms' pass
+  auto waitForDecoder = [this](int ms) {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait_for(lock, std::chrono::milliseconds(ms));
+  };
+
+  while (true) {
+    if (stopRequested) {
+      output->flush();
+      setAudible(nullptr, nullptr);
+      return 2;
+    }
+    if (flushRequested.exchange(false)) {
+      // The UI flushed already; this drops a block written since then
+      output->flush();
+    }
+    if (paused) {  // Blocks until a key resumes or stops playback
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [this]() { return !paused || stopRequested; });
+      continue;
+    }
+    if (track->seekTarget >= 0) {
+      waitForDecoder(UNDERRUN_WAIT_MS);
+      continue;
+    }
+
+    uint64_t epoch = track->seekEpoch;
+    if (epoch != seenSeekEpoch) {  // A seek finished: skip what preceded it
+      track->ring.discardUntil(track->seekMark);
+      track->position = track->seekFrame.load();
+      seenSeekEpoch = epoch;
+    }
+
+    size_t samples = track->ring.read(buffer.data(), buffer.size());
+    if (samples == 0) {
+      // 'finished' is set after the last write, so re-check the ring
+      if (track->finished && track->ring.empty()) break;
+      if (!starving) {
+        underruns++;
+        Stats::instance().add(StatCounter::UNDERRUNS);
+        starving = true;
+      }
+      waitForDecoder(UNDERRUN_WAIT_MS);
+      continue;
+    }
+    starving = false;
+    cv.notify_all();  // Decoder may refill the freed space
+
+    size_t fill = track->ring.size();
+    bufferedSamples = fill;
+    if (fill < lowestBuffered) lowestBuffered = fill;  // Only this thread
+
+    double volume = session.volumeDb();
+    if (!stageReady || volume != stageVolumeDb) {
+      float gain = dbToGain(volume) * info.replayGain.linearGain();
+      stage.setGain(gain, gain != 1.0f || !info.pcm16);
+      stageVolumeDb = volume;
+      stageReady = true;
+    }
+    stage.process(buffer.data(), pcm.data(), samples);
+
+    bool written;
+    {
+      ScopedTimer timer(StatTimer::WRITE_BLOCK);
+      written = output->write(pcm.data(), samples, error);
+    }
+    if (!written) {
+      setAudible(nullptr, nullptr);
+      postMessage("\n\t\tError: Audio output write error: " + error + "\n",
+                  true);
+      return 1;
+    }
+    if (firstWrite) {
+      StatClock::time_point now = statNow();
+      Stats::instance().record(StatTimer::FIRST_WRITE, now - audibleAt);
+      if (!queueAudible) {
+        Stats::instance().record(StatTimer::PLAY_TO_FIRST_WRITE,
+                                 now - playStartedAt);
+        queueAudible = true;
+      }
+      firstWrite = false;
+    }
+    int64_t latency = output->latencyUs();
+    outputLatencyUs = latency;
+    if (latency >= 0) {
+      Stats::instance().record(StatTimer::OUTPUT_LATENCY,
+                               std::chrono::microseconds(latency));
+    }
+    Stats::instance().add(StatCounter::SAMPLES_WRITTEN, samples);
+    track->position += static_cast<off_t>(samples / channels);
+    samplesPlayed += samples;
+  }
+
+  setAudible(nullptr, nullptr);
+  if (interactive) postMessage("\n");  // Final newline after progress
+  return 0;
+}
+
+void PlaybackEngine::setAudible(PreparedTrack* track, AudioOutput* output) {
+  std::lock_guard<std::mutex> lock(audibleMtx);  // Never held across I/O
+  audible = track;
+  audibleOutput = output;
+  progressPercent = -1;  // Redraw the bar from scratch
+  lastDraw = StatClock::time_point();
+  wakeUi();
+}
+
+void PlaybackEngine::postConsole(std::function<void()> task) {
+  if (!interactive) {  // No UI thread: run it here
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(taskMtx);
+    consoleTasks.push_back(std::move(task));
+  }
+  wakeUi();
+}
+
+void PlaybackEngine::postMessage(const std::string& text, bool toStderr) {
+  postConsole([text, toStderr]() {
+    (toStderr ? std::cerr : std::cout) << text << std::flush;
+  });
+}
+
+void PlaybackEngine::drainConsole() {
+  std::unique_lock<std::mutex> lock(taskMtx);
+  taskCv.wait(lock, [this]() { return consoleTasks.empty() && !tasksRunning; });
+}
+
+void PlaybackEngine::runConsoleTasks() {
+  std::deque<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(taskMtx);
+    if (consoleTasks.empty()) return;
+    tasks.swap(consoleTasks);
+    tasksRunning = true;
+  }
+  {
+    std::lock_guard<std::mutex> console(consoleMtx);
+    for (auto& task : tasks) task();
+  }
+  {
+    std::lock_guard<std::mutex> lock(taskMtx);
+    tasksRunning = false;
+  }
+  taskCv.notify_all();
+}
+
+// UI thread: one poll() loop over stdin, the wake-up eventfd and the
+// progress redraw deadline. It prints what the output thread posted, acts
+// on keys and redraws the bar of whichever track is audible. With nothing
+// to redraw (paused, or between tracks) it blocks until a key or a wake-up
+// arrives. The track is only looked at under audibleMtx; text is written
+// after releasing it, so a terminal that blocks never holds up the output
+// thread.
+void PlaybackEngine::inputLoop() {
+  bool inputOpen = true;  // stdin has not reached end of file
+  while (!uiShutdown) {
+    runConsoleTasks();
+
+    bool active = false;
+    int timeoutMs = -1;  // Until a key or a wake-up
+    std::string text;    // Progress line, printed unlocked
+    {
+      std::lock_guard<std::mutex> lock(audibleMtx);
+      active = audible != nullptr;
+      if (active && !paused) {
+        // Posted lines go first; the bar is redrawn after them
+        StatClock::time_point now = StatClock::now();
+        auto due = lastDraw + std::chrono::milliseconds(PROGRESS_REDRAW_MS);
+        if (consolePending()) {
+          timeoutMs = 0;
+        } else if (now >= due) {
+          text = renderProgress(audible->position, audible->totalFrames,
+                                audible->decoder->info().rate,
+                                progressPercent);
+          lastDraw = now;
+          timeoutMs = PROGRESS_REDRAW_MS;
+        } else {
+          timeoutMs = static_cast<int>(
+              std::chrono::duration_cast<std::chrono::milliseconds>(due - now)
+                  .count()) +
+              1;
+        }
+      }
+    }
+    if (!text.empty()) {
+      std::lock_guard<std::mutex> console(consoleMtx);
+      std::cout << text << std::flush;
+    }
+
+    // Keys are only read while a track is audible: otherwise stdin belongs
+    // to the menu and the onTrackError prompt
+    struct pollfd fds[2];
+    fds[0].fd = uiWakeFd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = STDIN_FILENO;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    nfds_t count = (active && inputOpen) ? 2 : 1;
+    if (poll(fds, count, timeoutMs) <= 0) continue;  // Redraw due (or EINTR)
+
+    if (fds[0].revents & POLLIN) {
+      uint64_t wakeups;
+      if (read(uiWakeFd, &wakeups, sizeof(wakeups)) < 0) {
+        // Nothing to do: the counter was already reset
+      }
+    }
+    if (count == 2 && (fds[1].revents & (POLLIN | POLLHUP))) {
+      // The terminal is raw and non-blocking already, so a key costs one
+      // read(); any more waiting come back on the next poll()
+      char key = 0;
+      ssize_t got = read(STDIN_FILENO, &key, 1);
+      if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+        inputOpen = false;  // End of input: stop polling it
+      } else if (got == 1) {
+        std::string feedback;
+        {
+          std::lock_guard<std::mutex> lock(audibleMtx);
+          if (audible) feedback = handleKey(key, audible);
+        }
+        if (!feedback.empty()) {
+          std::lock_guard<std::mutex> console(consoleMtx);
+          std::cout << feedback << std::flush;
+        }
+      }
+    }
+  }
+  runConsoleTasks();  // Whatever was posted last
+}
+
+void PlaybackEngine::wakeUi() {
+  if (uiWakeFd < 0) return;
+  uint64_t one = 1;
+  if (write(uiWakeFd, &one, sizeof(one)) < 0) {
+    // Counter saturated: the UI thread is awake already
+  }
+}
+
+// Taking 'mtx' first means a thread about to wait cannot miss the change
+void PlaybackEngine::notifyEngine() {
+  { std::lock_guard<std::mutex> lock(mtx); }
+  cv.notify_all();
+}
+
+bool PlaybackEngine::consolePending() {
+  std::lock_guard<std::mutex> lock(taskMtx);
+  return !consoleTasks.empty();
+}
+
+std::string PlaybackEngine::handleKey(char key, PreparedTrack* track) {
+  AudioSession& session = AudioSession::instance();
+  std::ostringstream out;
+  switch (key) {
+    case ' ':  // Space - Toggle pause/play
+      applyPause(!paused);
+      out << "\r\t\t" << (paused ? "⏸️ Paused " : "▶️ Playing")
+          << "                                  " << std::endl;
+      progressPercent = -1;
+      break;
+    case 's':  // 's' - Stop playback
+    case 'S':
+      applyStop();
+      out << "\r\t\t⏹️ Stopped                                     "
+          << std::endl;
+      out << std::endl;
+      break;
+    case 'j':  // 'j' - Jump back 10 seconds
+    case 'k':  // 'k' - Jump forward 10 seconds
+    {
+      bool back = (key == 'j');
+      const long rate = track->decoder->info().rate;
+      if (!back && track->totalFrames <= 0) break;  // Unknown length
+      applySeek(track->position + (back ? -rate * 10 : rate * 10));
+      out << (back ? "\r\t\t⏪ Jumped back 10s                      "
+                     "         "
+                   : "\r\t\t⏩ Jumped forward 10s                   "
+                     "         ")
+          << std::endl;
+      progressPercent = -1;
+      lastDraw = StatClock::time_point();
+    } break;
+    case '-':  // '-' - Quieter
+    case '_':
+    case '+':  // '+' - Louder ('=' is the same key unshifted)
+    case '=': {
+      bool louder = (key == '+' || key == '=');
+      double volume = session.setVolumeDb(
+          session.volumeDb() + (louder ? VOLUME_STEP_DB : -VOLUME_STEP_DB));
+      out << "\r\t\t🔊 Volume: " << std::showpos << std::fixed
+          << std::setprecision(0) << volume << std::noshowpos
+          << " dB                                  " << std::endl;
+      progressPercent = -1;
+      lastDraw = StatClock::time_point();
+    } break;
+  }
+  return out.str();
+}
+
+void PlaybackEngine::applyPause(bool pause) {
+  paused = pause;
+  if (audibleOutput) audibleOutput->setPaused(pause);  // Corks if supported
+  notifyEngine();
+}
+
+void PlaybackEngine::applyStop() {
+  stopRequested = true;
+  if (audibleOutput) {
+    audibleOutput->flush();  // Silence now, not after the buffer drains
+    if (paused) audibleOutput->setPaused(false);  // Leave it uncorked
+  }
+  paused = false;
+  notifyEngine();
+}
+
+void PlaybackEngine::applySeek(off_t target) {
+  const off_t total = audible->totalFrames;
+  if (target < 0) target = 0;
+  if (total > 0 && target >= total) target = total - 1;
+  audible->position = target;  // Progress bar moves at once
+  audible->seekTarget = target;
+  audibleOutput->flush();
+  flushRequested = true;
+  notifyEngine();
+}
+
+void PlaybackEngine::setPaused(bool pause) {
+  std::lock_guard<std::mutex> lock(audibleMtx);
+  applyPause(pause);
+}
+
+void PlaybackEngine::stop() {
+  std::lock_guard<std::mutex> lock(audibleMtx);
+  applyStop();
+}
+
+bool PlaybackEngine::seek(double seconds, bool relative) {
+  std::lock_guard<std::mutex> lock(audibleMtx);
+  if (audible == nullptr) return false;
+  const long rate = audible->decoder->info().rate;
+  off_t target = static_cast<off_t>(seconds * rate);
+  if (relative) target += audible->position;
+  if (target > 0 && audible->totalFrames <= 0) return false;  // No length
+  applySeek(target);
+  return true;
+}
+
+bool PlaybackEngine::nowPlaying(NowPlaying& info) {
+  std::lock_guard<std::mutex> lock(audibleMtx);
+  if (audible == nullptr) return false;
+  const long rate = audible->decoder->info().rate;
+  const off_t total = audible->totalFrames;
+  info.track = audible->item;
+  info.index = audible->index;
+  info.positionSeconds =
+      rate > 0 ? static_cast<double>(audible->position) / rate : 0;
+  info.lengthSeconds =
+      (rate > 0 && total > 0) ? static_cast<double>(total) / rate : -1;
+  info.paused = paused;
+  return true;
+}
+
+void PlaybackEngine::postTrackStart(const PlaybackHooks& hooks,
+                                    const PreparedTrack* track) {
+  if (!hooks.onTrackStart) return;
+  const node* item = track->item;
+  const int index = track->index;
+  postConsole([&hooks, item, index]() { hooks.onTrackStart(item, index); });
+}
+
+int PlaybackEngine::play(TrackProvider next, const PlaybackHooks& hooks) {
+  AudioSession& session = AudioSession::instance();
+
+  playStartedAt = statNow();
+  queueAudible = false;
+  provider = std::move(next);
+  providerDone = false;
+  shutdown = false;
+  queued = 0;
+  paused = false;
+  stopRequested = false;
+  flushRequested = false;
+  underruns = 0;
+  samplesPlayed = 0;
+  bufferedSamples = 0;
+  bufferCapacity = 0;
+  lowestBuffered = SIZE_MAX;
+  outputLatencyUs = -1;
+  decoderThread = std::thread(&PlaybackEngine::decodeLoop, this);
+
+  RawTerminal terminal;
+  uiShutdown = false;
+  if (interactive) {
+    terminal.enter();
+    uiWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    uiThread = std::thread(&PlaybackEngine::inputLoop, this);
+  }
+
+  // Session output in use; switched only when the sample spec changes
+  AudioOutput* output = nullptr;
+  long outputRate = 0;
+  int outputChannels = 0;
+  std::string outputError;
+
+  bool anyError = false;
+  bool userStopped = false;
+  bool outputFailed = false;
+
+  // While the UI thread runs, everything this thread prints is posted to
+  // it, so writing to a slow terminal never delays the next block
+  while (true) {
+    PreparedTrack* current = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [this]() {
+        return queue.empty() ? providerDone
+                             : (queue.front()->opened || queue.front()->failed);
+      });
+      if (queue.empty()) break;  // Queue exhausted
+      current = queue.front().get();
+    }
+
+    int result = 0;
+    TrackReport report;
+    if (!current->failed) {
+      const StreamInfo& dec = current->decoder->info();
+      if (!output || dec.rate != outputRate || dec.channels != outputChannels) {
+        if (output) {
+          // Let the previous track finish before another output takes over
+          output->drain(outputError);
+        }
+        output = session.acquireOutput(dec.rate, dec.channels, outputError);
+        if (!output) {
+          postMessage("\t\tError: Cannot open audio output: " + outputError +
+                          "\n",
+                      true);
+          outputFailed = true;
+          break;
+        }
+        outputRate = dec.rate;
+        outputChannels = dec.channels;
+      }
+
+      postTrackStart(hooks, current);
+      if (interactive) postMessage(nowPlayingText(*current, *output));
+      setAudible(current, output);
+
+      const uint64_t samplesBefore = samplesPlayed;
+      auto started = std::chrono::steady_clock::now();
+      result = playTrack(current, output);
+      report.wallSeconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+      report.decoder = current->decoder->name();
+      report.rate = dec.rate;
+      report.channels = dec.channels;
+      report.frames = (samplesPlayed - samplesBefore) / dec.channels;
+    } else {
+      postTrackStart(hooks, current);
+    }
+
+    if (result == 1) {
+      if (hooks.onTrackEnd) {
+        report.error = "Audio output write error";
+        hooks.onTrackEnd(current->item, report);
+      }
+      outputFailed = true;
+      break;
+    }
+    if (result == 2) {
+      if (interactive) postMessage("\t\t⏹️ Playback stopped by user.\n");
+      userStopped = true;
+      break;
+    }
+
+    std::string error;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      error = current->error;
+    }
+    if (hooks.onTrackEnd) {
+      report.error = error;
+      hooks.onTrackEnd(current->item, report);
+    }
+    Stats::instance().add(error.empty() ? StatCounter::TRACKS_PLAYED
+                                        : StatCounter::TRACKS_FAILED);
+    if (!error.empty()) {
+      postMessage("\t\tError: " + error + "\n", true);
+      anyError = true;
+      if (hooks.onTrackError) {
+        // The hook prompts on std::cin: let the UI thread print everything
+        // first, then keep it off the console until the answer is in
+        drainConsole();
+        bool keepGoing;
+        {
+          std::lock_guard<std::mutex> console(consoleMtx);
+          terminal.leave();
+          keepGoing = hooks.onTrackError(current->item);
+          if (interactive) terminal.enter();
+        }
+        if (!keepGoing) {
+          userStopped = true;
+          break;
+        }
+      }
+    } else if (interactive) {
+      postMessage("\t\t✓ Playback finished.\n");
+    }
+
+    // Retire the finished track once the decoder thread has let go of it
+    // (a seek may have reached it just as it ended); destroy it unlocked
+    std::unique_ptr<PreparedTrack> done;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [&]() { return !queue.front()->busy; });
+      done = std::move(queue.front());
+      queue.pop_front();
+    }
+    cv.notify_all();
+  }
+
+  if (output) {
+    if (outputFailed) {
+      session.discardOutput(output);
+    } else if (!userStopped && !output->drain(outputError)) {
+      postMessage(
+          "\t\tWarning: Draining the audio output failed: " + outputError +
+              "\n",
+          true);
+    }
+  }
+
+  uiShutdown = true;
+  wakeUi();
+  if (uiThread.joinable()) uiThread.join();  // Prints what is still posted
+  if (uiWakeFd >= 0) {
+    close(uiWakeFd);
+    uiWakeFd = -1;
+  }
+  stopDecoder();
+  terminal.leave();
+
+  if (userStopped) return 2;
+  return (anyError || outputFailed) ? 1 : 0;
+}
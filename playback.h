@@ -0,0 +1,208 @@
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "link.h"   // Needs node definition
+#include "stats.h"  // StatClock for the time-to-sound timers
+
+// --- Gapless Playback Engine ---
+// Plays a queue of playlist nodes through one long-lived output stream.
+// A background decoder thread opens and pre-decodes the next track into its
+// own ring buffer while the current one is still playing, so tracks hand off
+// without reopening the output or sleeping between songs.
+//
+// Three threads share the work: the decoder thread, the output thread (the
+// caller of play(), which only moves PCM to the output stream) and a UI
+// thread that reads keys, draws the progress bar at a fixed low rate and
+// does all console output while play() runs. PCM passes from the decoder
+// to the output through a lock-free single-producer/single-consumer ring
+// per track, and the output thread hands its banners to the UI thread as
+// queued tasks, so neither a slow read, a key press nor a slow terminal
+// holds up output.
+
+// Supplies the next node to play, or nullptr once the queue is exhausted.
+// Called from the decoder thread, one track ahead of what is audible.
+using TrackProvider = std::function<node*()>;
+
+// How one track went, passed to PlaybackHooks::onTrackEnd
+struct TrackReport {
+  std::string decoder;     // Backend that decoded it ("" if it never opened)
+  long rate = 0;           // Sample spec it played at
+  int channels = 0;
+  uint64_t frames = 0;     // Frames written to the output
+  double wallSeconds = 0;  // From becoming audible to its last write
+  std::string error;       // Why it failed; empty if it played to the end
+};
+
+// Optional callbacks that let the playlist modes print their own banners.
+struct PlaybackHooks {
+  // Called on the UI thread as a track becomes audible, in order with the
+  // engine's own banners (on the output thread for a headless engine).
+  // 'index' is the 0-based position of the track in the queue.
+  std::function<void(const node* track, int index)> onTrackStart;
+
+  // Called when a track could not be opened or failed while decoding.
+  // Return true to skip to the next track, false to stop the whole queue.
+  // If unset, the engine moves on and reports an error result at the end.
+  std::function<bool(const node* track)> onTrackError;
+
+  // Called on the output thread once a track is done with (before
+  // onTrackError for a failed one); not called for a track the user stops
+  std::function<void(const node* track, const TrackReport& report)>
+      onTrackEnd;
+};
+
+// Buffer health counters, readable from any thread while play() runs
+struct PlaybackStats {
+  uint64_t underruns = 0;      // Times the output found the buffer empty
+  uint64_t samplesPlayed = 0;  // Samples written to the output stream
+  size_t bufferedSamples = 0;  // Audible track's buffer fill after a read
+  size_t bufferCapacity = 0;   // Size of that buffer
+  size_t lowestBuffered = 0;   // Lowest fill after a read since play() began
+  int64_t outputLatencyUs = -1;  // Output latency after the last write
+};
+
+// The audible track as seen by PlaybackEngine::nowPlaying()
+struct NowPlaying {
+  const node* track = nullptr;
+  int index = 0;              // 0-based position in the queue
+  double positionSeconds = 0;
+  double lengthSeconds = -1;  // -1 while unknown
+  bool paused = false;
+};
+
+struct PreparedTrack;  // Decoder + ring buffer for one queued track
+class AudioOutput;     // Open output stream (output.h)
+
+class PlaybackEngine {
+public:
+  // An interactive engine owns the terminal while it plays: keys, progress
+  // bar and banners. A headless one only runs the pipeline, as fast as the
+  // output accepts samples; errors still go to std::cerr.
+  explicit PlaybackEngine(bool interactive = true);
+  ~PlaybackEngine();
+
+  PlaybackEngine(const PlaybackEngine&) = delete;
+  PlaybackEngine& operator=(const PlaybackEngine&) = delete;
+
+  // Plays every track returned by 'next' (with keyboard controls when
+  // interactive).
+  // Returns 0 when the queue finished, 1 if any track failed, 2 if stopped.
+  int play(TrackProvider next, const PlaybackHooks& hooks = PlaybackHooks());
+
+  // Current counters (reset when play() starts)
+  PlaybackStats stats() const;
+
+  // --- Remote control ---
+  // The actions behind the playback keys, callable from any thread while
+  // play() runs (a headless engine has no keys; see daemon.h).
+  void setPaused(bool pause);
+  bool isPaused() const { return paused; }
+  // Stops the whole queue; play() returns 2
+  void stop();
+  // Seeks the audible track to 'seconds', or by 'seconds' if 'relative'.
+  // Returns false if nothing is audible, or the target is beyond a length
+  // that is not known yet.
+  bool seek(double seconds, bool relative);
+  // Fills 'info' for the audible track; false if none is audible
+  bool nowPlaying(NowPlaying& info);
+
+private:
+  // Decoder thread body: fills the current track first, then prefetches
+  void decodeLoop();
+  // Queues the provider's next node and opens it asynchronously
+  void prefetchNext(std::unique_lock<std::mutex>& lock);
+  // Output side of one track: moves its PCM to the stream until it ends
+  int playTrack(PreparedTrack* track, AudioOutput* output);
+  // Joins the decoder thread and drops all queued tracks
+  void stopDecoder();
+
+  // UI thread body: an event loop over keys, wake-ups and the redraw timer
+  void inputLoop();
+  // Acts on one key press for 'track' (called with audibleMtx held) and
+  // returns the feedback line to print
+  std::string handleKey(char key, PreparedTrack* track);
+  // Shared by the keys and the remote control; called with audibleMtx
+  // held. The output, if any, is corked or flushed at once.
+  void applyPause(bool pause);
+  void applyStop();
+  // Seeks the audible track to frame 'target' (clamped to its length)
+  void applySeek(off_t target);
+  // Gives the UI thread 'track' playing on 'output' to control, or takes it
+  // away (both nullptr)
+  void setAudible(PreparedTrack* track, AudioOutput* output);
+
+  // Queues 'task' to run on the UI thread with the console; a headless
+  // engine runs it at once
+  void postConsole(std::function<void()> task);
+  // Queues 'text' for std::cout (or std::cerr)
+  void postMessage(const std::string& text, bool toStderr = false);
+  // Queues the onTrackStart hook for 'track', if set
+  void postTrackStart(const PlaybackHooks& hooks, const PreparedTrack* track);
+  // Blocks until the UI thread has run every queued task
+  void drainConsole();
+  // UI thread: runs the queued tasks, in order
+  void runConsoleTasks();
+  // True if tasks are queued and not yet run
+  bool consolePending();
+  // Interrupts the UI thread's poll() so it looks at its state again
+  void wakeUi();
+  // Wakes the decoder and output threads after a key changed their state
+  void notifyEngine();
+
+  const bool interactive;
+  TrackProvider provider;
+  std::deque<std::unique_ptr<PreparedTrack>> queue;  // front = audible track
+  bool providerDone;  // provider returned nullptr
+  bool shutdown;      // ask decoder thread to exit
+  int queued;         // number of tracks taken from the provider so far
+  StatClock::time_point playStartedAt;  // When play() was called
+  bool queueAudible;  // First block of this play() written (output thread)
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread decoderThread;
+
+  // --- UI thread state ---
+  // The UI thread reads stdin only while 'audible' is set. audibleMtx
+  // guards the audible track and is never held across console I/O, so the
+  // output thread only waits for it briefly. consoleMtx is held by
+  // whoever writes to the console: the UI thread, or the output thread
+  // while an onTrackError hook prompts.
+  std::thread uiThread;
+  std::mutex audibleMtx;
+  std::mutex consoleMtx;
+  PreparedTrack* audible;  // Track the UI controls, guarded by audibleMtx
+  AudioOutput* audibleOutput;  // Where it plays; flushed and corked by keys
+  int progressPercent;  // Value last drawn (percent, or elapsed seconds)
+  StatClock::time_point lastDraw;  // When the bar was last redrawn
+  std::deque<std::function<void()>> consoleTasks;  // Posted for the UI
+  bool tasksRunning;  // UI thread is running a batch of them
+  std::mutex taskMtx;  // Guards consoleTasks and tasksRunning
+  std::condition_variable taskCv;  // Signalled when a batch has run
+  int uiWakeFd;  // eventfd the UI thread polls with stdin (-1 when idle)
+  std::atomic<bool> uiShutdown;      // Ask the UI thread to exit
+  std::atomic<bool> paused;          // Output holds back while set
+  std::atomic<bool> stopRequested;   // Output stops the queue
+  std::atomic<bool> flushRequested;  // Output drops queued audio (a seek)
+
+  // --- Counters behind stats() ---
+  std::atomic<uint64_t> underruns;
+  std::atomic<uint64_t> samplesPlayed;
+  std::atomic<size_t> bufferedSamples;
+  std::atomic<size_t> bufferCapacity;
+  std::atomic<size_t> lowestBuffered;
+  std::atomic<int64_t> outputLatencyUs;
+};
+
+#endif  // PLAYBACK_H
@@ -0,0 +1,95 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// --- Slab Pool Allocator ---
+// Hands out fixed-size slots for objects of type T from slabs of
+// 'SlabSize' slots. Freed slots go on an intrusive free list and are reused
+// before a new slab is carved, so objects created together stay close in
+// memory and steady-state create/destroy never reaches malloc.
+// Not thread-safe: each pool belongs to a single container.
+template <typename T, size_t SlabSize = 256>
+class Pool {
+public:
+  Pool() : freeList(nullptr), slabUsed(0), slabCapacity(0) {}
+  ~Pool() { release(); }
+
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  // Constructs a T in a free slot and returns it
+  template <typename... Args>
+  T* create(Args&&... args) {
+    Slot* slot = takeSlot();
+    try {
+      return new (slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      giveSlot(slot);  // Constructor threw; the slot is still free
+      throw;
+    }
+  }
+
+  // Destroys an object from this pool and recycles its slot
+  void destroy(T* object) {
+    if (object == nullptr) return;
+    object->~T();
+    giveSlot(reinterpret_cast<Slot*>(object));
+  }
+
+  // Guarantees the next 'count' creates need no further allocation, by
+  // carving one slab of exactly 'count' slots if the current one is short.
+  // Used before bulk loads so a whole playlist lives in a single block.
+  void reserve(size_t count) {
+    if (slabCapacity - slabUsed >= count) return;
+    slabs.emplace_back(new Slot[count]);
+    slabUsed = 0;
+    slabCapacity = count;
+  }
+
+  // Returns every slab to the system in one go. All objects must already
+  // have been destroyed (or be trivially destructible).
+  void release() {
+    slabs.clear();
+    freeList = nullptr;
+    slabUsed = 0;
+    slabCapacity = 0;
+  }
+
+private:
+  // A slot holds either a live T or a link in the free list
+  union Slot {
+    Slot* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  Slot* takeSlot() {
+    if (freeList != nullptr) {  // Reuse the most recently freed slot
+      Slot* slot = freeList;
+      freeList = slot->next;
+      return slot;
+    }
+    if (slabUsed == slabCapacity) {  // Current slab is full: carve a new one
+      slabs.emplace_back(new Slot[SlabSize]);
+      slabUsed = 0;
+      slabCapacity = SlabSize;
+    }
+    return &slabs.back()[slabUsed++];
+  }
+
+  void giveSlot(Slot* slot) {
+    slot->next = freeList;
+    freeList = slot;
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> slabs;
+  Slot* freeList;       // Recycled slots, most recent first
+  size_t slabUsed;      // Slots handed out from slabs.back() so far
+  size_t slabCapacity;  // Size of slabs.back() (SlabSize unless reserved)
+};
+
+#endif  // POOL_H
@@ -0,0 +1,136 @@
+#include "queue.h"
+
+#include <random>
+
+PlayQueue::PlayQueue(const LinkedList& list, PlayOrder order, int rounds,
+                     uint64_t seed)
+    : list(list),
+      order(order),
+      rounds(rounds),
+      length(list.len > 0 ? static_cast<uint32_t>(list.len) : 0),
+      round(0),
+      drawn(0),
+      cursor(nullptr),
+      rngState(seed) {
+  if (list.head != nullptr) {
+    cursor = (order == PlayOrder::REVERSE) ? list.head->prev : list.head;
+  }
+  if (rngState == 0) {
+    std::random_device device;
+    rngState = (static_cast<uint64_t>(device()) << 32) | device();
+    if (rngState == 0) rngState = 88172645463325252ull;  // Never all zero
+  }
+  for (const std::string*& artist : recentArtists) artist = nullptr;
+}
+
+node* PlayQueue::next() {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!inserted.empty()) {
+    node* track = inserted.front();
+    inserted.pop_front();
+    noteArtist(track);
+    return track;
+  }
+  node* track = nextInOrder();
+  if (track) noteArtist(track);
+  return track;
+}
+
+void PlayQueue::playNext(node* track) {
+  std::lock_guard<std::mutex> lock(mtx);
+  inserted.push_front(track);
+}
+
+void PlayQueue::enqueue(node* track) {
+  std::lock_guard<std::mutex> lock(mtx);
+  inserted.push_back(track);
+}
+
+size_t PlayQueue::remaining() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  size_t fromOrder = 0;
+  if (round < rounds) {
+    fromOrder = static_cast<size_t>(rounds - round) * length - drawn;
+  }
+  return inserted.size() + fromOrder;
+}
+
+node* PlayQueue::nextInOrder() {
+  if (length == 0 || round >= rounds) return nullptr;
+
+  node* track;
+  if (order == PlayOrder::SEQUENTIAL || order == PlayOrder::REVERSE) {
+    track = cursor;
+    cursor = (order == PlayOrder::REVERSE) ? cursor->prev : cursor->next;
+  } else {
+    track = list.nodeAt(static_cast<int>(drawShuffled()) + 1);
+  }
+
+  if (++drawn == length) {  // Round complete; the next one starts afresh
+    drawn = 0;
+    round++;
+    swapped.clear();
+  }
+  return track;
+}
+
+uint32_t PlayQueue::slotValue(uint32_t slot) const {
+  auto it = swapped.find(slot);
+  return it == swapped.end() ? slot : it->second;
+}
+
+uint32_t PlayQueue::drawShuffled() {
+  // Step 'drawn' of Fisher-Yates: swap a random slot of [drawn, length)
+  // into slot 'drawn' and hand out what it held. Slot 'drawn' is never
+  // looked at again, so its entry is dropped rather than written.
+  uint32_t pick = drawn + randomBelow(length - drawn);
+  if (order == PlayOrder::ARTIST_SPREAD) {
+    // Redraw a bounded number of times while the pick repeats a recent
+    // artist; a list dominated by one artist just takes the last pick
+    for (int tries = 1; tries < QUEUE_SPREAD_TRIES; ++tries) {
+      if (!artistIsRecent(list.nodeAt(static_cast<int>(slotValue(pick)) + 1)))
+        break;
+      pick = drawn + randomBelow(length - drawn);
+    }
+  }
+
+  uint32_t position = slotValue(pick);
+  if (pick != drawn) swapped[pick] = slotValue(drawn);
+  swapped.erase(drawn);
+  return position;
+}
+
+// Key of the artist listings show for 'n' (a tagged artist stands in for a
+// placeholder), or nullptr while the artist is still unknown
+static const std::string* spreadArtistKey(const node* n) {
+  const Track& track = n->track();
+  const std::string& key = track.shownArtistKey();
+  if (key.empty() || (track.artistUnknown && &key == &track.artistKey)) {
+    return nullptr;
+  }
+  return &key;  // Catalog entries and published tags never move
+}
+
+bool PlayQueue::artistIsRecent(const node* n) const {
+  const std::string* key = spreadArtistKey(n);
+  if (key == nullptr) return false;  // Unknown artists never clash
+  for (const std::string* artist : recentArtists) {
+    if (artist != nullptr && *artist == *key) return true;
+  }
+  return false;
+}
+
+void PlayQueue::noteArtist(const node* n) {
+  for (int i = QUEUE_SPREAD_WINDOW - 1; i > 0; --i) {
+    recentArtists[i] = recentArtists[i - 1];
+  }
+  recentArtists[0] = spreadArtistKey(n);
+}
+
+uint32_t PlayQueue::randomBelow(uint32_t bound) {
+  // xorshift64, then a multiply-shift to map into [0, bound)
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 7;
+  rngState ^= rngState << 17;
+  return static_cast<uint32_t>(((rngState >> 32) * bound) >> 32);
+}
@@ -0,0 +1,101 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "link.h"      // LinkedList, node and its catalog Track
+#include "playback.h"  // TrackProvider, which a queue feeds
+
+// --- Play Orders ---
+enum class PlayOrder {
+  SEQUENTIAL,    // Head to tail
+  REVERSE,       // Tail to head
+  SHUFFLE,       // Uniform random permutation, reshuffled every round
+  ARTIST_SPREAD  // Shuffle that avoids repeating recently heard artists
+};
+
+// A shuffle redraws at most this many times to avoid a recent artist
+#define QUEUE_SPREAD_TRIES 8
+// Number of most recent artists ARTIST_SPREAD tries not to repeat
+#define QUEUE_SPREAD_WINDOW 2
+
+// --- Play Queue ---
+// Produces the tracks of a playlist in a play order, one at a time, without
+// copying or reordering the list. Sequential and reverse orders walk the
+// ring. Shuffles run Fisher-Yates lazily over positions: only positions
+// that have been swapped are stored, so a round needs no per-track array
+// and memory grows with the tracks drawn, not with the playlist.
+//
+// Picking the next track is O(1); a shuffled pick is then resolved to its
+// node through the list's position index in O(log n). Tracks added with
+// playNext()/enqueue() are played before the order continues.
+//
+// The list must not change while the queue is in use, as with any provider
+// handed to the PlaybackEngine. next() and the insertion calls may be made
+// from different threads.
+class PlayQueue {
+public:
+  // Plays 'list' 'rounds' times in 'order'. A zero 'seed' picks a random
+  // one; any other value makes the shuffle repeatable.
+  PlayQueue(const LinkedList& list, PlayOrder order, int rounds = 1,
+            uint64_t seed = 0);
+
+  PlayQueue(const PlayQueue&) = delete;
+  PlayQueue& operator=(const PlayQueue&) = delete;
+
+  // The next track to play, or nullptr once every round is done
+  node* next();
+
+  // Plays 'track' before anything else still queued ("play next")
+  void playNext(node* track);
+  // Plays 'track' after the tracks already inserted, before the order
+  // continues ("add to queue")
+  void enqueue(node* track);
+
+  // Tracks still to come, inserted ones included
+  size_t remaining() const;
+
+  // A provider for PlaybackEngine::play() that draws from this queue
+  TrackProvider provider() {
+    return [this]() { return next(); };
+  }
+
+private:
+  // Next node of the play order itself, ignoring inserted tracks
+  node* nextInOrder();
+  // Draws the next shuffled position (0-based) of the current round
+  uint32_t drawShuffled();
+  // Position currently stored in shuffle slot 'slot'
+  uint32_t slotValue(uint32_t slot) const;
+  // True if 'n' is by one of the last QUEUE_SPREAD_WINDOW artists played
+  bool artistIsRecent(const node* n) const;
+  // Remembers the artist of a track just handed out
+  void noteArtist(const node* n);
+  // Uniform value in [0, bound)
+  uint32_t randomBelow(uint32_t bound);
+
+  const LinkedList& list;
+  const PlayOrder order;
+  const int rounds;
+  const uint32_t length;  // list.len when the queue was made
+
+  int round;         // 0-based round in progress
+  uint32_t drawn;    // Tracks of this round handed out so far
+  node* cursor;      // Next node to visit (sequential and reverse)
+  uint64_t rngState;  // xorshift64 state for the shuffles
+
+  // Lazy Fisher-Yates: slot -> position for swapped slots at or beyond
+  // 'drawn'; every other slot s still holds position s
+  std::unordered_map<uint32_t, uint32_t> swapped;
+  const std::string* recentArtists[QUEUE_SPREAD_WINDOW];  // Shown keys
+
+  std::deque<node*> inserted;  // playNext()/enqueue() tracks, front first
+  mutable std::mutex mtx;      // Guards everything above
+};
+
+#endif  // QUEUE_H
@@ -0,0 +1,242 @@
+#include "registry.h"
+
+#include <cstdio>  // For std::remove, std::rename
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+// Manifest file inside the registry directory, and its format version
+#define REGISTRY_MANIFEST_FILE "manifest.json"
+#define REGISTRY_MANIFEST_VERSION 1
+
+PlaylistRegistry::PlaylistRegistry(const std::string& dir)
+    : directory(dir), nextId(1) {}
+
+std::string PlaylistRegistry::pathOf(const std::string& file) const {
+  return (fs::path(directory) / file).string();
+}
+
+bool PlaylistRegistry::loadManifest() {
+  std::ifstream file(pathOf(REGISTRY_MANIFEST_FILE));
+  if (!file.is_open()) return true;  // First run: no playlists saved yet
+
+  try {
+    json manifest = json::parse(file);
+    if (manifest.value("version", 0) != REGISTRY_MANIFEST_VERSION) {
+      std::cerr << "\t\tError: Unsupported playlist manifest version."
+                << std::endl;
+      setAsideManifest();
+      return false;
+    }
+
+    nextId = manifest.value("nextId", 1u);
+    for (const auto& item : manifest.at("playlists")) {
+      PlaylistEntry entry;
+      entry.name = uniqueName(item.at("name").get<std::string>());
+      entry.id = item.at("id").get<unsigned>();
+      entry.file = item.at("file").get<std::string>();
+      entry.length = item.value("length", 0);
+      if (entry.id >= nextId) nextId = entry.id + 1;  // Never reuse an id
+
+      byName[toLowerCopy(entry.name)] = entries.size();
+      entries.push_back(std::move(entry));
+    }
+  } catch (const json::exception& e) {
+    std::cerr << "\t\tError: Could not read playlist manifest: " << e.what()
+              << std::endl;
+    entries.clear();
+    byName.clear();
+    setAsideManifest();
+    return false;
+  }
+  return true;
+}
+
+// Moves an unusable manifest out of the way so that the next save cannot
+// overwrite it; the playlist files themselves are left alone
+void PlaylistRegistry::setAsideManifest() const {
+  const std::string damaged = pathOf(REGISTRY_MANIFEST_FILE);
+  if (std::rename(damaged.c_str(), (damaged + ".bad").c_str()) == 0) {
+    std::cerr << "\t\tWarning: Moved damaged manifest to '" << damaged
+              << ".bad'." << std::endl;
+  }
+}
+
+bool PlaylistRegistry::saveManifest() {
+  std::error_code ec;
+  fs::create_directories(directory, ec);
+
+  json manifest;
+  manifest["version"] = REGISTRY_MANIFEST_VERSION;
+  manifest["nextId"] = nextId;
+  json items = json::array();
+  for (const PlaylistEntry& entry : entries) {
+    if (entry.file.empty()) continue;  // Never saved: nothing to point at
+    items.push_back({{"name", entry.name},
+                     {"id", entry.id},
+                     {"file", entry.file},
+                     {"length", entry.length}});
+  }
+  manifest["playlists"] = items;
+
+  const std::string target = pathOf(REGISTRY_MANIFEST_FILE);
+  const std::string tempName = target + ".tmp";
+  {
+    std::ofstream file(tempName);
+    if (!file.is_open()) {
+      std::cerr << "\t\tError: Could not write playlist manifest '"
+                << tempName << "'." << std::endl;
+      return false;
+    }
+    try {
+      file << manifest.dump(2);
+    } catch (const json::exception& e) {  // e.g. a name with invalid UTF-8
+      std::cerr << "\t\tError: Could not encode playlist manifest: "
+                << e.what() << std::endl;
+      return false;
+    }
+    if (!file.good()) return false;
+  }
+  if (!replaceFileDurably(tempName, target)) return false;
+
+  // The manifest on disk no longer names these, so they can go (unless a
+  // later save switched a playlist back to the same file)
+  std::unordered_set<std::string> live;
+  for (const PlaylistEntry& entry : entries) live.insert(entry.file);
+  std::lock_guard<std::mutex> lock(obsoleteMtx);
+  for (const std::string& stale : obsoleteFiles) {
+    if (live.count(stale) == 0) std::remove(pathOf(stale).c_str());
+  }
+  obsoleteFiles.clear();
+  return true;
+}
+
+const std::string& PlaylistRegistry::nameAt(size_t index) const {
+  return entries[index].name;
+}
+
+int PlaylistRegistry::lengthAt(size_t index) const {
+  const PlaylistEntry& entry = entries[index];
+  return entry.list ? entry.list->len : entry.length;
+}
+
+bool PlaylistRegistry::isLoaded(size_t index) const {
+  return entries[index].list != nullptr;
+}
+
+int PlaylistRegistry::find(const std::string& name) const {
+  auto it = byName.find(toLowerCopy(name));
+  return it == byName.end() ? -1 : static_cast<int>(it->second);
+}
+
+std::string PlaylistRegistry::uniqueName(const std::string& wanted) const {
+  if (find(wanted) < 0) return wanted;
+  for (int n = 2;; ++n) {
+    std::string candidate = wanted + " (" + std::to_string(n) + ")";
+    if (find(candidate) < 0) return candidate;
+  }
+}
+
+LinkedList* PlaylistRegistry::open(size_t index) {
+  PlaylistEntry& entry = entries[index];
+  if (entry.list) return entry.list.get();
+
+  auto list = std::make_unique<LinkedList>();
+  if (!entry.file.empty() && !list->loadFromFile(pathOf(entry.file))) {
+    std::cerr << "\t\tError: Could not load playlist '" << entry.name
+              << "' from '" << pathOf(entry.file) << "'." << std::endl;
+    return nullptr;
+  }
+  list->listName = entry.name;  // The manifest's name is authoritative
+  list->taken = true;
+  entry.length = list->len;
+  entry.list = std::move(list);
+  return entry.list.get();
+}
+
+int PlaylistRegistry::create(const std::string& name) {
+  if (find(name) >= 0) return -1;
+
+  PlaylistEntry entry;
+  entry.name = name;
+  entry.id = nextId++;
+  entry.length = 0;
+  entry.list = std::make_unique<LinkedList>();
+  entry.list->listName = name;
+  entry.list->taken = true;
+
+  byName[toLowerCopy(name)] = entries.size();
+  entries.push_back(std::move(entry));
+  return static_cast<int>(entries.size() - 1);
+}
+
+size_t PlaylistRegistry::adopt(std::unique_ptr<LinkedList> list) {
+  std::string name =
+      uniqueName(list->listName.empty() ? "[Unnamed]" : list->listName);
+  size_t index = static_cast<size_t>(create(name));
+  entries[index].length = list->len;
+  entries[index].list = std::move(list);
+  entries[index].list->listName = name;
+  entries[index].list->taken = true;
+  return index;
+}
+
+bool PlaylistRegistry::rename(size_t index, const std::string& newName) {
+  int existing = find(newName);
+  if (existing >= 0 && static_cast<size_t>(existing) != index) return false;
+
+  PlaylistEntry& entry = entries[index];
+  byName.erase(toLowerCopy(entry.name));
+  byName[toLowerCopy(newName)] = index;
+  entry.name = newName;
+  if (entry.list) entry.list->listName = newName;
+  return true;
+}
+
+void PlaylistRegistry::remove(size_t index) {
+  PlaylistEntry& entry = entries[index];
+  if (!entry.file.empty()) {
+    std::lock_guard<std::mutex> lock(obsoleteMtx);
+    obsoleteFiles.push_back(entry.file);
+  }
+  byName.erase(toLowerCopy(entry.name));
+  entries.erase(entries.begin() + index);
+  reindexFrom(index);
+}
+
+void PlaylistRegistry::reindexFrom(size_t from) {
+  for (size_t i = from; i < entries.size(); ++i) {
+    byName[toLowerCopy(entries[i].name)] = i;
+  }
+}
+
+std::vector<size_t> PlaylistRegistry::loadedIndices() const {
+  std::vector<size_t> loaded;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].list) loaded.push_back(i);
+  }
+  return loaded;
+}
+
+bool PlaylistRegistry::save(size_t index, PlaylistFormat format) {
+  PlaylistEntry& entry = entries[index];
+  if (!entry.list) return true;  // Not loaded, so the file is current
+
+  std::error_code ec;
+  fs::create_directories(directory, ec);  // Already existing is fine
+
+  std::string file = std::to_string(entry.id) +
+                     (format == PlaylistFormat::JSON ? ".json" : ".mpl");
+  if (!entry.list->saveToFile(pathOf(file), format)) return false;
+
+  if (!entry.file.empty() && entry.file != file) {
+    std::lock_guard<std::mutex> lock(obsoleteMtx);
+    obsoleteFiles.push_back(entry.file);  // Saved in the other format before
+  }
+  entry.file = file;
+  entry.length = entry.list->len;
+  return true;
+}
@@ -0,0 +1,90 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "link.h"  // LinkedList, PlaylistFormat
+
+// --- Playlist Registry ---
+// Every named playlist the program knows about, without a fixed limit.
+// A manifest in the registry directory records each playlist's name,
+// backing file and length, so startup reads that one file. A playlist's
+// songs are loaded the first time it is opened. Names are unique ignoring
+// case and are looked up through a hash index.
+
+// One playlist known to the registry
+struct PlaylistEntry {
+  std::string name;  // Display name, unique ignoring case
+  unsigned id;       // Stable number that names the backing file
+  std::string file;  // Backing file in the registry directory, "" if unsaved
+  int length;        // Song count when last saved (listed without loading)
+  std::unique_ptr<LinkedList> list;  // nullptr until first opened
+};
+
+class PlaylistRegistry {
+public:
+  explicit PlaylistRegistry(const std::string& directory = "playlists");
+
+  // Reads the manifest (not the playlists). A missing manifest is an empty
+  // registry. Returns false if the manifest exists but cannot be used.
+  bool loadManifest();
+  // Writes the manifest atomically, then deletes playlist files that no
+  // entry refers to any more. Returns false on failure.
+  bool saveManifest();
+
+  // --- Lookup (in creation order) ---
+  size_t size() const { return entries.size(); }
+  const std::string& nameAt(size_t index) const;
+  // Live song count if the playlist is loaded, otherwise the manifest's
+  int lengthAt(size_t index) const;
+  bool isLoaded(size_t index) const;
+  // Index of the playlist called 'name' (ignoring case), or -1
+  int find(const std::string& name) const;
+  // 'wanted' if free, else the first free "wanted (2)", "wanted (3)", ...
+  std::string uniqueName(const std::string& wanted) const;
+
+  // --- Access and editing ---
+  // Returns the playlist, loading it on first access; nullptr (after an
+  // error message) if its file cannot be read
+  LinkedList* open(size_t index);
+  // Adds an empty playlist and returns its index, or -1 if 'name' is taken
+  int create(const std::string& name);
+  // Takes over an already loaded list under a unique version of its name
+  size_t adopt(std::unique_ptr<LinkedList> list);
+  // Returns false if 'newName' already belongs to another playlist
+  bool rename(size_t index, const std::string& newName);
+  // Forgets the playlist; its file is deleted by the next saveManifest()
+  void remove(size_t index);
+
+  // --- Saving ---
+  // Indices of the playlists currently in memory
+  std::vector<size_t> loadedIndices() const;
+  // Writes a loaded playlist to its backing file in 'format'. Safe to call
+  // concurrently for different indices. Returns false on failure.
+  bool save(size_t index, PlaylistFormat format);
+
+  const std::string& path() const { return directory; }
+
+private:
+  std::string pathOf(const std::string& file) const;
+  // Renames a damaged manifest to "manifest.json.bad"
+  void setAsideManifest() const;
+  // Re-points byName at entries[from..] after an erase shifted them
+  void reindexFrom(size_t from);
+
+  std::string directory;
+  std::vector<PlaylistEntry> entries;
+  std::unordered_map<std::string, size_t> byName;  // Lowercase name -> index
+  unsigned nextId;                                 // Next unused entry id
+
+  // Files replaced or orphaned since the last manifest save. They are only
+  // deleted once a manifest that no longer names them is on disk.
+  std::vector<std::string> obsoleteFiles;
+  std::mutex obsoleteMtx;  // save() may run on several threads
+};
+
+#endif  // REGISTRY_H
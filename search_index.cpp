@@ -0,0 +1,106 @@
+#include "search_index.h"
+
+#include <algorithm>
+
+// Packs three bytes of 'text' starting at 'i' into one trigram key
+static uint32_t trigramAt(const std::string& text, size_t i) {
+  return (static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+         (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+         static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2]));
+}
+
+// Appends every trigram of 'text' to 'out' (duplicates included)
+static void appendTrigrams(const std::string& text,
+                           std::vector<uint32_t>& out) {
+  for (size_t i = 0; i + 3 <= text.size(); ++i) {
+    out.push_back(trigramAt(text, i));
+  }
+}
+
+std::vector<uint32_t> SearchIndex::trigramsOf(const node* n) {
+  std::vector<uint32_t> grams;
+  const Track& track = n->track();
+  appendTrigrams(track.songKey, grams);
+  appendTrigrams(track.shownArtistKey(), grams);
+
+  // Each node is listed at most once per trigram
+  std::sort(grams.begin(), grams.end());
+  grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+  return grams;
+}
+
+void SearchIndex::add(node* n) {
+  auto inserted = entries.emplace(n, Entry());
+  if (!inserted.second) return;  // Indexed already
+
+  // Tags published after this read are caught by refresh()
+  inserted.first->second.artistKey = &n->track().shownArtistKey();
+  std::vector<Place>& places = inserted.first->second.places;
+  for (uint32_t gram : trigramsOf(n)) {
+    std::vector<Posting>& list = postings[gram];
+    places.push_back({gram, static_cast<uint32_t>(list.size())});
+    list.push_back({n, static_cast<uint32_t>(places.size() - 1)});
+  }
+}
+
+void SearchIndex::remove(node* n) {
+  auto entry = entries.find(n);
+  if (entry == entries.end()) return;
+
+  for (const Place& place : entry->second.places) {
+    auto it = postings.find(place.gram);
+    std::vector<Posting>& list = it->second;
+    // Order within a posting list does not matter: fill the hole with the
+    // last posting and tell its node where that posting went
+    const Posting moved = list.back();
+    list.pop_back();
+    if (place.index < list.size()) {
+      list[place.index] = moved;
+      entries[moved.item].places[moved.slot].index = place.index;
+    }
+    if (list.empty()) postings.erase(it);
+  }
+  entries.erase(entry);
+}
+
+void SearchIndex::refresh(node* n) {
+  auto entry = entries.find(n);
+  if (entry == entries.end()) return;
+  // Shown keys live in the catalog, so comparing addresses is enough
+  if (entry->second.artistKey == &n->track().shownArtistKey()) return;
+  remove(n);
+  add(n);
+}
+
+bool SearchIndex::syncCatalog(uint64_t catalogRevision) {
+  if (catalogRevision == catalogSeen) return false;
+  catalogSeen = catalogRevision;
+  return true;
+}
+
+bool SearchIndex::query(const std::string& lowerTerm, size_t maxCandidates,
+                        std::vector<node*>& matches) const {
+  matches.clear();
+
+  // Pick the term's rarest trigram; if any trigram is absent nothing matches
+  const std::vector<Posting>* rarest = nullptr;
+  for (size_t i = 0; i + 3 <= lowerTerm.size(); ++i) {
+    auto it = postings.find(trigramAt(lowerTerm, i));
+    if (it == postings.end()) return true;
+    if (rarest == nullptr || it->second.size() < rarest->size()) {
+      rarest = &it->second;
+    }
+  }
+  if (rarest == nullptr) return true;  // Term shorter than a trigram
+  if (rarest->size() > maxCandidates) return false;  // Not selective enough
+
+  // Verify candidates; a shared trigram does not imply a full match
+  for (const Posting& posting : *rarest) {
+    node* n = posting.item;
+    if (n->track().songKey.find(lowerTerm) != std::string::npos ||
+        n->track().shownArtistKey().find(lowerTerm) != std::string::npos) {
+      matches.push_back(n);
+    }
+  }
+  return true;
+}
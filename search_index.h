@@ -0,0 +1,68 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "link.h"  // Needs node and its catalog Track (songKey, artist keys)
+
+// --- Trigram Search Index ---
+// Maps every 3-byte substring of a node's lowercase title and shown artist
+// keys to the nodes containing it. A substring query looks up the rarest
+// trigram of the search term and only verifies those candidates, instead
+// of scanning the whole playlist. Each node records where it sits in its
+// posting lists, so removing it costs one step per trigram however common
+// the trigram is.
+class SearchIndex {
+public:
+  // Adds or removes one node. add() ignores a node already indexed,
+  // remove() one that is not.
+  void add(node* n);
+  void remove(node* n);
+
+  // Re-indexes 'n' if its shown artist changed since it was indexed (its
+  // tags arrived and replace a placeholder artist)
+  void refresh(node* n);
+
+  // Notes the TrackCatalog::revision() the entries now reflect. Returns
+  // true if it differs from the last one noted, i.e. tags may have arrived
+  // and every node should be refresh()ed.
+  bool syncCatalog(uint64_t catalogRevision);
+
+  // Stores in 'matches' the nodes whose songKey or shownArtistKey() contains
+  // 'lowerTerm', in no particular order. 'lowerTerm' must already be
+  // lowercase and at least 3 bytes long. Returns false without searching if
+  // more than 'maxCandidates' nodes would need verifying, in which case a
+  // plain scan is the cheaper way to answer.
+  bool query(const std::string& lowerTerm, size_t maxCandidates,
+             std::vector<node*>& matches) const;
+
+private:
+  // Distinct trigrams of a node's title and artist keys
+  static std::vector<uint32_t> trigramsOf(const node* n);
+
+  // One node in a posting list; 'slot' is the matching Place in its entry
+  struct Posting {
+    node* item;
+    uint32_t slot;
+  };
+  // Where one of a node's trigrams lists it: postings[gram][index]
+  struct Place {
+    uint32_t gram;
+    uint32_t index;
+  };
+
+  // What was indexed for one node
+  struct Entry {
+    const std::string* artistKey;  // Its shownArtistKey() at the time
+    std::vector<Place> places;
+  };
+
+  std::unordered_map<uint32_t, std::vector<Posting>> postings;
+  std::unordered_map<const node*, Entry> entries;
+  uint64_t catalogSeen = 0;  // Last revision passed to syncCatalog()
+};
+
+#endif  // SEARCH_INDEX_H
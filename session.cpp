@@ -0,0 +1,164 @@
+#include "session.h"
+
+// Required for MP3 decoding
+#include <mpg123.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include "stats.h"  // Output setup timing
+
+// Outputs kept open at once; the least recently used one is closed first
+#define MAX_CACHED_OUTPUTS 4
+
+AudioSession& AudioSession::instance() {
+  static AudioSession session;  // Destroyed at process exit
+  return session;
+}
+
+AudioSession::AudioSession()
+    : useCounter(0),
+      fileRate(0),
+      fileChannels(0),
+      mpg123Ready(false),
+      volume(0.0) {}
+
+// Closes cached outputs and shuts mpg123 down once, at process exit
+AudioSession::~AudioSession() {
+  closeOutputs();
+  if (mpg123Ready) {
+    mpg123_exit();
+  }
+}
+
+bool AudioSession::ensureMpg123() {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!mpg123Ready) {
+    if (mpg123_init() != MPG123_OK) {
+      std::cerr << "\t\tError: Cannot initialize mpg123 library." << std::endl;
+      return false;
+    }
+    mpg123Ready = true;
+  }
+  return true;
+}
+
+AudioOutput* AudioSession::acquireOutput(long rate, int channels,
+                                         std::string& error) {
+  std::lock_guard<std::mutex> lock(mtx);
+  ++useCounter;
+
+  // Reuse the output already open for this spec
+  for (auto& cached : outputs) {
+    if (cached.rate == rate && cached.channels == channels) {
+      cached.lastUsed = useCounter;
+      return cached.output.get();
+    }
+  }
+
+  // Make room by closing the output that has been idle the longest. File
+  // sinks keep theirs: reopening one would truncate what it has written.
+  bool fileSink = config.sink == OutputSink::WAV_FILE ||
+                  config.sink == OutputSink::RAW_FILE;
+  if (outputs.size() >= MAX_CACHED_OUTPUTS && !fileSink) {
+    auto oldest = outputs.begin();
+    for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+      if (it->lastUsed < oldest->lastUsed) oldest = it;
+    }
+    outputs.erase(oldest);
+  }
+
+  ScopedTimer timer(StatTimer::OUTPUT_OPEN);
+  std::unique_ptr<AudioOutput> output;
+  error.clear();
+  switch (config.sink) {
+    case OutputSink::NULL_SINK:
+      output = makeNullOutput();
+      if (!output->open(rate, channels, error)) return nullptr;
+      break;
+    case OutputSink::WAV_FILE:
+    case OutputSink::RAW_FILE:
+      output = makeFileOutput(filePathFor(rate, channels),
+                              config.sink == OutputSink::WAV_FILE);
+      if (!output->open(rate, channels, error)) return nullptr;
+      break;
+    case OutputSink::PULSE:
+      output = openPulse(rate, channels, error);
+      if (!output) return nullptr;
+      break;
+  }
+
+  outputs.push_back({rate, channels, std::move(output), useCounter});
+  return outputs.back().output.get();
+}
+
+std::unique_ptr<AudioOutput> AudioSession::openPulse(long rate, int channels,
+                                                     std::string& error) {
+  std::unique_ptr<AudioOutput> output;
+  if (config.useAsync) {
+    output = makePulseAsyncOutput(config);
+    if (!output->open(rate, channels, error)) output.reset();
+  }
+  if (!output) {  // Fallback; keeps the async backend's reason if both fail
+    std::string simpleError;
+    output = makePulseSimpleOutput(config);
+    if (!output->open(rate, channels, simpleError)) {
+      if (error.empty()) error = simpleError;
+      return nullptr;
+    }
+    error.clear();
+  }
+  return output;
+}
+
+// "out.wav" for the first spec, then e.g. "out.44100Hz-1ch.wav"
+std::string AudioSession::filePathFor(long rate, int channels) {
+  if (fileRate == 0 || (fileRate == rate && fileChannels == channels)) {
+    fileRate = rate;
+    fileChannels = channels;
+    return config.filePath;
+  }
+  std::string suffix =
+      "." + std::to_string(rate) + "Hz-" + std::to_string(channels) + "ch";
+  std::string path = config.filePath;
+  size_t slash = path.find_last_of('/');
+  size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    return path + suffix;
+  }
+  return path.insert(dot, suffix);
+}
+
+void AudioSession::discardOutput(AudioOutput* output) {
+  std::lock_guard<std::mutex> lock(mtx);
+  for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+    if (it->output.get() == output) {
+      outputs.erase(it);
+      return;
+    }
+  }
+}
+
+void AudioSession::closeOutputs() {
+  std::lock_guard<std::mutex> lock(mtx);
+  outputs.clear();
+}
+
+void AudioSession::setOutputConfig(const OutputConfig& newConfig) {
+  std::lock_guard<std::mutex> lock(mtx);
+  config = newConfig;
+  outputs.clear();
+  fileRate = 0;
+  fileChannels = 0;
+}
+
+OutputConfig AudioSession::outputConfig() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return config;
+}
+
+double AudioSession::setVolumeDb(double db) {
+  db = std::min(VOLUME_MAX_DB, std::max(VOLUME_MIN_DB, db));
+  volume.store(db);
+  return db;
+}
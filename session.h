@@ -0,0 +1,88 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "output.h"  // AudioOutput, OutputConfig
+
+// Range of the software output volume, in dB relative to the decoded level
+#define VOLUME_MIN_DB -60.0
+#define VOLUME_MAX_DB 12.0
+
+// --- Audio Session ---
+// Process-wide owner of the audio libraries and output streams.
+// mpg123 is initialised once on first use and released at exit, and one
+// output is kept open per (rate, channels) sample spec so that
+// consecutive tracks with the same format skip stream setup entirely.
+// It also holds the software volume, so a change carries over to later
+// tracks and playback modes.
+class AudioSession {
+public:
+  // Returns the single session shared by every player in the process
+  static AudioSession& instance();
+
+  // Initialises mpg123 on first call. Returns false if it is unavailable.
+  bool ensureMpg123();
+
+  // Returns an output for the given spec, reusing a cached one when
+  // possible. A new one goes to the configured sink; for PulseAudio it
+  // uses the async backend unless the configuration says otherwise, and
+  // falls back to pa_simple if that cannot connect.
+  // On failure returns nullptr and fills 'error'.
+  AudioOutput* acquireOutput(long rate, int channels, std::string& error);
+
+  // Closes an output that reported an error so the next acquire rebuilds it
+  void discardOutput(AudioOutput* output);
+
+  // Closes every cached output, completing file sinks (the session stays
+  // usable afterwards)
+  void closeOutputs();
+
+  // Sink, backend choice and latency targets for outputs opened from now
+  // on; cached outputs are closed (finishing any files) so the next track
+  // picks the change up
+  void setOutputConfig(const OutputConfig& config);
+  OutputConfig outputConfig();
+
+  // Software volume in dB, applied on top of each track's ReplayGain
+  double volumeDb() const { return volume.load(); }
+  // Sets the volume, clamped to VOLUME_MIN_DB..VOLUME_MAX_DB; returns it
+  double setVolumeDb(double db);
+
+  AudioSession(const AudioSession&) = delete;
+  AudioSession& operator=(const AudioSession&) = delete;
+
+private:
+  AudioSession();
+  ~AudioSession();
+
+  // One open output and the spec it was created for
+  struct CachedOutput {
+    long rate;
+    int channels;
+    std::unique_ptr<AudioOutput> output;
+    uint64_t lastUsed;  // Value of 'useCounter' at the last acquire
+  };
+
+  // Opens a PulseAudio output, falling back to pa_simple
+  std::unique_ptr<AudioOutput> openPulse(long rate, int channels,
+                                         std::string& error);
+  // File for a new file-sink output of this spec
+  std::string filePathFor(long rate, int channels);
+
+  std::vector<CachedOutput> outputs;  // Small; linear lookup is fine
+  OutputConfig config;
+  uint64_t useCounter;
+  long fileRate;     // Spec that writes to config.filePath itself (0: none)
+  int fileChannels;
+  bool mpg123Ready;
+  std::atomic<double> volume;  // Read by the output thread once per block
+  std::mutex mtx;
+};
+
+#endif  // SESSION_H
@@ -0,0 +1,99 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// --- Single-Producer / Single-Consumer Ring ---
+// Fixed-capacity FIFO for exactly one writing thread and one reading
+// thread, with no lock on either side. The two positions are running
+// totals (never wrapped), so a full ring and an empty one cannot be
+// confused and the producer's total marks a point in the stream that the
+// consumer can later skip to. Each side publishes its position with a
+// release store after touching the data, and reads the other side's with
+// an acquire load, so every element is visible before it can be read.
+template <typename T>
+class SpscRing {
+public:
+  SpscRing() : mask(0), head(0), tail(0) {}
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Sizes the ring for at least 'minCapacity' elements (rounded up to a
+  // power of two). Call before either thread uses it.
+  void allocate(size_t minCapacity) {
+    size_t capacity = 1;
+    while (capacity < minCapacity) capacity <<= 1;
+    buffer.reset(new T[capacity]);
+    mask = capacity - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return buffer ? mask + 1 : 0; }
+
+  // Elements buffered; exact on either side, a snapshot anywhere else
+  size_t size() const {
+    return static_cast<size_t>(head.load(std::memory_order_acquire) -
+                               tail.load(std::memory_order_acquire));
+  }
+  size_t space() const { return capacity() - size(); }
+  bool empty() const { return size() == 0; }
+
+  // --- Producer side ---
+
+  // Appends up to 'count' elements and returns how many fit
+  size_t write(const T* data, size_t count) {
+    const uint64_t w = head.load(std::memory_order_relaxed);
+    const uint64_t r = tail.load(std::memory_order_acquire);
+    count = std::min(count, capacity() - static_cast<size_t>(w - r));
+
+    const size_t start = static_cast<size_t>(w) & mask;
+    const size_t first = std::min(count, capacity() - start);
+    std::copy(data, data + first, buffer.get() + start);
+    std::copy(data + first, data + count, buffer.get());
+    head.store(w + count, std::memory_order_release);
+    return count;
+  }
+
+  // Total elements ever written; a position discardUntil() understands
+  uint64_t written() const { return head.load(std::memory_order_acquire); }
+
+  // --- Consumer side ---
+
+  // Removes up to 'count' elements into 'out' and returns how many
+  size_t read(T* out, size_t count) {
+    const uint64_t r = tail.load(std::memory_order_relaxed);
+    const uint64_t w = head.load(std::memory_order_acquire);
+    count = std::min(count, static_cast<size_t>(w - r));
+
+    const size_t start = static_cast<size_t>(r) & mask;
+    const size_t first = std::min(count, capacity() - start);
+    std::copy(buffer.get() + start, buffer.get() + start + first, out);
+    std::copy(buffer.get(), buffer.get() + (count - first), out + first);
+    tail.store(r + count, std::memory_order_release);
+    return count;
+  }
+
+  // Drops every element written before 'mark' (a value of written())
+  void discardUntil(uint64_t mark) {
+    const uint64_t r = tail.load(std::memory_order_relaxed);
+    const uint64_t w = head.load(std::memory_order_acquire);
+    mark = std::min(mark, w);
+    if (mark > r) tail.store(mark, std::memory_order_release);
+  }
+
+private:
+  std::unique_ptr<T[]> buffer;
+  size_t mask;  // capacity - 1
+
+  // Each position on its own cache line so the two threads do not contend
+  alignas(64) std::atomic<uint64_t> head;  // Written by the producer
+  alignas(64) std::atomic<uint64_t> tail;  // Written by the consumer
+};
+
+#endif  // SPSC_RING_H
@@ -0,0 +1,126 @@
+#include "stats.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>  // JSON dump
+
+using json = nlohmann::json;
+
+// Names used on the stats screen and as JSON keys, in enum order
+static const char* const TIMER_NAMES[] = {
+    "track_open",     "mp3_scan",    "first_decode",
+    "output_open",    "first_write", "play_to_first_write",
+    "decode_block",   "write_block", "output_latency",
+    "list_add",       "list_delete", "list_sort",
+    "list_search",    "list_save",   "list_load"};
+static const char* const COUNTER_NAMES[] = {"underruns", "tracks_played",
+                                            "tracks_failed", "samples_written"};
+
+static_assert(sizeof(TIMER_NAMES) / sizeof(TIMER_NAMES[0]) ==
+                  static_cast<size_t>(StatTimer::COUNT),
+              "TIMER_NAMES must name every StatTimer");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) ==
+                  static_cast<size_t>(StatCounter::COUNT),
+              "COUNTER_NAMES must name every StatCounter");
+
+Stats& Stats::instance() {
+  static Stats stats;
+  return stats;
+}
+
+Stats::Stats() {
+  reset();
+}
+
+#if STATS_ENABLED
+void Stats::record(StatTimer timer, StatClock::duration elapsed) {
+  const uint64_t ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  Timer& t = timers[static_cast<int>(timer)];
+  t.count.fetch_add(1, std::memory_order_relaxed);
+  t.totalNs.fetch_add(ns, std::memory_order_relaxed);
+
+  uint64_t seen = t.minNs.load(std::memory_order_relaxed);
+  while (ns < seen && !t.minNs.compare_exchange_weak(
+                          seen, ns, std::memory_order_relaxed)) {
+  }
+  seen = t.maxNs.load(std::memory_order_relaxed);
+  while (ns > seen && !t.maxNs.compare_exchange_weak(
+                          seen, ns, std::memory_order_relaxed)) {
+  }
+}
+#endif
+
+void Stats::reset() {
+  for (Timer& t : timers) {
+    t.count = 0;
+    t.totalNs = 0;
+    t.minNs = UINT64_MAX;
+    t.maxNs = 0;
+  }
+  for (auto& counter : counters) counter = 0;
+}
+
+void Stats::print(std::ostream& out) const {
+  if (!STATS_ENABLED) {
+    out << "\t\tInstrumentation is compiled out of this build." << std::endl;
+    return;
+  }
+  char line[128];
+  std::snprintf(line, sizeof(line), "\t\t%-20s %9s %10s %10s %10s %11s",
+                "stage", "count", "avg (ms)", "min (ms)", "max (ms)",
+                "total (ms)");
+  out << line << std::endl;
+  for (int i = 0; i < static_cast<int>(StatTimer::COUNT); ++i) {
+    const Timer& t = timers[i];
+    const uint64_t count = t.count.load();
+    if (count == 0) continue;
+    const double totalMs = t.totalNs.load() / 1e6;
+    std::snprintf(line, sizeof(line),
+                  "\t\t%-20s %9llu %10.3f %10.3f %10.3f %11.1f",
+                  TIMER_NAMES[i], static_cast<unsigned long long>(count),
+                  totalMs / count, t.minNs.load() / 1e6, t.maxNs.load() / 1e6,
+                  totalMs);
+    out << line << std::endl;
+  }
+  out << std::endl;
+  for (int i = 0; i < static_cast<int>(StatCounter::COUNT); ++i) {
+    out << "\t\t" << COUNTER_NAMES[i] << ": " << counters[i].load()
+        << std::endl;
+  }
+}
+
+bool Stats::writeJson(const std::string& path) const {
+  json doc;
+  doc["enabled"] = static_cast<bool>(STATS_ENABLED);
+  json timerDoc = json::object();
+  for (int i = 0; i < static_cast<int>(StatTimer::COUNT); ++i) {
+    const Timer& t = timers[i];
+    const uint64_t count = t.count.load();
+    timerDoc[TIMER_NAMES[i]] = {
+        {"count", count},
+        {"total_ns", t.totalNs.load()},
+        {"min_ns", count ? t.minNs.load() : 0},
+        {"max_ns", t.maxNs.load()}};
+  }
+  doc["timers"] = timerDoc;
+  json counterDoc = json::object();
+  for (int i = 0; i < static_cast<int>(StatCounter::COUNT); ++i) {
+    counterDoc[COUNTER_NAMES[i]] = counters[i].load();
+  }
+  doc["counters"] = counterDoc;
+
+  std::ofstream out(path);
+  if (!out) return false;
+  out << doc.dump(2) << std::endl;
+  return static_cast<bool>(out);
+}
+
+void Stats::dumpIfRequested() const {
+  if (dumpPath.empty()) return;
+  if (!writeJson(dumpPath)) {
+    std::cerr << "\t\tWarning: Cannot write stats to '" << dumpPath << "'"
+              << std::endl;
+  }
+}
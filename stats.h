@@ -0,0 +1,138 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// --- Hot-Path Instrumentation ---
+// Process-wide timers and counters for the path from pressing play to
+// hearing sound, the playback loops and the playlist operations. Timers
+// keep a count, total, minimum and maximum; recording is a few relaxed
+// atomic operations, so the output thread can use it on every block.
+//
+// Release builds (NDEBUG, or STATS_ENABLED=0) compile recording out: the
+// record/add calls are empty inlines, and ScopedTimer and statNow() read
+// no clock.
+
+#ifndef STATS_ENABLED
+#ifdef NDEBUG
+#define STATS_ENABLED 0
+#else
+#define STATS_ENABLED 1
+#endif
+#endif
+
+using StatClock = std::chrono::steady_clock;
+
+// Start or end of a stage timed by hand. With recording compiled out it is
+// a constant, so release builds read no clock for it either.
+inline StatClock::time_point statNow() {
+#if STATS_ENABLED
+  return StatClock::now();
+#else
+  return StatClock::time_point();
+#endif
+}
+
+// Timed stages; names are in stats.cpp
+enum class StatTimer {
+  TRACK_OPEN,           // DecoderRegistry::open() of a queued track
+  MP3_SCAN,             // Background mpg123_scan() for the seek index
+  FIRST_DECODE,         // Track queued -> first PCM in its ring
+  OUTPUT_OPEN,          // New output stream (pa_stream / pa_simple_new)
+  FIRST_WRITE,          // Track audible -> its first block written
+  PLAY_TO_FIRST_WRITE,  // play() called -> first block of the queue written
+  DECODE_BLOCK,         // One decoder read on the decoder thread
+  WRITE_BLOCK,          // One output write on the output thread
+  OUTPUT_LATENCY,       // Output latency reported after each write
+  LIST_ADD,             // add_beg / add_end / add_at
+  LIST_DELETE,          // del_beg / del_end / del_at
+  LIST_SORT,            // sortBy() on any keys
+  LIST_SEARCH,          // findMatches()
+  LIST_SAVE,            // saveToFile(), either format
+  LIST_LOAD,            // loadFromFile(), either format
+  COUNT
+};
+
+// Plain event counts
+enum class StatCounter {
+  UNDERRUNS,        // Output found the ring empty mid-track
+  TRACKS_PLAYED,    // Tracks played to the end
+  TRACKS_FAILED,    // Tracks that failed to open or decode
+  SAMPLES_WRITTEN,  // Samples handed to outputs
+  COUNT
+};
+
+class Stats {
+public:
+  // Returns the counters shared by the whole process
+  static Stats& instance();
+
+#if STATS_ENABLED
+  void record(StatTimer timer, StatClock::duration elapsed);
+  void add(StatCounter counter, uint64_t n = 1) {
+    counters[static_cast<int>(counter)].fetch_add(n,
+                                                  std::memory_order_relaxed);
+  }
+#else
+  void record(StatTimer, StatClock::duration) {}
+  void add(StatCounter, uint64_t = 1) {}
+#endif
+
+  // Stats screen: one table row per timer used so far, then the counters
+  void print(std::ostream& out) const;
+  // Everything as JSON to 'path'; false if it cannot be written
+  bool writeJson(const std::string& path) const;
+
+  // File for dumpIfRequested(), set by --stats-json
+  void setDumpPath(const std::string& path) { dumpPath = path; }
+  // Writes the JSON dump if a path was set; prints why if that fails
+  void dumpIfRequested() const;
+
+  // Zeroes every timer and counter
+  void reset();
+
+  Stats(const Stats&) = delete;
+  Stats& operator=(const Stats&) = delete;
+
+private:
+  Stats();
+
+  struct Timer {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalNs;
+    std::atomic<uint64_t> minNs;
+    std::atomic<uint64_t> maxNs;
+  };
+
+  Timer timers[static_cast<int>(StatTimer::COUNT)];
+  std::atomic<uint64_t> counters[static_cast<int>(StatCounter::COUNT)];
+  std::string dumpPath;
+};
+
+// Records the lifetime of the enclosing scope under 'timer'
+#if STATS_ENABLED
+class ScopedTimer {
+public:
+  explicit ScopedTimer(StatTimer timer)
+      : timer(timer), start(StatClock::now()) {}
+  ~ScopedTimer() { Stats::instance().record(timer, StatClock::now() - start); }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  StatTimer timer;
+  StatClock::time_point start;
+};
+#else
+class ScopedTimer {
+public:
+  explicit ScopedTimer(StatTimer) {}
+};
+#endif
+
+#endif  // STATS_H
@@ -0,0 +1,80 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Thread Pool ---
+// Fixed set of worker threads draining a FIFO task queue. Tasks may submit
+// further tasks (e.g. one per subdirectory found), and wait() blocks until
+// the queue is empty and no task is still running.
+class ThreadPool {
+public:
+  explicit ThreadPool(unsigned workers) : pending(0), stopping(false) {
+    if (workers == 0) workers = 1;
+    for (unsigned i = 0; i < workers; ++i) {
+      threads.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+  // Finishes queued tasks, then joins every worker
+  ~ThreadPool() {
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& t : threads) t.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Queues a task; safe to call from inside another task
+  void submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      tasks.push_back(std::move(task));
+      ++pending;
+    }
+    taskReady.notify_one();
+  }
+
+  // Blocks until every submitted task (including nested ones) has finished
+  void wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    allDone.wait(lock, [this]() { return pending == 0; });
+  }
+
+private:
+  void workerLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      taskReady.wait(lock, [this]() { return stopping || !tasks.empty(); });
+      if (tasks.empty()) return;  // Only reached once stopping
+
+      std::function<void()> task = std::move(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      task();  // Tasks are expected to handle their own errors
+      lock.lock();
+
+      if (--pending == 0) allDone.notify_all();
+    }
+  }
+
+  std::vector<std::thread> threads;
+  std::deque<std::function<void()>> tasks;
+  int pending;    // Queued plus running tasks
+  bool stopping;  // Set by the destructor once the queue has drained
+  std::mutex mtx;
+  std::condition_variable taskReady;
+  std::condition_variable allDone;
+};
+
+#endif  // THREADPOOL_H
@@ -0,0 +1,62 @@
+#include "view.h"
+
+// Required for the terminal size
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+
+void clearTerminal() {
+  // Home, clear the screen, clear the scrollback (ignored where unknown)
+  std::cout << "\033[H\033[2J\033[3J" << std::flush;
+}
+
+int pageRows(int reservedRows) {
+  int rows = VIEW_FALLBACK_ROWS;
+  struct winsize size;
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0) {
+    rows = size.ws_row;
+  }
+  return std::max(rows - reservedRows, VIEW_MIN_PAGE_ROWS);
+}
+
+void RowCache::sync(uint64_t sourceStamp, uint64_t dataStamp) {
+  if (synced && source == sourceStamp && data == dataStamp) return;
+  rows.clear();
+  source = sourceStamp;
+  data = dataStamp;
+  synced = true;
+}
+
+const std::string* RowCache::find(size_t index) const {
+  auto it = rows.find(index);
+  return it == rows.end() ? nullptr : &it->second;
+}
+
+const std::string& RowCache::store(size_t index, std::string row) {
+  return rows[index] = std::move(row);
+}
+
+ViewPage viewPage(size_t number, size_t total, size_t perPage) {
+  ViewPage page;
+  if (perPage == 0) perPage = 1;
+  page.pages = std::max<size_t>(1, (total + perPage - 1) / perPage);
+  page.number = std::min(std::max<size_t>(number, 1), page.pages);
+  page.first = (page.number - 1) * perPage;
+  page.count = std::min(perPage, total - std::min(total, page.first));
+  return page;
+}
+
+bool turnPage(const std::string& input, const ViewPage& page,
+              size_t& number) {
+  if (input == "N" || input == "n") {
+    number = std::min(page.number + 1, page.pages);
+    return true;
+  }
+  if (input == "P" || input == "p") {
+    number = page.number > 1 ? page.number - 1 : 1;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,72 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <cstddef>
+#include <cstdint>  // Also SIZE_MAX
+#include <string>
+#include <unordered_map>
+
+// --- Paged Views ---
+// Long listings (playlists, browser directories) are drawn one screenful
+// at a time. Each row is formatted once and kept in a RowCache until its
+// source changes, so a redraw costs a page of output however long the
+// list is. The screen is cleared with ANSI escape sequences instead of
+// running clear(1) in a shell.
+
+// Terminal height assumed when it cannot be queried (e.g. output is piped)
+#define VIEW_FALLBACK_ROWS 24
+// Smallest page drawn, however little room the terminal leaves
+#define VIEW_MIN_PAGE_ROWS 5
+// RowCache index free for a listing's summary line (e.g. its total time),
+// which is then cached and invalidated along with the rows
+#define VIEW_SUMMARY_ROW SIZE_MAX
+
+// Clears the screen and scrollback and homes the cursor
+void clearTerminal();
+
+// Listing rows that fit on screen once 'reservedRows' lines of headers and
+// prompts are drawn around them (at least VIEW_MIN_PAGE_ROWS)
+int pageRows(int reservedRows);
+
+// Formatted rows of one listing, filled in as pages are drawn. sync() is
+// called before each draw with stamps identifying the listing's current
+// contents; when they change, every row is dropped.
+class RowCache {
+public:
+  RowCache() : source(0), data(0), synced(false) {}
+
+  // 'sourceStamp' identifies the listing and its version (for playlists,
+  // LinkedList::revision()); 'dataStamp' the version of what its rows
+  // show from elsewhere (TrackCatalog::revision()), or 0
+  void sync(uint64_t sourceStamp, uint64_t dataStamp);
+
+  // Row 'index' if it was formatted since the last change, else nullptr
+  const std::string* find(size_t index) const;
+  // Stores the formatted row 'index' and returns it
+  const std::string& store(size_t index, std::string row);
+
+private:
+  std::unordered_map<size_t, std::string> rows;  // Only pages drawn so far
+  uint64_t source;
+  uint64_t data;
+  bool synced;  // 'source' and 'data' have been set
+};
+
+// One page of a listing of 'total' rows: rows [first, first + count)
+struct ViewPage {
+  size_t first;
+  size_t count;
+  size_t number;  // 1-based
+  size_t pages;   // At least 1, even for an empty listing
+};
+
+// Page 'number' (1-based, clamped to the listing) of 'perPage' rows each
+ViewPage viewPage(size_t number, size_t total, size_t perPage);
+
+// Applies a paging command typed at a paged listing: "N" (next), "P"
+// (previous), case-insensitive. Returns false, leaving 'number' alone, if
+// 'input' is not one.
+bool turnPage(const std::string& input, const ViewPage& page,
+              size_t& number);
+
+#endif  // VIEW_H